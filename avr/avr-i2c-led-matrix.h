@@ -1,10 +1,20 @@
 #ifndef AVR_I2C_LED_MATRIX
 #define AVR_I2C_LED_MATRIX
 
+// Write the framebuffer from the start and show it
 #define AVR_I2C_CMD_FRAMEBUFFER 0x00
 #define AVR_I2C_CMD_INTENSITY_LOW 0x01
 #define AVR_I2C_CMD_INTENSITY_HIGH 0x02
 
+// Write part of the framebuffer without showing it. The command is followed
+// by the offset into the framebuffer, LSB first, and then the data. Only used
+// by the ESP for framebuffers larger than 255 bytes, which need AVR firmware
+// that knows this command.
+#define AVR_I2C_CMD_FRAMEBUFFER_CHUNK 0x03
+
+// Show the framebuffer
+#define AVR_I2C_CMD_SHOW 0x04
+
 #define AVR_I2C_CMD_NONE 0xFF
 
 #define AVR_I2C_NUM_LEVELS 8
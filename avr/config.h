@@ -1,6 +1,33 @@
 #ifndef CONFIG_H_
 #define CONFIG_H_
 
+//// Matrix ///////////////////////////////////////////////////////////////////
+
+// Size of the matrix in pixels, made of 8x8 MAX7219 modules. Set with e.g.
+// make MATRIX_WIDTH=64 MATRIX_HEIGHT=32, to the same values as for the ESP
+// firmware. The framebuffer has to fit in RAM: the ATtiny441 takes up to
+// 32x32 and the ATtiny841 up to 64x32. Larger matrices are not supported, as
+// e.g. the 512 byte framebuffer of a 64x64 matrix does not fit in any ATtiny
+// x41.
+
+#ifndef MATRIX_WIDTH
+#define MATRIX_WIDTH 32
+#endif
+
+#ifndef MATRIX_HEIGHT
+#define MATRIX_HEIGHT 32
+#endif
+
+#define NUM_MATRIX_COLS (MATRIX_WIDTH / 8)
+#define NUM_MATRIX_ROWS (MATRIX_HEIGHT / 8)
+
+// Each chip select drives a daisy chain of modules. With more rows of
+// modules than chip selects, a chain covers MATRIX_CHAIN_ROWS rows. It starts
+// at the left module of its top row, and goes on from the right end of each
+// row to the left end of the next.
+#define NUM_CHAINS ((NUM_MATRIX_ROWS < 4) ? NUM_MATRIX_ROWS : 4)
+#define MATRIX_CHAIN_ROWS (NUM_MATRIX_ROWS / NUM_CHAINS)
+
 
 //// Pins /////////////////////////////////////////////////////////////////////
 
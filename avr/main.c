@@ -1,6 +1,7 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 
 #include "io.h"
 #include "config.h"
@@ -16,12 +17,29 @@ volatile uint8_t prev_intensity;
 
 #define I2C_ADDRESS 0x5B
 
-#define NUM_MATRIX_COLS 4
-#define NUM_MATRIX_ROWS 4
+#if (MATRIX_WIDTH < 32) || (MATRIX_HEIGHT < 32)
+#error "The matrix must be at least 32x32"
+#endif
+
+#if (MATRIX_WIDTH % 8) || (MATRIX_HEIGHT % 8) || (NUM_MATRIX_ROWS % NUM_CHAINS)
+#error "The matrix must be made of whole modules, and each chain of whole rows of modules"
+#endif
+
+// Leave some RAM for the stack and the other variables. See config.h for the
+// sizes which fit on each part.
+#if 8 * NUM_MATRIX_COLS * NUM_MATRIX_ROWS + 64 > RAMEND - RAMSTART + 1
+#error "The framebuffer does not fit in RAM, see config.h"
+#endif
 
 #define REV(b) ((((b) & 0x80) >> 7) | (((b) & 0x40) >> 5) | (((b) & 0x20) >> 3) | (((b) & 0x10) >> 1) | (((b) & 0x08) << 1) | (((b) & 0x04) << 3) | (((b) & 0x02) << 5) | (((b) & 0x01) << 7))
 
-volatile uint8_t framebuffer[8*NUM_MATRIX_COLS*NUM_MATRIX_ROWS] = {
+volatile uint8_t framebuffer[8*NUM_MATRIX_COLS*NUM_MATRIX_ROWS];
+
+// Shown at the center of the matrix until the first frame arrives
+#define SPLASH_WIDTH 32
+#define SPLASH_HEIGHT 32
+
+static const uint8_t splash[SPLASH_WIDTH / 8 * SPLASH_HEIGHT] PROGMEM = {
     REV(0b00000000), REV(0b00000000), REV(0b00000000), REV(0b00000000),
     REV(0b00000000), REV(0b00001111), REV(0b11110000), REV(0b00000000),
     REV(0b00000000), REV(0b01110000), REV(0b00001110), REV(0b00000000),
@@ -65,6 +83,7 @@ volatile uint8_t framebuffer[8*NUM_MATRIX_COLS*NUM_MATRIX_ROWS] = {
 #define CS3 4
 #define CS4 8
 
+#define CS_ALL ((1 << NUM_CHAINS) - 1)
 
 void IO_init(void)
 {
@@ -141,7 +160,7 @@ void SPI_CS_high(uint8_t cs)
 void MAX7219_cmd(uint8_t reg, uint8_t val, uint8_t cs)
 {
     SPI_CS_low(cs);
-    for(uint8_t i = 0; i < NUM_MATRIX_COLS; i++) {
+    for(uint8_t i = 0; i < NUM_MATRIX_COLS * MATRIX_CHAIN_ROWS; i++) {
         SPI_transfer(reg);
         SPI_transfer(val);
     }
@@ -164,49 +183,37 @@ void MAX7219_init(uint8_t cs, uint8_t intensity)
     MAX7219_cmd(MAX7219_REG_SHUTDOWN, 0x01, cs);
 }
 
+// Each digit register of a MAX7219 holds a row of its module. The data is
+// shifted through the chain, so the module at the far end is sent first.
 void fb_show(void)
 {
-    int n = 3;
-
-    n = 3;
-    for(uint8_t y = 8; y >= 1; y--) {
-        SPI_CS_low(CS1);
-        for(uint8_t x = 0; x < 4; x++) {
-            SPI_transfer(y);
-            SPI_transfer(framebuffer[n--]);
-        }
-        SPI_CS_high(CS1);
-        n += 8;
-    }
+    for(uint8_t chain = 0; chain < NUM_CHAINS; chain++) {
+        const uint8_t cs = 1 << chain;
 
-    for(uint8_t y = 8; y >= 1; y--) {
-        SPI_CS_low(CS2);
-        for(uint8_t x = 0; x < 4; x++) {
-            SPI_transfer(y);
-            SPI_transfer(framebuffer[n--]);
-        }
-        SPI_CS_high(CS2);
-        n += 8;
-    }
+        for(uint8_t y = 0; y < 8; y++) {
+            SPI_CS_low(cs);
+            for(int8_t r = MATRIX_CHAIN_ROWS - 1; r >= 0; r--) {
+                uint16_t n = (((chain * MATRIX_CHAIN_ROWS + r) * 8 + y) + 1) * NUM_MATRIX_COLS;
 
-    for(uint8_t y = 8; y >= 1; y--) {
-        SPI_CS_low(CS3);
-        for(uint8_t x = 0; x < 4; x++) {
-            SPI_transfer(y);
-            SPI_transfer(framebuffer[n--]);
+                for(uint8_t x = 0; x < NUM_MATRIX_COLS; x++) {
+                    SPI_transfer(8 - y);
+                    SPI_transfer(framebuffer[--n]);
+                }
+            }
+            SPI_CS_high(cs);
         }
-        SPI_CS_high(CS3);
-        n += 8;
     }
+}
+
+void fb_splash(void)
+{
+    const uint8_t x0 = (NUM_MATRIX_COLS - SPLASH_WIDTH / 8) / 2;
+    const uint8_t y0 = (MATRIX_HEIGHT - SPLASH_HEIGHT) / 2;
 
-    for(uint8_t y = 8; y >= 1; y--) {
-        SPI_CS_low(CS4);
-        for(uint8_t x = 0; x < 4; x++) {
-            SPI_transfer(y);
-            SPI_transfer(framebuffer[n--]);
+    for(uint8_t y = 0; y < SPLASH_HEIGHT; y++) {
+        for(uint8_t x = 0; x < SPLASH_WIDTH / 8; x++) {
+            framebuffer[(y0 + y) * NUM_MATRIX_COLS + x0 + x] = pgm_read_byte(&splash[y * SPLASH_WIDTH / 8 + x]);
         }
-        SPI_CS_high(CS4);
-        n += 8;
     }
 }
 
@@ -309,8 +316,10 @@ int main(void)
     i2c_init();
     adc_init();
 
-    MAX7219_init(CS1 | CS2 | CS3 | CS4, 0);
-    MAX7219_blank(CS1 | CS2 | CS3 | CS4);
+    fb_splash();
+
+    MAX7219_init(CS_ALL, 0);
+    MAX7219_blank(CS_ALL);
 
     GPIOR0 |= FLAG_FB_UPDATED;
     sei();
@@ -354,7 +363,7 @@ int main(void)
             prev_adc_value_lo = adc_value & 0xFF;
             prev_intensity = current_intensity;
 
-            MAX7219_init(CS1 | CS2 | CS3 | CS4, current_intensity);
+            MAX7219_init(CS_ALL, current_intensity);
             fb_show();
 
             GPIOR0 &= ~(FLAG_REDRAWING | FLAG_FB_UPDATED);
@@ -372,7 +381,8 @@ int main(void)
 ISR(TWI_SLAVE_vect)
 {
     static uint8_t write_cmd;
-    static uint8_t write_index;
+    static uint16_t write_index;
+    static uint8_t write_header_len;
     static uint8_t read_index;
 
     uint8_t status = TWSSRA;
@@ -389,13 +399,14 @@ ISR(TWI_SLAVE_vect)
                 } else {
                     write_cmd = AVR_I2C_CMD_NONE;
                     write_index = 0;
+                    write_header_len = 0;
                 }
 
                 TWSCRB = TW_CMD_ACK;
             }
         } else { // Stop condition
             if(!(status & _BV(TWDIR))) {
-                if(write_cmd == AVR_I2C_CMD_FRAMEBUFFER) {
+                if((write_cmd == AVR_I2C_CMD_FRAMEBUFFER) || (write_cmd == AVR_I2C_CMD_SHOW)) {
                     GPIOR0 |= FLAG_FB_UPDATED;
                 }
             }
@@ -429,6 +440,15 @@ ISR(TWI_SLAVE_vect)
                 write_index = (write_index + 1) % sizeof(framebuffer);
                 break;
 
+            case AVR_I2C_CMD_FRAMEBUFFER_CHUNK:
+                // The offset comes first, LSB first
+                if(write_header_len < 2) {
+                    write_index |= (uint16_t)TWSD << (8 * write_header_len++);
+                } else if(write_index < sizeof(framebuffer)) {
+                    framebuffer[write_index++] = TWSD;
+                }
+                break;
+
             case AVR_I2C_CMD_INTENSITY_LOW:
             {
                 uint8_t *ptr = (uint8_t*)light_tab_low;
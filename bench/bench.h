@@ -0,0 +1,41 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+#include <time.h>
+
+// Host benchmarks. The scene replays a minute of display activity with the
+// real renderers, oled_render_frame and matrix_render_frame, see replay.c.
+
+#define BENCH_SCENE_DURATION_MS 60000
+
+static inline double bench_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Start the minute over. The renderers keep the state of their animations,
+// so the frames of a replay must be drawn in order.
+void bench_scene_init(void);
+
+// Draw the frame shown at time t_ms with the current driver, see
+// display_driver_select. Returns the number of milliseconds until the
+// display task would draw the next frame.
+uint32_t bench_scene_oled(uint32_t t_ms);
+uint32_t bench_scene_matrix(uint32_t t_ms);
+
+// FNV-1a, to compare frames of replays which cannot be drawn side by side
+static inline uint32_t bench_hash(const uint8_t *data, int len)
+{
+    uint32_t hash = 2166136261u;
+
+    for(int i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+#endif
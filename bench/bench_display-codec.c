@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "oled_framebuffer.h"
+#include "display-codec.h"
+#include "display-driver.h"
+#include "display-host.h"
+
+// Replay a minute of display activity through the mirror encoder and compare
+// the bandwidth with sending the raw framebuffer on every frame.
+
+static uint8_t prev[OLED_SIZE];
+static uint8_t buf[DISPLAY_CODEC_HEADER_LEN + OLED_SIZE];
+
+static void run(const char *name, const struct display_driver *driver, uint32_t (*scene)(uint32_t))
+{
+    const struct display_codec_format *format = &driver->format;
+    const int len = display_codec_frame_len(format);
+
+    long num_frames = 0;
+    long num_keyframes = 0;
+    long num_deltas = 0;
+    long raw_bytes = 0;
+    long encoded_bytes = 0;
+    double encode_time = 0;
+
+    int have_prev = 0;
+
+    display_driver_select(driver);
+    bench_scene_init();
+
+    for(uint32_t t = 0; t < BENCH_SCENE_DURATION_MS; ) {
+        t += scene(t);
+        num_frames++;
+        raw_bytes += len;
+
+        double start = bench_time();
+
+        int n = have_prev ? display_codec_encode_delta(format, prev, framebuffer, buf, sizeof(buf) - 1) : -1;
+
+        if(n < 0) {
+            n = display_codec_encode_keyframe(format, framebuffer, buf, sizeof(buf));
+            num_keyframes++;
+        } else if(n > 0) {
+            num_deltas++;
+        }
+
+        encode_time += bench_time() - start;
+
+        memcpy(prev, framebuffer, len);
+        have_prev = 1;
+
+        encoded_bytes += n;
+    }
+
+    const double seconds = BENCH_SCENE_DURATION_MS / 1000.0;
+
+    printf("%-8s %5ld frames: %4ld keyframes, %4ld deltas, %5ld unchanged\n", name, num_frames, num_keyframes, num_deltas, num_frames - num_keyframes - num_deltas);
+    printf("%-8s raw %8.0f B/s  encoded %7.0f B/s  (%.1f%%)  encode %.2f us/frame\n", "",
+           raw_bytes / seconds, encoded_bytes / seconds, 100.0 * encoded_bytes / raw_bytes, 1e6 * encode_time / num_frames);
+}
+
+int main(void)
+{
+    run("OLED", &display_null_oled, bench_scene_oled);
+    run("Matrix", &display_null_matrix, bench_scene_matrix);
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "oled_framebuffer.h"
+#include "matrix_framebuffer.h"
+#include "fonts.h"
+
+#include "../utils/font-rle.h"
+
+// Encode each font the way utils/font-to-rle does, and compare the size of
+// the glyph data and the time to draw a string with the plain and the run
+// length encoded font.
+
+#define REPEAT 20000
+
+static const struct {
+    const char *name;
+    const uint8_t *font;
+    const char *text;
+} fonts[] = {
+    { "ArialMT_Plain_10", ArialMT_Plain_10, "Connect to 192.168.1.20" },
+    { "ArialMT_Plain_16", ArialMT_Plain_16, "12:34 Slussen" },
+    { "ArialMT_Plain_24", ArialMT_Plain_24, "12:34" },
+    { "Monospaced_bold_16", Monospaced_bold_16, "12:34" },
+    { "Monospaced_plain_28", Monospaced_plain_28, "12:34" },
+    { "font_3x5", font_3x5, "17 12:34" },
+    { "font_5x7", font_5x7, "12345" },
+    { "font_6x12", font_6x12, "12:34" },
+};
+
+static uint8_t reference[OLED_SIZE];
+
+static uint16_t glyph_data_size(const uint8_t *font)
+{
+    const uint8_t char_num = font[FONT_CHAR_NUM_POS];
+    uint16_t size = 0;
+
+    for(int n = 0; n < char_num; n++) {
+        const uint8_t *entry = font + FONT_JUMPTABLE_START + n * FONT_JUMPTABLE_BYTES;
+
+        if(entry[FONT_JUMPTABLE_MSB] != 0xFF) {
+            size += entry[FONT_JUMPTABLE_SIZE];
+        }
+    }
+
+    return size;
+}
+
+static uint8_t *encode_font(const uint8_t *font)
+{
+    const uint8_t height = font[FONT_HEIGHT_POS];
+    const uint8_t char_num = font[FONT_CHAR_NUM_POS];
+    const uint16_t jump_table_size = char_num * FONT_JUMPTABLE_BYTES;
+    const uint8_t *glyphs = font + FONT_JUMPTABLE_START + jump_table_size;
+
+    uint8_t *rle = malloc(FONT_JUMPTABLE_START + jump_table_size + 2 * glyph_data_size(font) + char_num);
+    uint8_t *data = rle + FONT_JUMPTABLE_START + jump_table_size;
+    uint16_t offset = 0;
+
+    memcpy(rle, font, FONT_JUMPTABLE_START + jump_table_size);
+    rle[FONT_WIDTH_POS] |= FONT_RLE_FLAG;
+
+    for(int n = 0; n < char_num; n++) {
+        uint8_t *entry = rle + FONT_JUMPTABLE_START + n * FONT_JUMPTABLE_BYTES;
+        const uint16_t index = (entry[FONT_JUMPTABLE_MSB] << 8) | entry[FONT_JUMPTABLE_LSB];
+
+        if(index == 0xFFFF) {
+            continue;
+        }
+
+        const int size = font_rle_encode(data + offset, glyphs + index, entry[FONT_JUMPTABLE_SIZE], entry[FONT_JUMPTABLE_WIDTH], height);
+
+        entry[FONT_JUMPTABLE_MSB] = offset >> 8;
+        entry[FONT_JUMPTABLE_LSB] = offset & 0xFF;
+        entry[FONT_JUMPTABLE_SIZE] = size;
+
+        offset += size;
+    }
+
+    return rle;
+}
+
+static double run(const uint8_t *font, const char *text, void (*clear)(void))
+{
+    double start = bench_time();
+
+    for(int n = 0; n < REPEAT; n++) {
+        clear();
+        fb_draw_string(n % 16, 2, text, 0, font, FB_ALIGN_NONE);
+    }
+
+    return bench_time() - start;
+}
+
+static int compare(const uint8_t *font, const uint8_t *rle, const char *text, void (*clear)(void), uint16_t size)
+{
+    for(int n = 0; n < 16; n++) {
+        clear();
+        fb_draw_string(n, 2, text, 0, font, FB_ALIGN_NONE);
+        memcpy(reference, framebuffer, size);
+
+        clear();
+        fb_draw_string(n, 2, text, 0, rle, FB_ALIGN_NONE);
+
+        if(memcmp(reference, framebuffer, size)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    fb_set_pen(FB_NORMAL);
+
+    printf("%-20s %15s %22s %22s\n", "", "glyph bytes", "oled us/string", "matrix us/string");
+
+    for(int i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+        const uint8_t *font = fonts[i].font;
+        uint8_t *rle = encode_font(font);
+
+        fb_blit = oled_blit;
+        if(compare(font, rle, fonts[i].text, oled_clear, OLED_SIZE)) {
+            printf("%s: OLED frames differ\n", fonts[i].name);
+            return 1;
+        }
+
+        const double oled_plain = run(font, fonts[i].text, oled_clear);
+        const double oled_rle = run(rle, fonts[i].text, oled_clear);
+
+        fb_blit = matrix_blit;
+        if(compare(font, rle, fonts[i].text, matrix_clear, MATRIX_SIZE)) {
+            printf("%s: matrix frames differ\n", fonts[i].name);
+            return 1;
+        }
+
+        const double matrix_plain = run(font, fonts[i].text, matrix_clear);
+        const double matrix_rle = run(rle, fonts[i].text, matrix_clear);
+
+        printf("%-20s %6d -> %6d %8.2f -> %8.2f %8.2f -> %8.2f\n", fonts[i].name, glyph_data_size(font), glyph_data_size(rle),
+               1e6 * oled_plain / REPEAT, 1e6 * oled_rle / REPEAT, 1e6 * matrix_plain / REPEAT, 1e6 * matrix_rle / REPEAT);
+
+        free(rle);
+    }
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "oled_framebuffer.h"
+#include "matrix_framebuffer.h"
+#include "glyph-cache.h"
+#include "fonts.h"
+
+// Draw the times shown on a frame, the clock and two departures, with
+// fb_draw_string and from the glyph cache.
+
+#define REPEAT 20000
+
+static const char *times[] = { "12:34", "12 34", "12:40", "--:--" };
+
+static uint8_t reference[OLED_SIZE];
+
+static void draw_oled(const struct glyph_cache *cache, int n)
+{
+    const int16_t shift = n % 16;
+
+    oled_clear();
+
+    if(cache) {
+        glyph_cache_draw_string(cache, 75, 10, times[n & 1], FB_ALIGN_CENTER_V);
+        glyph_cache_draw_string(cache, 75 + shift, 32, times[2], FB_ALIGN_CENTER_V);
+        glyph_cache_draw_string(cache, 75, 54 - shift, times[3], FB_ALIGN_CENTER_V);
+    } else {
+        fb_draw_string(75, 10, times[n & 1], 0, Monospaced_bold_16, FB_ALIGN_CENTER_V);
+        fb_draw_string(75 + shift, 32, times[2], 0, Monospaced_bold_16, FB_ALIGN_CENTER_V);
+        fb_draw_string(75, 54 - shift, times[3], 0, Monospaced_bold_16, FB_ALIGN_CENTER_V);
+    }
+}
+
+static void draw_matrix(const struct glyph_cache *clock_cache, const struct glyph_cache *journey_cache, int n)
+{
+    const int16_t shift = n % 16;
+
+    matrix_clear();
+
+    if(clock_cache) {
+        glyph_cache_draw_string(clock_cache, 1, 7, times[0], FB_ALIGN_CENTER_V);
+        glyph_cache_draw_string(journey_cache, 12 + shift, 19, times[2], FB_ALIGN_CENTER_V);
+        glyph_cache_draw_string(journey_cache, 12, 28, times[3], FB_ALIGN_CENTER_V);
+    } else {
+        fb_draw_string(1, 7, times[0], 0, font_6x12, FB_ALIGN_CENTER_V);
+        fb_draw_string(12 + shift, 19, times[2], 0, font_3x5, FB_ALIGN_CENTER_V);
+        fb_draw_string(12, 28, times[3], 0, font_3x5, FB_ALIGN_CENTER_V);
+    }
+}
+
+int main(void)
+{
+    struct glyph_cache oled_cache;
+    struct glyph_cache clock_cache;
+    struct glyph_cache journey_cache;
+
+    glyph_cache_init(&oled_cache, Monospaced_bold_16, GLYPH_CACHE_LAYOUT_PAGES);
+    glyph_cache_init(&clock_cache, font_6x12, GLYPH_CACHE_LAYOUT_ROWS);
+    glyph_cache_init(&journey_cache, font_3x5, GLYPH_CACHE_LAYOUT_ROWS);
+
+    fb_set_pen(FB_NORMAL);
+
+    for(int n = 0; n < 32; n++) {
+        fb_blit = oled_blit;
+        fb_blit_native = oled_blit;
+        draw_oled(0, n);
+        memcpy(reference, framebuffer, OLED_SIZE);
+        draw_oled(&oled_cache, n);
+
+        if(memcmp(reference, framebuffer, OLED_SIZE)) {
+            printf("OLED frames differ at frame %d\n", n);
+            return 1;
+        }
+
+        fb_blit = matrix_blit;
+        fb_blit_native = matrix_blit_rows;
+        draw_matrix(0, 0, n);
+        memcpy(reference, framebuffer, MATRIX_SIZE);
+        draw_matrix(&clock_cache, &journey_cache, n);
+
+        if(memcmp(reference, framebuffer, MATRIX_SIZE)) {
+            printf("Matrix frames differ at frame %d\n", n);
+            return 1;
+        }
+    }
+
+    double start;
+
+    fb_blit = oled_blit;
+    fb_blit_native = oled_blit;
+
+    start = bench_time();
+    for(int n = 0; n < REPEAT; n++) {
+        draw_oled(0, n);
+    }
+    double oled_font = bench_time() - start;
+
+    start = bench_time();
+    for(int n = 0; n < REPEAT; n++) {
+        draw_oled(&oled_cache, n);
+    }
+    double oled_cached = bench_time() - start;
+
+    fb_blit = matrix_blit;
+    fb_blit_native = matrix_blit_rows;
+
+    start = bench_time();
+    for(int n = 0; n < REPEAT; n++) {
+        draw_matrix(0, 0, n);
+    }
+    double matrix_font = bench_time() - start;
+
+    start = bench_time();
+    for(int n = 0; n < REPEAT; n++) {
+        draw_matrix(&clock_cache, &journey_cache, n);
+    }
+    double matrix_cached = bench_time() - start;
+
+    printf("%-8s font %6.2f us/frame  cache %6.2f us/frame  (%.1fx)\n", "OLED", 1e6 * oled_font / REPEAT, 1e6 * oled_cached / REPEAT, oled_font / oled_cached);
+    printf("%-8s font %6.2f us/frame  cache %6.2f us/frame  (%.1fx)\n", "Matrix", 1e6 * matrix_font / REPEAT, 1e6 * matrix_cached / REPEAT, matrix_font / matrix_cached);
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "matrix_framebuffer.h"
+#include "fonts.h"
+#include "display-driver.h"
+#include "display-host.h"
+
+// Draw text on the LED matrix with the block transposing matrix_blit and
+// with the previous implementation, which tested and set one pixel at a time.
+
+#define REPEAT 20000
+
+static uint8_t reference[MATRIX_SIZE];
+
+static void pixel_blit(int16_t x0, int16_t y0, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len)
+{
+    uint8_t raster_height = 1 + ((h - 1) / 8);
+
+    if(!len)
+    {
+        len = w * raster_height;
+    }
+
+    for(int16_t x = 0; x < w; x++) {
+        for(int16_t y = 0; y < h; y++) {
+            uint8_t n = (y / 8) + x * raster_height;
+            if((n < len) && (data[n] & (1 << (y % 8)))) {
+                matrix_set_pixel(x0+x,y0+y);
+            }
+        }
+    }
+}
+
+static void draw_text(const uint8_t *font, int16_t shift)
+{
+    const uint8_t height = font[FONT_HEIGHT_POS];
+
+    matrix_clear();
+
+    for(int16_t y = 0; y + height <= MATRIX_HEIGHT; y += height + 1) {
+        fb_draw_string(shift + y / 4, y, "12:34", 0, font, 0);
+    }
+}
+
+static double run_text(const uint8_t *font)
+{
+    double start = bench_time();
+
+    for(int n = 0; n < REPEAT; n++) {
+        draw_text(font, n % 8 - 4);
+    }
+
+    return bench_time() - start;
+}
+
+static double run_scene(void (*blit)(int16_t, int16_t, uint16_t, uint16_t, const uint8_t *, uint16_t), long *num_frames)
+{
+    display_driver_select(&display_null_matrix);
+    fb_blit = blit;
+    *num_frames = 0;
+
+    double start = bench_time();
+
+    for(int n = 0; n < REPEAT / 1000; n++) {
+        bench_scene_init();
+
+        for(uint32_t t = 0; t < BENCH_SCENE_DURATION_MS; ) {
+            t += bench_scene_matrix(t);
+            (*num_frames)++;
+        }
+    }
+
+    return bench_time() - start;
+}
+
+static int compare(const uint8_t *font)
+{
+    for(int16_t shift = -8; shift <= 8; shift++) {
+        fb_blit = pixel_blit;
+        draw_text(font, shift);
+        memcpy(reference, framebuffer, MATRIX_SIZE);
+
+        fb_blit = matrix_blit;
+        draw_text(font, shift);
+
+        if(memcmp(reference, framebuffer, MATRIX_SIZE)) {
+            printf("Frames differ at shift %d\n", shift);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void bench_text(const char *name, const uint8_t *font)
+{
+    fb_blit = pixel_blit;
+    double pixel = run_text(font);
+
+    fb_blit = matrix_blit;
+    double block = run_text(font);
+
+    printf("%-10s per pixel %6.2f us/frame  block %6.2f us/frame  (%.1fx)\n", name, 1e6 * pixel / REPEAT, 1e6 * block / REPEAT, pixel / block);
+}
+
+int main(void)
+{
+    long num_frames;
+
+    if(compare(font_3x5) || compare(font_6x12)) {
+        return 1;
+    }
+
+    bench_text("font_3x5", font_3x5);
+    bench_text("font_6x12", font_6x12);
+
+    double pixel = run_scene(pixel_blit, &num_frames);
+    double block = run_scene(matrix_blit, &num_frames);
+
+    printf("%-10s per pixel %6.2f us/frame  block %6.2f us/frame  (%.1fx)\n", "scene", 1e6 * pixel / num_frames, 1e6 * block / num_frames, pixel / block);
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "oled_framebuffer.h"
+#include "display-driver.h"
+#include "display-host.h"
+
+// Render a minute of OLED frames with the generic blit and with oled_blit,
+// and check that both give the same framebuffers.
+
+#define REPEAT 20
+
+// Enough for a minute of frames drawn every DISPLAY_SCHEDULE_ANIMATION_MS
+#define MAX_FRAMES (BENCH_SCENE_DURATION_MS / 25 + 1)
+
+static uint32_t reference[MAX_FRAMES];
+
+static void select_blit(void (*blit)(int16_t, int16_t, uint16_t, uint16_t, const uint8_t *, uint16_t))
+{
+    display_driver_select(&display_null_oled);
+    fb_blit = blit;
+}
+
+static double run(void (*blit)(int16_t, int16_t, uint16_t, uint16_t, const uint8_t *, uint16_t), long *num_frames)
+{
+    select_blit(blit);
+    *num_frames = 0;
+
+    double start = bench_time();
+
+    for(int n = 0; n < REPEAT; n++) {
+        bench_scene_init();
+
+        for(uint32_t t = 0; t < BENCH_SCENE_DURATION_MS; ) {
+            t += bench_scene_oled(t);
+            (*num_frames)++;
+        }
+    }
+
+    return bench_time() - start;
+}
+
+// Replay the minute with blit, and compare each frame with the reference if
+// check is set, or record it as the reference otherwise
+static int replay(void (*blit)(int16_t, int16_t, uint16_t, uint16_t, const uint8_t *, uint16_t), int check)
+{
+    int n = 0;
+
+    select_blit(blit);
+    bench_scene_init();
+
+    for(uint32_t t = 0; (t < BENCH_SCENE_DURATION_MS) && (n < MAX_FRAMES); n++) {
+        const uint32_t frame_t = t;
+
+        t += bench_scene_oled(t);
+
+        const uint32_t hash = bench_hash(framebuffer, OLED_SIZE);
+
+        if(!check) {
+            reference[n] = hash;
+        } else if(reference[n] != hash) {
+            printf("Frames differ at %u ms\n", frame_t);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    long num_frames;
+
+    replay(oled_blit_generic, 0);
+
+    if(replay(oled_blit, 1)) {
+        return 1;
+    }
+
+    double generic = run(oled_blit_generic, &num_frames);
+    double fast = run(oled_blit, &num_frames);
+
+    printf("oled_blit_generic %6.2f us/frame\n", 1e6 * generic / num_frames);
+    printf("oled_blit         %6.2f us/frame  (%.1fx)\n", 1e6 * fast / num_frames, generic / fast);
+
+    return 0;
+}
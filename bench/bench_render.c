@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "oled_render.h"
+#include "matrix_render.h"
+#include "display-schedule.h"
+#include "display-host.h"
+#include "animation.h"
+#include "journey.h"
+#include "status.h"
+
+// Render the scenes of the displays with the real display code on a virtual
+// clock, and send the frames to the null drivers. Reports the time per frame
+// when drawing every FRAME_MS, and how many frames the display task would
+// draw in a minute when paced by the schedule, as in display_wait_frame. The
+// last frame of each scene is written to bench/bin with the PBM driver.
+
+#define FRAME_MS 25
+#define REPEAT 10
+
+// 2018-03-14 12:34:56 UTC
+#define CLOCK_START 1521030896
+
+struct scene
+{
+    const char *name;
+    int num_journies;
+    const char *message;
+};
+
+static const struct scene scenes[] = {
+    { .name = "clock", .num_journies = 0 },
+    { .name = "two_journeys", .num_journies = 2 },
+    { .name = "single_journey", .num_journies = 1 },
+    { .name = "message_box", .num_journies = 2, .message = "No journies configured\nConnect to\n192.168.1.20\nto configure" },
+};
+
+typedef void (*render_frame_fn)(uint32_t now_ms, const struct timeval *now, struct display_schedule *schedule);
+
+struct display
+{
+    const char *name;
+    const struct display_driver *driver;
+    render_frame_fn frame;
+};
+
+static const struct display displays[] = {
+    { .name = "oled", .driver = &display_null_oled, .frame = oled_render_frame },
+    { .name = "matrix", .driver = &display_null_matrix, .frame = matrix_render_frame },
+};
+
+static void setup_scene(const struct scene *scene)
+{
+    memset(journies, 0, sizeof(journies));
+    app_status = (struct app_status) { .wifi_connected = 1, .obtained_time = 1, .obtained_tz = 1 };
+
+    for(int i = 0; i < scene->num_journies; i++) {
+        snprintf(journies[i].line, sizeof(journies[i].line), "%d", 4 + 13 * i);
+        snprintf(journies[i].destination, sizeof(journies[i].destination), "Hässelby strand");
+        journies[i].mode = TRANSPORT_MODE_BUS + i;
+
+        for(int j = 0; j < JOURNEY_MAX_DEPARTURES; j++) {
+            journies[i].departures[j] = CLOCK_START + 60 * (3 + 5 * i + 7 * j);
+        }
+    }
+
+    oled_render_init();
+    matrix_render_init();
+
+    if(scene->message) {
+        oled_render_set_message(DISPLAY_MESSAGE_NO_JOURNIES, scene->message);
+    }
+}
+
+// Draw and send the frame at t, and return the time until the next frame
+static uint32_t draw(const struct display *display, uint32_t t)
+{
+    struct display_schedule schedule;
+    struct timeval now = { .tv_sec = CLOCK_START + t / 1000, .tv_usec = (t % 1000) * 1000 };
+
+    display_schedule_init(&schedule);
+    display->frame(t, &now, &schedule);
+
+    if(display_driver->prepare) {
+        display_driver->prepare();
+    }
+    display_driver->flush(framebuffer);
+
+    return animation_active() ? DISPLAY_SCHEDULE_ANIMATION_MS : display_schedule_delay_ms(&schedule);
+}
+
+static double run(const struct display *display, long *num_frames)
+{
+    *num_frames = 0;
+
+    double start = bench_time();
+
+    for(uint32_t t = 0; t < BENCH_SCENE_DURATION_MS; t += FRAME_MS) {
+        draw(display, t);
+        (*num_frames)++;
+    }
+
+    return bench_time() - start;
+}
+
+static double run_paced(const struct display *display, long *num_frames)
+{
+    *num_frames = 0;
+
+    double start = bench_time();
+
+    for(uint32_t t = 0; t < BENCH_SCENE_DURATION_MS; ) {
+        t += draw(display, t);
+        (*num_frames)++;
+    }
+
+    return bench_time() - start;
+}
+
+int main(void)
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    for(int i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++) {
+        const struct scene *scene = &scenes[i];
+
+        printf("%-16s", scene->name);
+
+        for(int d = 0; d < sizeof(displays) / sizeof(displays[0]); d++) {
+            const struct display *display = &displays[d];
+            double time = 0, paced_time = 0;
+            long num_frames, num_paced_frames;
+            char filename[64];
+
+            display_driver_select(display->driver);
+
+            for(int n = 0; n < REPEAT; n++) {
+                setup_scene(scene);
+                time += run(display, &num_frames);
+
+                setup_scene(scene);
+                paced_time += run_paced(display, &num_paced_frames);
+            }
+
+            num_frames *= REPEAT;
+
+            printf(" %s %6.2f us/frame %4ld frames/min %5.2f ms/min", display->name, 1e6 * time / num_frames, num_paced_frames, 1e3 * paced_time / REPEAT);
+
+            snprintf(filename, sizeof(filename), "bench/bin/%s_%s.pbm", display->name, scene->name);
+            display_driver_select(display_pbm_driver(display->driver, filename));
+            draw(display, BENCH_SCENE_DURATION_MS);
+        }
+
+        printf("\n");
+    }
+
+    return 0;
+}
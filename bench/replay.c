@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "oled_render.h"
+#include "matrix_render.h"
+#include "display-schedule.h"
+#include "animation.h"
+#include "journey.h"
+#include "status.h"
+
+// A minute of the clock with two journeys, drawn by the real renderers. Each
+// journey has a departure every JOURNEY_PERIOD_S, out of phase, and when one
+// leaves the row of that journey is shifted out and in again with the next
+// departure. A message box slides in and out once during the minute.
+
+#define JOURNEY_PERIOD_S 15
+#define JOURNEY_PHASE_S 7
+
+#define MESSAGE_START_MS 30000
+#define MESSAGE_END_MS 40000
+
+// 2018-03-14 12:34:56 UTC
+#define CLOCK_START 1521030896
+
+struct journey journies[JOURNEY_MAX_JOURNIES];
+struct app_status app_status;
+
+static uint8_t message_shown;
+
+void bench_scene_init(void)
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    memset(journies, 0, sizeof(journies));
+    app_status = (struct app_status) { .wifi_connected = 1, .obtained_time = 1, .obtained_tz = 1 };
+
+    for(int i = 0; i < 2; i++) {
+        snprintf(journies[i].line, sizeof(journies[i].line), "%d", 4 + 13 * i);
+        snprintf(journies[i].destination, sizeof(journies[i].destination), "Hässelby strand");
+        journies[i].mode = TRANSPORT_MODE_BUS + i;
+    }
+
+    oled_render_init();
+    matrix_render_init();
+
+    message_shown = 0;
+}
+
+// Drop the departures which have left, as the journey task does
+static void update_departures(time_t now)
+{
+    for(int i = 0; i < 2; i++) {
+        const time_t start = CLOCK_START - i * JOURNEY_PHASE_S;
+        const time_t first = (now - start) / JOURNEY_PERIOD_S + 1;
+
+        for(int j = 0; j < JOURNEY_MAX_DEPARTURES; j++) {
+            journies[i].departures[j] = start + (first + j) * JOURNEY_PERIOD_S;
+        }
+    }
+}
+
+static uint32_t draw(void (*frame)(uint32_t, const struct timeval *, struct display_schedule *), uint32_t t_ms)
+{
+    struct display_schedule schedule;
+    struct timeval now = { .tv_sec = CLOCK_START + t_ms / 1000, .tv_usec = (t_ms % 1000) * 1000 };
+
+    update_departures(now.tv_sec);
+
+    display_schedule_init(&schedule);
+    frame(t_ms, &now, &schedule);
+
+    return animation_active() ? DISPLAY_SCHEDULE_ANIMATION_MS : display_schedule_delay_ms(&schedule);
+}
+
+uint32_t bench_scene_oled(uint32_t t_ms)
+{
+    if((message_shown == 0) && (t_ms >= MESSAGE_START_MS)) {
+        oled_render_set_message(DISPLAY_MESSAGE_NO_WIFI, "Could not connect\nto WiFi");
+        message_shown = 1;
+    } else if((message_shown == 1) && (t_ms >= MESSAGE_END_MS)) {
+        oled_render_set_message(DISPLAY_MESSAGE_NONE, NULL);
+        message_shown = 2;
+    }
+
+    return draw(oled_render_frame, t_ms);
+}
+
+uint32_t bench_scene_matrix(uint32_t t_ms)
+{
+    return draw(matrix_render_frame, t_ms);
+}
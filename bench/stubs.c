@@ -0,0 +1,24 @@
+#include <stdint.h>
+#include <stdarg.h>
+
+#include "i2c-master.h"
+#include "log.h"
+
+//////// Stubs /////////////////////////////////////////////////////////////////
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_NACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+void oled_display(void)
+{
+}
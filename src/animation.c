@@ -0,0 +1,101 @@
+#include <stdint.h>
+
+#include "animation.h"
+
+// Progress along a step in Q15 fixed point
+#define ANIMATION_ONE 0x8000
+
+static uint8_t animation_num_active;
+
+static uint32_t animation_ease(uint8_t easing, uint32_t t)
+{
+    uint32_t u;
+
+    switch(easing) {
+    case ANIMATION_EASE_IN:
+        return (t * t) / ANIMATION_ONE;
+
+    case ANIMATION_EASE_OUT:
+        u = ANIMATION_ONE - t;
+        return ANIMATION_ONE - (u * u) / ANIMATION_ONE;
+
+    case ANIMATION_EASE_IN_OUT:
+        if(t < ANIMATION_ONE / 2) {
+            return (2 * t * t) / ANIMATION_ONE;
+        }
+        u = ANIMATION_ONE - t;
+        return ANIMATION_ONE - (2 * u * u) / ANIMATION_ONE;
+
+    default:
+        return t;
+    }
+}
+
+int16_t animation_step_value(const struct animation_step *step, uint32_t elapsed_ms)
+{
+    if(elapsed_ms >= step->duration_ms) {
+        return step->to;
+    }
+
+    const uint32_t t = (elapsed_ms * ANIMATION_ONE) / step->duration_ms;
+    const int32_t delta = step->to - step->from;
+    const int32_t offset = delta * (int32_t) animation_ease(step->easing, t);
+
+    // Round to the nearest pixel
+    if(offset < 0) {
+        return step->from + (offset - ANIMATION_ONE / 2) / ANIMATION_ONE;
+    } else {
+        return step->from + (offset + ANIMATION_ONE / 2) / ANIMATION_ONE;
+    }
+}
+
+void animation_start(struct animation *anim, int16_t *variable, const struct animation_step *steps, uint8_t num_steps, uint32_t now_ms)
+{
+    anim->start_ms = now_ms;
+    animation_continue(anim, variable, steps, num_steps, now_ms);
+}
+
+void animation_continue(struct animation *anim, int16_t *variable, const struct animation_step *steps, uint8_t num_steps, uint32_t now_ms)
+{
+    if(!anim->running) {
+        animation_num_active++;
+    }
+
+    anim->variable = variable;
+    anim->steps = steps;
+    anim->num_steps = num_steps;
+    anim->step = 0;
+    anim->running = 1;
+
+    animation_update(anim, now_ms);
+}
+
+int animation_update(struct animation *anim, uint32_t now_ms)
+{
+    if(!anim->running) {
+        return ANIMATION_DONE;
+    }
+
+    while(now_ms - anim->start_ms >= anim->steps[anim->step].duration_ms) {
+        if(anim->step + 1 == anim->num_steps) {
+            *anim->variable = anim->steps[anim->step].to;
+            anim->start_ms += anim->steps[anim->step].duration_ms;
+            anim->running = 0;
+            animation_num_active--;
+
+            return ANIMATION_DONE;
+        }
+
+        anim->start_ms += anim->steps[anim->step].duration_ms;
+        anim->step++;
+    }
+
+    *anim->variable = animation_step_value(&anim->steps[anim->step], now_ms - anim->start_ms);
+
+    return anim->step;
+}
+
+uint8_t animation_active(void)
+{
+    return animation_num_active;
+}
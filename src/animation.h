@@ -0,0 +1,55 @@
+#ifndef ANIMATION_H_
+#define ANIMATION_H_
+
+#include <stdint.h>
+
+// Time based tweening of a coordinate on the display. An animation runs
+// through a sequence of steps, each moving the variable between two values
+// over a fixed time along an easing curve. The value only depends on the time
+// since the animation was started, so the speed does not depend on the frame
+// rate, and the steps follow each other without drift.
+
+enum animation_easing {
+    ANIMATION_LINEAR,
+    ANIMATION_EASE_IN,
+    ANIMATION_EASE_OUT,
+    ANIMATION_EASE_IN_OUT,
+};
+
+// Returned by animation_update once the last step has finished
+#define ANIMATION_DONE -1
+
+struct animation_step
+{
+    int16_t from;
+    int16_t to;
+    uint16_t duration_ms;
+    uint8_t easing;
+};
+
+struct animation
+{
+    int16_t *variable;
+    const struct animation_step *steps;
+    uint8_t num_steps;
+    uint8_t step;
+    uint8_t running;
+    uint32_t start_ms;
+};
+
+void animation_start(struct animation *anim, int16_t *variable, const struct animation_step *steps, uint8_t num_steps, uint32_t now_ms);
+
+// Start a new sequence, possibly for another variable, at the time the
+// previous sequence of the animation finished
+void animation_continue(struct animation *anim, int16_t *variable, const struct animation_step *steps, uint8_t num_steps, uint32_t now_ms);
+
+// Set the variable to its value at now_ms. Returns the index of the current
+// step, or ANIMATION_DONE.
+int animation_update(struct animation *anim, uint32_t now_ms);
+
+// The number of animations that have been started but not finished
+uint8_t animation_active(void);
+
+int16_t animation_step_value(const struct animation_step *step, uint32_t elapsed_ms);
+
+#endif
@@ -16,6 +16,7 @@
 #include "timezone-db.h"
 
 #include "matrix_display.h"
+#include "display.h"
 
 #include "log.h"
 #define LOG_SYS LOG_SYS_CONFIG
@@ -271,6 +272,7 @@ int config_load_led_matrix(json_stream *json)
             matrix_intensity_override_level = override_level;
 
             matrix_intensity_updated = 1;
+            display_wake();
 
             return 1;
         }
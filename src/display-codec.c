@@ -0,0 +1,205 @@
+#include <string.h>
+
+#include "display-codec.h"
+
+// A run of unchanged bytes inside a literal run is only worth splitting on
+// if it is at least as long as the header of a new run
+#define MIN_SKIP 3
+
+uint16_t display_codec_frame_len(const struct display_codec_format *format)
+{
+    return format->width * format->height / 8;
+}
+
+int display_codec_get_pixel(const struct display_codec_format *format, const uint8_t *frame, uint16_t x, uint16_t y)
+{
+    if(format->layout == DISPLAY_CODEC_LAYOUT_PAGES) {
+        return frame[x + (y / 8) * format->width] & (1 << (y % 8));
+    } else {
+        return frame[x / 8 + (format->width / 8) * y] & (0x80 >> (x % 8));
+    }
+}
+
+static int write_header(const struct display_codec_format *format, uint8_t type, uint8_t *out)
+{
+    out[0] = type;
+    out[1] = format->layout;
+    out[2] = format->width;
+    out[3] = format->height;
+
+    return DISPLAY_CODEC_HEADER_LEN;
+}
+
+int display_codec_encode_keyframe(const struct display_codec_format *format, const uint8_t *frame, uint8_t *out, int out_len)
+{
+    const int len = display_codec_frame_len(format);
+
+    if(out_len < DISPLAY_CODEC_HEADER_LEN + len) {
+        return -1;
+    }
+
+    int n = write_header(format, DISPLAY_CODEC_KEYFRAME, out);
+    memcpy(out + n, frame, len);
+
+    return n + len;
+}
+
+static int count_unchanged(const uint8_t *prev, const uint8_t *frame, int len, int max)
+{
+    int n = 0;
+
+    while((n < len) && (n < max) && (prev[n] == frame[n])) {
+        n++;
+    }
+
+    return n;
+}
+
+static int encode_page(const uint8_t *prev, const uint8_t *frame, int len, uint8_t *out, int out_len)
+{
+    int n = 0;
+    int i = 0;
+
+    while(i < len) {
+        int skip = count_unchanged(prev + i, frame + i, len - i, 255);
+        i += skip;
+
+        int lit = 0;
+
+        while((i + lit < len) && (lit < 255)) {
+            if(prev[i + lit] != frame[i + lit]) {
+                lit++;
+            } else {
+                int same = count_unchanged(prev + i + lit, frame + i + lit, len - i - lit, MIN_SKIP);
+
+                if((same >= MIN_SKIP) || (lit + same > 255)) {
+                    break;
+                }
+
+                lit += same;
+            }
+        }
+
+        if(n + 2 + lit > out_len) {
+            return -1;
+        }
+
+        out[n++] = skip;
+        out[n++] = lit;
+
+        for(int j = 0; j < lit; j++) {
+            out[n++] = prev[i + j] ^ frame[i + j];
+        }
+
+        i += lit;
+    }
+
+    return n;
+}
+
+// Returns the length of the encoded delta, 0 if the frames are equal or -1 if
+// the delta does not fit in out_len bytes
+int display_codec_encode_delta(const struct display_codec_format *format, const uint8_t *prev, const uint8_t *frame, uint8_t *out, int out_len)
+{
+    const int page_len = display_codec_frame_len(format) / DISPLAY_CODEC_NUM_PAGES;
+
+    if(out_len < DISPLAY_CODEC_HEADER_LEN + 1) {
+        return -1;
+    }
+
+    int n = write_header(format, DISPLAY_CODEC_DELTA, out);
+    uint8_t *mask = &out[n++];
+
+    *mask = 0;
+
+    for(int page = 0; page < DISPLAY_CODEC_NUM_PAGES; page++) {
+        const int offset = page * page_len;
+
+        if(memcmp(prev + offset, frame + offset, page_len) == 0) {
+            continue;
+        }
+
+        *mask |= 1 << page;
+
+        int ret = encode_page(prev + offset, frame + offset, page_len, out + n, out_len - n);
+
+        if(ret < 0) {
+            return -1;
+        }
+
+        n += ret;
+    }
+
+    if(!*mask) {
+        return 0;
+    }
+
+    return n;
+}
+
+// Apply an encoded frame to the framebuffer. Returns 0 on success and -1 if
+// the message is malformed or does not match the size of the framebuffer.
+int display_codec_decode(const uint8_t *in, int in_len, uint8_t *frame, int frame_len)
+{
+    if(in_len < DISPLAY_CODEC_HEADER_LEN) {
+        return -1;
+    }
+
+    const struct display_codec_format format = {
+        .layout = in[1],
+        .width = in[2],
+        .height = in[3],
+    };
+
+    if(display_codec_frame_len(&format) != frame_len) {
+        return -1;
+    }
+
+    int n = DISPLAY_CODEC_HEADER_LEN;
+
+    if(in[0] == DISPLAY_CODEC_KEYFRAME) {
+        if(in_len != n + frame_len) {
+            return -1;
+        }
+
+        memcpy(frame, in + n, frame_len);
+        return 0;
+    }
+
+    if((in[0] != DISPLAY_CODEC_DELTA) || (in_len < n + 1)) {
+        return -1;
+    }
+
+    const int page_len = frame_len / DISPLAY_CODEC_NUM_PAGES;
+    const uint8_t mask = in[n++];
+
+    for(int page = 0; page < DISPLAY_CODEC_NUM_PAGES; page++) {
+        if(!(mask & (1 << page))) {
+            continue;
+        }
+
+        int i = page * page_len;
+        const int end = i + page_len;
+
+        while(i < end) {
+            if(n + 2 > in_len) {
+                return -1;
+            }
+
+            const int skip = in[n++];
+            const int lit = in[n++];
+
+            if((skip + lit == 0) || (i + skip + lit > end) || (n + lit > in_len)) {
+                return -1;
+            }
+
+            i += skip;
+
+            for(int j = 0; j < lit; j++) {
+                frame[i++] ^= in[n++];
+            }
+        }
+    }
+
+    return (n == in_len) ? 0 : -1;
+}
@@ -0,0 +1,55 @@
+#ifndef DISPLAY_CODEC_H_
+#define DISPLAY_CODEC_H_
+
+#include <stdint.h>
+
+// Frame protocol used to mirror the framebuffer over websockets.
+//
+// Every message starts with a four byte header: frame type, layout, width
+// and height. The layout tells how the framebuffer bytes map to pixels, see
+// enum display_codec_layout.
+//
+// A keyframe contains the full framebuffer after the header.
+//
+// A delta frame is applied to the previous frame. The framebuffer is split
+// into DISPLAY_CODEC_NUM_PAGES pages of equal length. After the header comes
+// a byte with one bit set for each page which has changed (bit 0 is the
+// first page), followed by the data of the changed pages in order. The data
+// of a page is a sequence of runs, each one being a skip count, a literal
+// count and then that many literal bytes, until the whole page is covered.
+// Skipped bytes are unchanged. Literal bytes are XORed into the previous
+// frame.
+
+#define DISPLAY_CODEC_HEADER_LEN 4
+#define DISPLAY_CODEC_NUM_PAGES 8
+
+enum display_codec_frame_type {
+    DISPLAY_CODEC_KEYFRAME = 1,
+    DISPLAY_CODEC_DELTA = 2,
+};
+
+enum display_codec_layout {
+    // Bytes are vertical strips of eight pixels, LSB at the top, stored page
+    // by page (SH1106)
+    DISPLAY_CODEC_LAYOUT_PAGES = 0,
+    // Bytes are horizontal strips of eight pixels, MSB to the left, stored
+    // row by row (LED matrix)
+    DISPLAY_CODEC_LAYOUT_ROWS = 1,
+};
+
+struct display_codec_format {
+    uint8_t layout;
+    uint8_t width;
+    uint8_t height;
+};
+
+uint16_t display_codec_frame_len(const struct display_codec_format *format);
+
+// Returns non-zero if the pixel at (x, y) of the frame is lit
+int display_codec_get_pixel(const struct display_codec_format *format, const uint8_t *frame, uint16_t x, uint16_t y);
+
+int display_codec_encode_keyframe(const struct display_codec_format *format, const uint8_t *frame, uint8_t *out, int out_len);
+int display_codec_encode_delta(const struct display_codec_format *format, const uint8_t *prev, const uint8_t *frame, uint8_t *out, int out_len);
+int display_codec_decode(const uint8_t *in, int in_len, uint8_t *frame, int frame_len);
+
+#endif
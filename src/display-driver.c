@@ -0,0 +1,20 @@
+#include <stdint.h>
+
+#include "display-driver.h"
+#include "framebuffer.h"
+
+const struct display_driver *display_driver;
+
+void display_driver_select(const struct display_driver *driver)
+{
+    display_driver = driver;
+    fb_blit = driver->blit;
+    fb_clear = driver->clear;
+    fb_fill_rect = driver->fill_rect;
+    fb_blit_native = driver->blit_native;
+}
+
+uint16_t display_driver_frame_len(const struct display_driver *driver)
+{
+    return display_codec_frame_len(&driver->format);
+}
@@ -0,0 +1,49 @@
+#ifndef DISPLAY_DRIVER_H_
+#define DISPLAY_DRIVER_H_
+
+#include <stdint.h>
+
+#include "display-codec.h"
+
+// A display panel. The drawing functions work on framebuffer in the layout of
+// the panel, and flush sends a finished frame to it. The display task probes
+// each driver in turn and runs the first one that responds, see display.c.
+
+struct display_driver
+{
+    const char *name;
+
+    // Size and layout of the framebuffer
+    struct display_codec_format format;
+
+    // Set up the panel. Returns 0 if it is ready, or non-zero if it does not
+    // respond. May be 0 if there is nothing to set up.
+    int (*init)(void);
+
+    void (*blit)(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
+    void (*clear)(void);
+    void (*fill_rect)(int16_t x, int16_t y, uint16_t w, uint16_t h);
+
+    // Blit an image in the layout of the framebuffer, as format.layout, such
+    // as the glyphs of a glyph cache
+    void (*blit_native)(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
+
+    // Called just before the buffers are swapped, see display-flush.h. May
+    // be 0.
+    void (*prepare)(void);
+
+    // Send a frame to the panel. Called from the flush task. May be 0 if the
+    // frames are not shown anywhere.
+    void (*flush)(const uint8_t *frame);
+};
+
+// The driver selected by display_driver_select, or 0 before that
+extern const struct display_driver *display_driver;
+
+// Make driver the current one, and draw with its drawing functions
+void display_driver_select(const struct display_driver *driver);
+
+// Number of bytes in a frame
+uint16_t display_driver_frame_len(const struct display_driver *driver);
+
+#endif
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+#include <esp_common.h>
+#include <freertos/semphr.h>
+
+#include "display-flush.h"
+#include "display-driver.h"
+#include "framebuffer.h"
+#include "log.h"
+#include "tasks.h"
+
+#define LOG_SYS LOG_SYS_DISPLAY
+
+#define TaskCreate(a,b,c,d,e,f) xTaskCreate(a,(signed char*)(b),c,d,e,f)
+
+static const struct display_driver *display_flush_driver;
+
+static uint8_t *display_flush_front;
+
+// Given by the display task when there is a new front buffer, and by the
+// flush task when it has been sent
+static xSemaphoreHandle display_flush_ready;
+static xSemaphoreHandle display_flush_done;
+
+static void display_flush_send(const uint8_t *frame)
+{
+    if(display_flush_driver->flush) {
+        display_flush_driver->flush(frame);
+    }
+}
+
+static void display_flush_task(void *pvParameters)
+{
+    for(;;) {
+        xSemaphoreTake(display_flush_ready, portMAX_DELAY);
+
+        display_flush_send(display_flush_front);
+
+        xSemaphoreGive(display_flush_done);
+    }
+}
+
+void display_flush_init(const struct display_driver *driver)
+{
+    const uint16_t size = display_driver_frame_len(driver);
+
+    display_flush_driver = driver;
+
+    display_flush_front = malloc(size);
+
+    if(!display_flush_front) {
+        ERROR("Could not allocate the front buffer");
+        return;
+    }
+
+    memcpy(display_flush_front, framebuffer, size);
+
+    vSemaphoreCreateBinary(display_flush_ready);
+    vSemaphoreCreateBinary(display_flush_done);
+
+    // Binary semaphores are created given
+    xSemaphoreTake(display_flush_ready, 0);
+
+    TaskCreate(&display_flush_task, task_names[TASK_FLUSH], DISPLAY_FLUSH_STACK_SIZE, NULL, DISPLAY_FLUSH_PRIORITY, &task_handle[TASK_FLUSH]);
+}
+
+const uint8_t *display_flush_swap(void)
+{
+    // Without a front buffer the frame is sent directly
+    if(!display_flush_front) {
+        if(display_flush_driver->prepare) {
+            display_flush_driver->prepare();
+        }
+        display_flush_send(framebuffer);
+        return framebuffer;
+    }
+
+    xSemaphoreTake(display_flush_done, portMAX_DELAY);
+
+    if(display_flush_driver->prepare) {
+        display_flush_driver->prepare();
+    }
+
+    uint8_t *front = framebuffer;
+
+    framebuffer = display_flush_front;
+    display_flush_front = front;
+
+    xSemaphoreGive(display_flush_ready);
+
+    return front;
+}
+
+uint16_t display_flush_copy_frame(uint8_t *buf, uint16_t len)
+{
+    const struct display_driver *driver = display_flush_driver;
+
+    if(!driver) {
+        return 0;
+    }
+
+    const uint16_t size = display_driver_frame_len(driver);
+
+    if(len < size) {
+        return 0;
+    }
+
+    // The display task draws into the front buffer as soon as it has been
+    // swapped out, so the swap must not happen while it is copied
+    portENTER_CRITICAL();
+    memcpy(buf, display_flush_front ? display_flush_front : framebuffer, size);
+    portEXIT_CRITICAL();
+
+    return size;
+}
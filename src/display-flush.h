@@ -0,0 +1,32 @@
+#ifndef DISPLAY_FLUSH_H_
+#define DISPLAY_FLUSH_H_
+
+#include <stdint.h>
+
+// Double buffering of the framebuffer. The display task draws into the back
+// buffer, which is always framebuffer, and hands it to display_flush_swap. The
+// front buffer is then sent by a flush task of lower priority while the
+// display task goes on with the next frame.
+
+#define DISPLAY_FLUSH_PRIORITY 2
+#define DISPLAY_FLUSH_STACK_SIZE 384
+
+struct display_driver;
+
+// Start the flush task, which sends the frames with driver->flush.
+// driver->prepare is called from the display task just before the buffers
+// are swapped, while the front buffer is not being sent. The contents of
+// framebuffer are copied to the second buffer.
+void display_flush_init(const struct display_driver *driver);
+
+// Wait until the previous frame has been sent, then make framebuffer the
+// front buffer and let the flush task send it. Returns the front buffer.
+const uint8_t *display_flush_swap(void);
+
+// Copy the last frame handed to the flush task to buf. The copy is done in a
+// short critical section, so the display task is not blocked by the reader.
+// Returns the length of the frame, or 0 if there is no frame or buf is too
+// short.
+uint16_t display_flush_copy_frame(uint8_t *buf, uint16_t len);
+
+#endif
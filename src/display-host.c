@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "display-host.h"
+#include "screenshot.h"
+#include "oled_framebuffer.h"
+#include "matrix_framebuffer.h"
+
+static void null_flush(const uint8_t *frame)
+{
+}
+
+const struct display_driver display_null_oled = {
+    .name = "Null OLED",
+    .format = { .layout = DISPLAY_CODEC_LAYOUT_PAGES, .width = OLED_WIDTH, .height = OLED_HEIGHT },
+    .blit = oled_blit,
+    .clear = oled_clear,
+    .fill_rect = oled_fill_rect,
+    .blit_native = oled_blit,
+    .prepare = oled_clear_dirty,
+    .flush = null_flush,
+};
+
+const struct display_driver display_null_matrix = {
+    .name = "Null LED Matrix",
+    .format = { .layout = DISPLAY_CODEC_LAYOUT_ROWS, .width = MATRIX_WIDTH, .height = MATRIX_HEIGHT },
+    .blit = matrix_blit,
+    .clear = matrix_clear,
+    .fill_rect = matrix_fill_rect,
+    .blit_native = matrix_blit_rows,
+    .flush = null_flush,
+};
+
+int display_pbm_write(FILE *f, const struct display_codec_format *format, const uint8_t *frame)
+{
+    struct screenshot screenshot;
+    uint8_t buf[SCREENSHOT_MIN_LEN];
+    uint16_t n;
+
+    screenshot_init(&screenshot, SCREENSHOT_PBM, format, frame);
+
+    while((n = screenshot_read(&screenshot, buf, sizeof(buf))) > 0) {
+        fwrite(buf, 1, n, f);
+    }
+
+    return ferror(f) ? -1 : 0;
+}
+
+static struct display_driver display_pbm_panel_driver;
+static const struct display_driver *display_pbm_panel;
+static const char *display_pbm_filename;
+
+static void pbm_flush(const uint8_t *frame)
+{
+    if(display_pbm_panel->flush) {
+        display_pbm_panel->flush(frame);
+    }
+
+    FILE *f = fopen(display_pbm_filename, "wb");
+
+    if(f) {
+        display_pbm_write(f, &display_pbm_panel->format, frame);
+        fclose(f);
+    }
+}
+
+const struct display_driver *display_pbm_driver(const struct display_driver *panel, const char *filename)
+{
+    display_pbm_panel = panel;
+    display_pbm_filename = filename;
+
+    display_pbm_panel_driver = *panel;
+    display_pbm_panel_driver.flush = pbm_flush;
+
+    return &display_pbm_panel_driver;
+}
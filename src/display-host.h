@@ -0,0 +1,23 @@
+#ifndef DISPLAY_HOST_H_
+#define DISPLAY_HOST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "display-driver.h"
+
+// Display drivers for running the display code on a host, e.g. in the
+// benchmarks. They are not part of the firmware.
+
+// Draw in the layout of the OLED or the LED matrix, and drop the frames
+extern const struct display_driver display_null_oled;
+extern const struct display_driver display_null_matrix;
+
+// A driver that draws like panel, and writes each frame to filename as a PBM
+// image, replacing the previous one
+const struct display_driver *display_pbm_driver(const struct display_driver *panel, const char *filename);
+
+// Write a frame as a binary PBM image. Returns 0 on success.
+int display_pbm_write(FILE *f, const struct display_codec_format *format, const uint8_t *frame);
+
+#endif
@@ -6,6 +6,8 @@ enum display_message {
     DISPLAY_MESSAGE_NO_JOURNIES,
     DISPLAY_MESSAGE_WIFI_INFO,
 
+    // Only wakes the display task, see display_wake
+    DISPLAY_MESSAGE_WAKE = 0xFE,
     DISPLAY_MESSAGE_NONE = 0xFF,
 };
 
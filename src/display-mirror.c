@@ -0,0 +1,282 @@
+#include <stdlib.h>
+#include <string.h>
+#include <esp_common.h>
+#include <freertos/semphr.h>
+
+#include "display-mirror.h"
+#include "display-codec.h"
+#include "display-driver.h"
+#include "display-stats.h"
+#include "i2c-master.h"
+#include "log.h"
+#include "http-sm/http.h"
+#include "http-sm/websocket.h"
+
+#define LOG_SYS LOG_SYS_DISPLAY
+
+struct display_mirror_client {
+    struct websocket_connection *conn;
+    portTickType last_tick;
+    uint16_t budget;
+    uint8_t synced;
+    uint8_t slow_sends;
+};
+
+static struct display_mirror_client display_mirror_clients[DISPLAY_MIRROR_MAX_CLIENTS];
+static xSemaphoreHandle display_mirror_mutex = NULL;
+
+// The last frame sent, which delta frames are relative to, and a buffer for
+// the encoded message. Only allocated while there are clients.
+static struct display_codec_format display_mirror_format;
+static uint8_t *display_mirror_prev = NULL;
+static uint8_t *display_mirror_buf = NULL;
+
+// The driver returned by display_mirror_driver, and the panel it wraps
+static struct display_driver display_mirror_panel_driver;
+static const struct display_driver *display_mirror_panel;
+
+static void refill_budget(struct display_mirror_client *client, portTickType now)
+{
+    uint32_t elapsed_ms = (now - client->last_tick) * portTICK_RATE_MS;
+
+    if(elapsed_ms > 1000) {
+        elapsed_ms = 1000;
+    }
+
+    uint32_t budget = client->budget + elapsed_ms * DISPLAY_MIRROR_BYTES_PER_SECOND / 1000;
+
+    if(budget > DISPLAY_MIRROR_BURST) {
+        budget = DISPLAY_MIRROR_BURST;
+    }
+
+    client->budget = budget;
+    client->last_tick = now;
+}
+
+static void free_buffers(void)
+{
+    free(display_mirror_prev);
+    free(display_mirror_buf);
+    display_mirror_prev = NULL;
+    display_mirror_buf = NULL;
+}
+
+static int alloc_buffers(const struct display_codec_format *format)
+{
+    if(display_mirror_prev && (memcmp(format, &display_mirror_format, sizeof(*format)) == 0)) {
+        return 1;
+    }
+
+    free_buffers();
+
+    const uint16_t len = display_codec_frame_len(format);
+
+    display_mirror_prev = malloc(len);
+    display_mirror_buf = malloc(DISPLAY_CODEC_HEADER_LEN + len);
+
+    if(!display_mirror_prev || !display_mirror_buf) {
+        ERROR("Could not allocate mirror buffers");
+        free_buffers();
+        return 0;
+    }
+
+    display_mirror_format = *format;
+
+    for(int i = 0; i < DISPLAY_MIRROR_MAX_CLIENTS; i++) {
+        display_mirror_clients[i].synced = 0;
+    }
+
+    return 1;
+}
+
+void display_mirror_init(void)
+{
+    if(display_mirror_mutex == NULL) {
+        display_mirror_mutex = xSemaphoreCreateMutex();
+    }
+}
+
+int display_mirror_add(struct websocket_connection *conn)
+{
+    int ret = 0;
+
+    if((display_mirror_mutex != NULL) && (xSemaphoreTake(display_mirror_mutex, portMAX_DELAY) == pdTRUE)) {
+        for(int i = 0; i < DISPLAY_MIRROR_MAX_CLIENTS; i++) {
+            struct display_mirror_client *client = &display_mirror_clients[i];
+
+            if(!client->conn) {
+                client->conn = conn;
+                client->last_tick = xTaskGetTickCount();
+                client->budget = DISPLAY_MIRROR_BURST;
+                client->synced = 0;
+                client->slow_sends = 0;
+                ret = 1;
+                break;
+            }
+        }
+
+        xSemaphoreGive(display_mirror_mutex);
+    }
+
+    return ret;
+}
+
+void display_mirror_remove(struct websocket_connection *conn)
+{
+    if((display_mirror_mutex != NULL) && (xSemaphoreTake(display_mirror_mutex, portMAX_DELAY) == pdTRUE)) {
+        int num_clients = 0;
+
+        for(int i = 0; i < DISPLAY_MIRROR_MAX_CLIENTS; i++) {
+            if(display_mirror_clients[i].conn == conn) {
+                display_mirror_clients[i].conn = NULL;
+            }
+
+            if(display_mirror_clients[i].conn) {
+                num_clients++;
+            }
+        }
+
+        if(!num_clients) {
+            free_buffers();
+        }
+
+        xSemaphoreGive(display_mirror_mutex);
+    }
+}
+
+// Close the websocket of a client which cannot keep up, so that the browser
+// notices and can reconnect, and stop sending to it. The server removes the
+// connection when the close handshake finishes or the socket fails.
+static void drop_client(int i)
+{
+    struct display_mirror_client *client = &display_mirror_clients[i];
+
+    // Status code 1001, going away
+    const uint8_t msg[] = { 0x03, 0xE9 };
+
+    websocket_send(client->conn, msg, sizeof(msg), WEBSOCKET_FRAME_OPCODE_CLOSE | WEBSOCKET_FRAME_FIN);
+    client->conn = NULL;
+}
+
+// Send an encoded message to a client if its budget allows it. Returns 1 if
+// the message was sent.
+static int send_to_client(int i, const uint8_t *msg, int len)
+{
+    struct display_mirror_client *client = &display_mirror_clients[i];
+
+    portTickType start = xTaskGetTickCount();
+
+    refill_budget(client, start);
+
+    if(client->budget < len) {
+        return 0;
+    }
+
+    int ret = websocket_send(client->conn, msg, len, WEBSOCKET_FRAME_OPCODE_BIN | WEBSOCKET_FRAME_FIN);
+
+    if(ret < 0) {
+        WARNING("Mirror client %d: send failed, dropping it", i);
+        drop_client(i);
+        return 0;
+    }
+
+    client->budget -= len;
+
+    if((xTaskGetTickCount() - start) * portTICK_RATE_MS > DISPLAY_MIRROR_SLOW_SEND_MS) {
+        if(++client->slow_sends >= DISPLAY_MIRROR_MAX_SLOW_SENDS) {
+            WARNING("Mirror client %d is too slow, dropping it", i);
+            drop_client(i);
+            return 0;
+        }
+    } else {
+        client->slow_sends = 0;
+    }
+
+    return 1;
+}
+
+// Send the frame to the clients. Clients which have the previous frame get a
+// delta frame, others get a keyframe. A client which has to skip a frame
+// because of its budget loses sync and gets a keyframe later.
+void display_mirror_send(const struct display_codec_format *format, const uint8_t *frame)
+{
+    if((display_mirror_mutex == NULL) || (xSemaphoreTake(display_mirror_mutex, 0) != pdTRUE)) {
+        return;
+    }
+
+    int num_clients = 0;
+
+    for(int i = 0; i < DISPLAY_MIRROR_MAX_CLIENTS; i++) {
+        if(display_mirror_clients[i].conn) {
+            num_clients++;
+        }
+    }
+
+    if(!num_clients || !alloc_buffers(format)) {
+        xSemaphoreGive(display_mirror_mutex);
+        return;
+    }
+
+    const uint16_t frame_len = display_codec_frame_len(format);
+    const int buf_len = DISPLAY_CODEC_HEADER_LEN + frame_len;
+
+    int delta_len = -2;
+
+    for(int i = 0; i < DISPLAY_MIRROR_MAX_CLIENTS; i++) {
+        struct display_mirror_client *client = &display_mirror_clients[i];
+
+        if(client->conn && client->synced) {
+            if(delta_len == -2) {
+                // A delta as large as a keyframe is not worth sending
+                delta_len = display_codec_encode_delta(format, display_mirror_prev, frame, display_mirror_buf, buf_len - 1);
+            }
+
+            if(delta_len != 0) {
+                client->synced = (delta_len > 0) && send_to_client(i, display_mirror_buf, delta_len);
+            }
+        }
+    }
+
+    int key_len = 0;
+
+    for(int i = 0; i < DISPLAY_MIRROR_MAX_CLIENTS; i++) {
+        struct display_mirror_client *client = &display_mirror_clients[i];
+
+        if(client->conn && !client->synced) {
+            if(!key_len) {
+                key_len = display_codec_encode_keyframe(format, frame, display_mirror_buf, buf_len);
+            }
+
+            client->synced = send_to_client(i, display_mirror_buf, key_len);
+        }
+    }
+
+    memcpy(display_mirror_prev, frame, frame_len);
+
+    xSemaphoreGive(display_mirror_mutex);
+}
+
+// Only the panel's flush counts as the transfer, not the sends to the clients
+static void display_mirror_flush(const uint8_t *frame)
+{
+    if(display_mirror_panel->flush) {
+        const uint32_t bytes = i2c_byte_count;
+        const uint32_t start = display_stats_ccount();
+
+        display_mirror_panel->flush(frame);
+
+        display_stats_add_transfer(display_stats_ccount() - start, i2c_byte_count - bytes);
+    }
+
+    display_mirror_send(&display_mirror_panel->format, frame);
+}
+
+const struct display_driver *display_mirror_driver(const struct display_driver *panel)
+{
+    display_mirror_panel = panel;
+
+    display_mirror_panel_driver = *panel;
+    display_mirror_panel_driver.flush = display_mirror_flush;
+
+    return &display_mirror_panel_driver;
+}
@@ -0,0 +1,37 @@
+#ifndef DISPLAY_MIRROR_H_
+#define DISPLAY_MIRROR_H_
+
+#include <stdint.h>
+
+#define DISPLAY_MIRROR_MAX_CLIENTS 4
+
+// Frames are sent using the protocol in display-codec.h. Each client may
+// receive at most this many bytes per second on average, with bursts of up
+// to DISPLAY_MIRROR_BURST bytes. Frames which do not fit in the budget are
+// skipped for that client, which will get a later frame instead.
+#define DISPLAY_MIRROR_BYTES_PER_SECOND 8192
+#define DISPLAY_MIRROR_BURST 2048
+
+// A client is dropped after this many consecutive sends taking longer than
+// DISPLAY_MIRROR_SLOW_SEND_MS
+#define DISPLAY_MIRROR_SLOW_SEND_MS 100
+#define DISPLAY_MIRROR_MAX_SLOW_SENDS 3
+
+struct websocket_connection;
+struct display_codec_format;
+struct display_driver;
+
+void display_mirror_init(void);
+
+int display_mirror_add(struct websocket_connection *conn);
+void display_mirror_remove(struct websocket_connection *conn);
+
+void display_mirror_send(const struct display_codec_format *format, const uint8_t *frame);
+
+// A driver that draws like panel, and sends each frame to the clients after
+// it has been flushed to the panel. Called from the flush task, so a slow
+// client does not hold up drawing of the next frame. panel->flush may be 0
+// when there is no panel and the display is only mirrored.
+const struct display_driver *display_mirror_driver(const struct display_driver *panel);
+
+#endif
@@ -0,0 +1,33 @@
+#include <stdint.h>
+#include <sys/time.h>
+
+#include "display-schedule.h"
+
+void display_schedule_init(struct display_schedule *schedule)
+{
+    schedule->delay_ms = DISPLAY_SCHEDULE_MAX_DELAY_MS;
+}
+
+void display_schedule_in(struct display_schedule *schedule, uint32_t ms)
+{
+    if(ms < schedule->delay_ms) {
+        schedule->delay_ms = ms;
+    }
+}
+
+void display_schedule_every(struct display_schedule *schedule, uint32_t now_ms, uint32_t period_ms)
+{
+    display_schedule_in(schedule, period_ms - now_ms % period_ms);
+}
+
+void display_schedule_clock(struct display_schedule *schedule, const struct timeval *now, uint32_t period_s)
+{
+    const uint32_t ms = (now->tv_sec % period_s) * 1000 + now->tv_usec / 1000;
+
+    display_schedule_in(schedule, period_s * 1000 - ms);
+}
+
+uint32_t display_schedule_delay_ms(const struct display_schedule *schedule)
+{
+    return schedule->delay_ms;
+}
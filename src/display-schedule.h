@@ -0,0 +1,38 @@
+#ifndef DISPLAY_SCHEDULE_H_
+#define DISPLAY_SCHEDULE_H_
+
+#include <stdint.h>
+#include <sys/time.h>
+
+// The display tasks only redraw when the visible content can change. While
+// drawing a frame they collect the earliest such instant, and then sleep
+// until it or until display_wake is called.
+
+// Changes without an explicit wake up, such as the WiFi and time status, are
+// picked up within this time
+#define DISPLAY_SCHEDULE_MAX_DELAY_MS 1000
+
+// Frame interval while an animation is running
+#define DISPLAY_SCHEDULE_ANIMATION_MS 25
+
+struct display_schedule
+{
+    uint32_t delay_ms;
+};
+
+void display_schedule_init(struct display_schedule *schedule);
+
+// Redraw after ms milliseconds
+void display_schedule_in(struct display_schedule *schedule, uint32_t ms);
+
+// Redraw when the millisecond counter now_ms next reaches a multiple of
+// period_ms
+void display_schedule_every(struct display_schedule *schedule, uint32_t now_ms, uint32_t period_ms);
+
+// Redraw when the wall clock next reaches a multiple of period_s seconds,
+// i.e. the next second or the next minute
+void display_schedule_clock(struct display_schedule *schedule, const struct timeval *now, uint32_t period_s);
+
+uint32_t display_schedule_delay_ms(const struct display_schedule *schedule);
+
+#endif
@@ -0,0 +1,120 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "display-stats.h"
+#include "json-writer.h"
+
+struct display_stats display_stats;
+
+// Guard against dividing by zero before display_stats_init
+static uint32_t display_stats_mhz(void)
+{
+    return display_stats.cpu_mhz ? display_stats.cpu_mhz : 1;
+}
+
+void display_stats_init(uint8_t cpu_mhz)
+{
+    memset(&display_stats, 0, sizeof(display_stats));
+    display_stats.cpu_mhz = cpu_mhz;
+}
+
+static void display_stats_add(struct display_stats_timing *timing, uint32_t cycles)
+{
+    if(!timing->count || (cycles < timing->min_cycles)) {
+        timing->min_cycles = cycles;
+    }
+
+    if(cycles > timing->max_cycles) {
+        timing->max_cycles = cycles;
+    }
+
+    if(timing->total_cycles + cycles < timing->total_cycles) {
+        timing->total_cycles = 0;
+        timing->total_count = 0;
+    }
+
+    timing->total_cycles += cycles;
+    timing->total_count++;
+    timing->count++;
+
+#if DISPLAY_STATS_HISTOGRAM
+    // The number of bits of the time in milliseconds gives the bin
+    uint32_t ms = cycles / (1000 * display_stats_mhz());
+    uint8_t bin = 0;
+
+    while(ms && (bin < DISPLAY_STATS_HISTOGRAM_BINS - 1)) {
+        ms >>= 1;
+        bin++;
+    }
+
+    timing->histogram[bin]++;
+#endif
+}
+
+void display_stats_add_render(uint32_t cycles)
+{
+    display_stats_add(&display_stats.render, cycles);
+}
+
+void display_stats_add_transfer(uint32_t cycles, uint32_t bytes)
+{
+    display_stats_add(&display_stats.transfer, cycles);
+    display_stats.bytes += bytes;
+}
+
+void display_stats_add_retry(void)
+{
+    display_stats.retries++;
+}
+
+void display_stats_add_skipped(uint32_t frames)
+{
+    display_stats.skipped += frames;
+}
+
+static void display_stats_write_timing(struct json_writer *json, const char *name, const struct display_stats_timing *timing)
+{
+    const uint32_t mhz = display_stats_mhz();
+    const uint32_t count = timing->count;
+    const uint32_t total_count = timing->total_count;
+
+    json_writer_begin_object(json, name);
+    json_writer_write_int(json, "count", count);
+
+    if(count && total_count) {
+        json_writer_write_int(json, "min-us", timing->min_cycles / mhz);
+        json_writer_write_int(json, "avg-us", timing->total_cycles / total_count / mhz);
+        json_writer_write_int(json, "max-us", timing->max_cycles / mhz);
+    }
+
+#if DISPLAY_STATS_HISTOGRAM
+    json_writer_begin_array(json, "histogram-ms");
+    for(int i = 0; i < DISPLAY_STATS_HISTOGRAM_BINS; i++) {
+        json_writer_write_int(json, NULL, timing->histogram[i]);
+    }
+    json_writer_end_array(json);
+#endif
+
+    json_writer_end_object(json);
+}
+
+void display_stats_write(struct json_writer *json)
+{
+    const uint32_t frames = display_stats.transfer.count;
+
+    json_writer_begin_object(json, "display");
+
+    display_stats_write_timing(json, "render", &display_stats.render);
+    display_stats_write_timing(json, "transfer", &display_stats.transfer);
+
+    json_writer_write_int(json, "bytes", display_stats.bytes);
+
+    if(frames) {
+        json_writer_write_int(json, "bytes-per-frame", display_stats.bytes / frames);
+    }
+
+    json_writer_write_int(json, "retries", display_stats.retries);
+    json_writer_write_int(json, "skipped", display_stats.skipped);
+
+    json_writer_end_object(json);
+}
@@ -0,0 +1,86 @@
+#ifndef DISPLAY_STATS_H_
+#define DISPLAY_STATS_H_
+
+#include <stdint.h>
+
+// Counters of the display pipeline, shown in the display section of
+// /api/status.json. Times are measured with the CCOUNT cycle counter and
+// only converted to microseconds when the section is written, so that
+// recording a frame is a handful of additions.
+//
+// The render time is recorded by the display task around render->frame, and
+// the transfer time by the flush task around the panel's flush, without the
+// sends to the mirror clients. Both are wall times: they include the time
+// the task was preempted, e.g. by the display task rendering the next frame
+// while the flush task sends the previous one.
+//
+// Each field is a single word, so a reader may see a frame half recorded,
+// but never a torn value.
+
+// Also keep a histogram of the times, with bins of powers of two
+// milliseconds: [0, 1), [1, 2), [2, 4), ... and the last bin open ended
+#ifndef DISPLAY_STATS_HISTOGRAM
+#define DISPLAY_STATS_HISTOGRAM 1
+#endif
+
+#define DISPLAY_STATS_HISTOGRAM_BINS 8
+
+struct display_stats_timing
+{
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+
+    // The average is total_cycles / total_count. Both start over when the
+    // total would wrap, which takes at least 2^32 cycles of frames, e.g. 53 s
+    // at 80 MHz.
+    uint32_t total_cycles;
+    uint32_t total_count;
+#if DISPLAY_STATS_HISTOGRAM
+    uint32_t histogram[DISPLAY_STATS_HISTOGRAM_BINS];
+#endif
+};
+
+struct display_stats
+{
+    // Clock frequency used to convert cycles to microseconds
+    uint8_t cpu_mhz;
+
+    struct display_stats_timing render;
+    struct display_stats_timing transfer;
+
+    // Bytes on the I2C bus while sending frames, including addresses
+    uint32_t bytes;
+
+    // Times the panel did not acknowledge its address and the transfer was
+    // started again
+    uint32_t retries;
+
+    // Animation frames dropped because the previous frame was late
+    uint32_t skipped;
+};
+
+extern struct display_stats display_stats;
+
+void display_stats_init(uint8_t cpu_mhz);
+
+void display_stats_add_render(uint32_t cycles);
+void display_stats_add_transfer(uint32_t cycles, uint32_t bytes);
+void display_stats_add_retry(void);
+void display_stats_add_skipped(uint32_t frames);
+
+struct json_writer;
+
+// Write the display section of the status document
+void display_stats_write(struct json_writer *json);
+
+#ifdef __xtensa__
+static inline uint32_t display_stats_ccount(void)
+{
+    uint32_t ccount;
+    __asm__ __volatile__("rsr %0, ccount" : "=r"(ccount));
+    return ccount;
+}
+#endif
+
+#endif
@@ -1,9 +1,17 @@
+#include <time.h>
 #include <esp_common.h>
 
 #include "i2c-master.h"
 #include "display.h"
+#include "display-driver.h"
+#include "display-flush.h"
+#include "display-mirror.h"
+#include "display-schedule.h"
+#include "display-stats.h"
+#include "animation.h"
 #include "matrix_framebuffer.h"
-#include "sh1106-cmd.h"
+#include "oled_render.h"
+#include "matrix_render.h"
 #include "log.h"
 
 #define LOG_SYS LOG_SYS_DISPLAY
@@ -11,36 +19,199 @@
 #define vTaskDelayMs(ms)	vTaskDelay((ms)/portTICK_RATE_MS)
 
 xQueueHandle display_message_queue;
-enum DisplayType display_type = DISPLAY_TYPE_NONE;
+
+// A message received by display_wait, kept until display_receive_message
+static uint8_t display_pending_message;
+static uint8_t display_has_pending_message;
+
+void display_wake(void)
+{
+    // Any item in the queue wakes the display task, so only post if it is empty
+    if(display_message_queue && !uxQueueMessagesWaiting(display_message_queue)) {
+        uint8_t msg = DISPLAY_MESSAGE_WAKE;
+        xQueueSend(display_message_queue, &msg, 0);
+    }
+}
+
+void display_wait(uint32_t delay_ms)
+{
+    // Round up, so that we do not wake up just before the content changes
+    const portTickType ticks = (delay_ms + portTICK_RATE_MS - 1) / portTICK_RATE_MS;
+
+    if(display_has_pending_message) {
+        vTaskDelay(ticks);
+        return;
+    }
+
+    uint8_t msg;
+
+    if(xQueueReceive(display_message_queue, &msg, ticks) && (msg != DISPLAY_MESSAGE_WAKE)) {
+        display_pending_message = msg;
+        display_has_pending_message = 1;
+    }
+}
+
+uint32_t display_time_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_RATE_MS;
+}
+
+void display_wait_frame(const struct display_schedule *schedule)
+{
+    static portTickType last_frame;
+    static uint8_t was_animating;
+
+    if(animation_active()) {
+        const portTickType interval = DISPLAY_SCHEDULE_ANIMATION_MS / portTICK_RATE_MS;
+        const portTickType intervals = (xTaskGetTickCount() - last_frame) / interval;
+
+        // Drop the frames we are too late for, rather than drawing them back
+        // to back to catch up
+        if(was_animating && (intervals > 1)) {
+            display_stats_add_skipped(intervals - 1);
+            last_frame += (intervals - 1) * interval;
+        }
+
+        vTaskDelayUntil(&last_frame, interval);
+        was_animating = 1;
+    } else {
+        display_wait(display_schedule_delay_ms(schedule));
+        last_frame = xTaskGetTickCount();
+        was_animating = 0;
+    }
+}
+
+int display_receive_message(enum display_message *message)
+{
+    if(display_has_pending_message) {
+        *message = display_pending_message;
+        display_has_pending_message = 0;
+        return 1;
+    }
+
+    uint8_t msg;
+
+    while(xQueueReceive(display_message_queue, &msg, 0)) {
+        if(msg != DISPLAY_MESSAGE_WAKE) {
+            *message = msg;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// How the frames of a panel are drawn
+struct display_render
+{
+    void (*init)(void);
+    void (*frame)(uint32_t now_ms, const struct timeval *now, struct display_schedule *schedule);
+
+    // Returns 1 when the next message can be set. Messages are dropped if
+    // this is 0.
+    int (*wants_message)(void);
+    void (*set_message)(enum display_message message, const char *text);
+};
+
+static const struct display_render oled_render = {
+    .init = oled_render_init,
+    .frame = oled_render_frame,
+    .wants_message = oled_render_wants_message,
+    .set_message = oled_render_set_message,
+};
+
+static const struct display_render matrix_render = {
+    .init = matrix_render_init,
+    .frame = matrix_render_frame,
+};
+
+// The panels are probed in this order
+static const struct display_panel {
+    const struct display_driver *driver;
+    const struct display_render *render;
+} display_panels[] = {
+    { &sh1106_driver, &oled_render },
+    { &matrix_driver, &matrix_render },
+};
+
+// Used when no panel responds, so that the display can still be seen through
+// the mirror
+static const struct display_driver display_none_driver = {
+    .name = "None",
+    .format = { .layout = DISPLAY_CODEC_LAYOUT_ROWS, .width = MATRIX_WIDTH, .height = MATRIX_HEIGHT },
+    .blit = matrix_blit,
+    .clear = matrix_clear,
+    .fill_rect = matrix_fill_rect,
+    .blit_native = matrix_blit_rows,
+};
+
+static void display_receive_messages(const struct display_render *render)
+{
+    enum display_message message;
+
+    if(!render->wants_message) {
+        while(display_receive_message(&message)) {
+        }
+    } else if(render->wants_message() && display_receive_message(&message)) {
+        const char *text = (message != DISPLAY_MESSAGE_NONE) ? display_get_message(message) : NULL;
+        render->set_message(message, text);
+    }
+}
+
+static void display_main(const struct display_driver *driver, const struct display_render *render)
+{
+    display_driver_select(driver);
+    display_flush_init(driver);
+
+    const uint32_t setup_start = display_time_ms();
+
+    render->init();
+
+    LOG("Render setup took %u ms", display_time_ms() - setup_start);
+
+    for(;;) {
+        struct display_schedule schedule;
+        struct timeval now;
+
+        display_schedule_init(&schedule);
+
+        gettimeofday(&now, NULL);
+
+        display_receive_messages(render);
+
+        const uint32_t start = display_stats_ccount();
+
+        render->frame(display_time_ms(), &now, &schedule);
+
+        display_stats_add_render(display_stats_ccount() - start);
+
+        // The frame is sent by the flush task while the next one is drawn
+        display_flush_swap();
+
+        display_wait_frame(&schedule);
+    }
+}
 
 void display_task(void *pvParameters)
 {
+    display_stats_init(system_get_cpu_freq());
     display_message_queue = xQueueCreate(4, 1);
+    display_mirror_init();
     i2c_master_init();
     for(int i = 0; i < 32; i++) {
-        if(i2c_start(OLED_I2C_ADDRESS, I2C_WRITE) == I2C_ACK) {
-            i2c_stop();
-            display_type = DISPLAY_TYPE_OLED;
-            oled_display_main();
-        }
-        i2c_stop();
-        LOG("SH1106 not found");
+        for(int j = 0; j < sizeof(display_panels) / sizeof(display_panels[0]); j++) {
+            const struct display_panel *panel = &display_panels[j];
 
-        vTaskDelayMs(25);
+            if(panel->driver->init() == 0) {
+                display_main(display_mirror_driver(panel->driver), panel->render);
+            }
+            LOG("%s not found", panel->driver->name);
 
-        if(i2c_start(MATRIX_I2C_ADDRESS, I2C_WRITE) == I2C_ACK) {
-            i2c_stop();
-            display_type = DISPLAY_TYPE_MATRIX;
-            matrix_display_main();
+            vTaskDelayMs(25);
         }
-        i2c_stop();
-        LOG("LED matrix not found");
-
-        vTaskDelayMs(25);
     }
 
     WARNING("No display found. Giving up.");
 
-    display_type = DISPLAY_TYPE_NONE;
-    matrix_display_main();
+    display_main(display_mirror_driver(&display_none_driver), &matrix_render);
 }
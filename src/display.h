@@ -3,19 +3,39 @@
 
 #include <freertos/queue.h>
 
-enum DisplayType {
-    DISPLAY_TYPE_NONE = 0,
-    DISPLAY_TYPE_OLED,
-    DISPLAY_TYPE_MATRIX,
-};
-
-extern enum DisplayType display_type;
+#include "display-message.h"
 
+// Probe the panels, and draw on the first one found. The current driver is
+// in display_driver, see display-driver.h.
 void display_task(void *pvParameters);
 
-void oled_display_main(void);
-void matrix_display_main(void);
+struct display_driver;
+
+// The panels, see oled_display.c and matrix_display.c
+extern const struct display_driver sh1106_driver;
+extern const struct display_driver matrix_driver;
 
 extern xQueueHandle display_message_queue;
 
+// Make the display task redraw now, e.g. after the journies have changed
+void display_wake(void);
+
+// Sleep for delay_ms milliseconds, or until a message is posted or
+// display_wake is called
+void display_wait(uint32_t delay_ms);
+
+// Get the next posted message. Returns 0 if there is none.
+int display_receive_message(enum display_message *message);
+
+// Time in milliseconds used for the animations
+uint32_t display_time_ms(void);
+
+struct display_schedule;
+
+// Wait for the next frame. While an animation is running frames are paced
+// every DISPLAY_SCHEDULE_ANIMATION_MS with vTaskDelayUntil, otherwise the task
+// sleeps as long as the schedule allows. Animation frames that are already
+// late are skipped, and counted in display_stats.
+void display_wait_frame(const struct display_schedule *schedule);
+
 #endif
@@ -0,0 +1,44 @@
+// Generated by utils/font-to-rle from the fonts in src/fonts.c. Do not edit.
+
+#include <stdint.h>
+
+#include "fonts.h"
+
+const uint8_t Monospaced_bold_16_rle[] = {
+  0xCA, // Width: 10, run length encoded, sparse
+  0x13, // Height: 19
+  0x20, // First Char: 32
+  0x0D, // Number of Chars: 13
+
+  // Characters:
+  0x20,0x2D,0x30,0x31,0x32,0x33,0x34,0x35,0x36,0x37,0x38,0x39,0x3A,
+
+  // Jump Table:
+  0xFF, 0xFF, 0x00, 0x0A,  // 32:65535
+  0x00, 0x00, 0x09, 0x0A,  // 45:0
+  0x00, 0x09, 0x0F, 0x0A,  // 48:9
+  0x00, 0x18, 0x0D, 0x0A,  // 49:24
+  0x00, 0x25, 0x14, 0x0A,  // 50:37
+  0x00, 0x39, 0x14, 0x0A,  // 51:57
+  0x00, 0x4D, 0x0C, 0x0A,  // 52:77
+  0x00, 0x59, 0x14, 0x0A,  // 53:89
+  0x00, 0x6D, 0x12, 0x0A,  // 54:109
+  0x00, 0x7F, 0x0D, 0x0A,  // 55:127
+  0x00, 0x8C, 0x13, 0x0A,  // 56:140
+  0x00, 0x9F, 0x12, 0x0A,  // 57:159
+  0x00, 0xB1, 0x07, 0x0A,  // 58:177
+
+  // Font Data:
+  0xFF,0xF3,0x2F,0x22,0xF2,0x2F,0x22,0xF2,0x20,  // 45
+  0xFA,0x6B,0xA8,0x36,0x37,0x23,0x23,0x27,0x23,0x23,0x27,0x36,0x38,0xAA,0x80,  // 48
+  0xFF,0x22,0x82,0x72,0x72,0x82,0x7C,0x7C,0xF2,0x2F,0x22,0xF2,0x20,  // 49
+  0xF8,0x27,0x27,0x27,0x37,0x26,0x47,0x25,0x21,0x27,0x24,0x22,0x27,0x23,0x23,0x28,0x54,0x29,0x35,0x20,  // 50
+  0xF8,0x26,0x28,0x28,0x27,0x23,0x23,0x27,0x23,0x23,0x27,0x23,0x23,0x27,0x23,0x32,0x28,0xAA,0x32,0x40,  // 51
+  0xFD,0x3F,0x04,0xD3,0x12,0xC2,0x32,0xA3,0x42,0xAC,0x7C,0xE2,  // 52
+  0xF7,0x72,0x28,0x64,0x27,0x22,0x24,0x27,0x22,0x24,0x27,0x22,0x24,0x27,0x22,0x32,0x37,0x23,0x6E,0x40,  // 53
+  0xFA,0x7A,0xA8,0x32,0x22,0x37,0x22,0x24,0x27,0x22,0x24,0x27,0x22,0x32,0x38,0x22,0x6E,0x40,  // 54
+  0xF7,0x2F,0x22,0x91,0x72,0x73,0x72,0x54,0x82,0x25,0xA7,0xC5,0xE3,  // 55
+  0xF9,0x32,0x49,0xA8,0x23,0x23,0x27,0x23,0x23,0x27,0x23,0x23,0x27,0x23,0x23,0x28,0xAA,0x32,0x40,  // 56
+  0xF9,0x4E,0x62,0x28,0x32,0x32,0x27,0x24,0x22,0x27,0x24,0x22,0x27,0x32,0x22,0x38,0xAA,0x70,  // 57
+  0xFF,0xFF,0xF8,0x32,0x3B,0x32,0x30,  // 58
+};
@@ -2655,7 +2655,7 @@ const uint8_t font_3x5[] = {
   0x04, // Width: 4
   0x05, // Height: 5
   0x20, // First Char: 32
-  0x3B, // Number of Chars: 59
+  0x3E, // Number of Chars: 62
 
   // Jump Table:
   0x00, 0x00, 0x04, 0x04,  // 32:0
@@ -2717,6 +2717,9 @@ const uint8_t font_3x5[] = {
   0x00, 0xE0, 0x04, 0x04,  // 88:224
   0x00, 0xE4, 0x04, 0x04,  // 89:228
   0x00, 0xE8, 0x04, 0x04,  // 90:232
+  0x00, 0xEC, 0x04, 0x04,  // 91:236
+  0x00, 0xF0, 0x04, 0x04,  // 92:240
+  0x00, 0xF4, 0x04, 0x04,  // 93:244
 
   // Font Data:
   0x00,0x00,0x00,0x00,  // 32
@@ -2778,6 +2781,9 @@ const uint8_t font_3x5[] = {
   0x1B,0x04,0x1B,0x00,  // 88
   0x03,0x1C,0x03,0x00,  // 89
   0x19,0x15,0x13,0x00,  // 90
+  0x1D,0x0A,0x1D,0x00,  // 91
+  0x0D,0x12,0x0D,0x00,  // 92
+  0x1C,0x0B,0x1C,0x00,  // 93
 };
 
 const uint8_t font_5x7[] = {
@@ -17,14 +17,37 @@
 #define FONT_FIRST_CHAR_POS 2
 #define FONT_CHAR_NUM_POS 3
 
+// Fonts with this bit set in the width byte have run length encoded glyphs.
+// The pixels of a glyph are scanned column by column from the top, without
+// padding between the columns, as alternating runs of clear and set pixels
+// starting with a clear run. Each run is stored as 4 bit values, high nibble
+// first, which are added up until one is less than FONT_RLE_EXTEND. The
+// trailing clear run is left out. The jump table is the same as for plain
+// fonts, with the size counting the encoded bytes.
+#define FONT_RLE_FLAG 0x80
+#define FONT_RLE_EXTEND 15
+
+// Fonts with this bit set in the width byte only hold a subset of the
+// characters. The header is followed by the codes of the characters in
+// ascending order, one byte each, and then by the jump table and the glyph
+// data as usual. The first char is the lowest code.
+#define FONT_SPARSE_FLAG 0x40
+#define FONT_WIDTH_MASK 0x3F
+
 extern const uint8_t ArialMT_Plain_10[];
 extern const uint8_t ArialMT_Plain_16[];
 extern const uint8_t ArialMT_Plain_24[];
 extern const uint8_t Monospaced_bold_16[];
 extern const uint8_t Monospaced_plain_28[];
+// Upper case only, with Ä, Ö and Å in place of [, \ and ]
 extern const uint8_t font_3x5[];
 extern const uint8_t font_5x7[];
 extern const uint8_t font_6x12[];
 
+// Run length encoded copies generated by utils/font-to-rle, see the fonts
+// target of the Makefile. Monospaced_bold_16_rle only holds the characters of
+// the glyph cache.
+extern const uint8_t Monospaced_bold_16_rle[];
+
 
 #endif
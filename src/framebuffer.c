@@ -19,6 +19,9 @@ static uint8_t the_framebuffer[FB_SIZE];
 uint8_t *framebuffer = the_framebuffer;
 
 void (*fb_blit)(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
+void (*fb_clear)(void);
+void (*fb_fill_rect)(int16_t x, int16_t y, uint16_t w, uint16_t h);
+void (*fb_blit_native)(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
 
 enum fb_pen fb_current_pen = FB_NORMAL;
 
@@ -51,12 +54,243 @@ void fb_draw_icon(int16_t x, int16_t y, const struct icon *icon, enum fb_alignme
     fb_blit(x, y, icon->width, icon->height, icon->data, 0);
 }
 
-void fb_draw_string(int16_t x, int16_t y, const char *text, uint8_t len, const uint8_t *font_data, enum fb_alignment alignment)
+static const uint8_t corner_sw[] = { 0b00000111, 0b00011000, 0b00100000, 0b01000000, 0b01000000, 0b10000000, 0b10000000, 0b10000000, };
+static const uint8_t corner_nw[] = { 0b11100000, 0b00011000, 0b00000100, 0b00000010, 0b00000010, 0b00000001, 0b00000001, 0b00000001, };
+static const uint8_t corner_se[] = { 0b10000000, 0b10000000, 0b10000000, 0b01000000, 0b01000000, 0b00100000, 0b00011000, 0b00000111, };
+static const uint8_t corner_ne[] = { 0b00000001, 0b00000001, 0b00000001, 0b00000010, 0b00000010, 0b00000100, 0b00011000, 0b11100000, };
+static const uint8_t corner_fill_sw[] = { 0b00000111, 0b00011111, 0b00111111, 0b01111111, 0b01111111, 0b11111111, 0b11111111, 0b11111111, };
+static const uint8_t corner_fill_nw[] = { 0b11100000, 0b11111000, 0b11111100, 0b11111110, 0b11111110, 0b11111111, 0b11111111, 0b11111111, };
+static const uint8_t corner_fill_se[] = { 0b11111111, 0b11111111, 0b11111111, 0b01111111, 0b01111111, 0b00111111, 0b00011111, 0b00000111, };
+static const uint8_t corner_fill_ne[] = { 0b11111111, 0b11111111, 0b11111111, 0b11111110, 0b11111110, 0b11111100, 0b11111000, 0b11100000, };
+
+// Fill the pixels x1 <= x <= x2, y1 <= y <= y2, if there are any
+static void fb_fill_area(int16_t x1, int16_t x2, int16_t y1, int16_t y2)
+{
+    if((x2 >= x1) && (y2 >= y1)) {
+        fb_fill_rect(x1, y1, x2 - x1 + 1, y2 - y1 + 1);
+    }
+}
+
+void fb_draw_rect_round(int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+    fb_blit(x,     y,     8, 8, corner_nw, 0);
+    fb_blit(x+w-8, y,     8, 8, corner_ne, 0);
+    fb_blit(x,     y+h-8, 8, 8, corner_sw, 0);
+    fb_blit(x+w-8, y+h-8, 8, 8, corner_se, 0);
+
+    fb_fill_area(x+8, x+w-8-1, y,     y);
+    fb_fill_area(x+8, x+w-8-1, y+h-1, y+h-1);
+
+    fb_fill_area(x,     x,     y+8, y+h-8-1);
+    fb_fill_area(x+w-1, x+w-1, y+8, y+h-8-1);
+}
+
+void fb_fill_rect_round(int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+    fb_blit(x,     y,     8, 8, corner_fill_nw, 0);
+    fb_blit(x+w-8, y,     8, 8, corner_fill_ne, 0);
+    fb_blit(x,     y+h-8, 8, 8, corner_fill_sw, 0);
+    fb_blit(x+w-8, y+h-8, 8, 8, corner_fill_se, 0);
+
+    fb_fill_area(x,     x+7,   y+8, y+h-9);
+    fb_fill_area(x+w-8, x+w-1, y+8, y+h-9);
+
+    fb_fill_area(x+8, x+w-9, y, y+h-1);
+}
+
+// Columns of set pixels, blitted for the runs of run length encoded glyphs
+static const uint8_t fb_rle_full[16] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+static const uint8_t fb_rle_partial[8] = { 0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F };
+
+struct fb_rle_reader
+{
+    const uint8_t *data;
+    uint16_t nibbles;
+    uint16_t pos;
+};
+
+// Returns the length of the next run, or -1 at the end of the glyph
+static int fb_rle_next_run(struct fb_rle_reader *reader)
+{
+    int run = 0;
+
+    while(reader->pos < reader->nibbles) {
+        const uint8_t b = reader->data[reader->pos / 2];
+        const uint8_t n = (reader->pos & 1) ? (b & 0x0F) : (b >> 4);
+
+        reader->pos++;
+        run += n;
+
+        if(n != FONT_RLE_EXTEND) {
+            return run;
+        }
+    }
+
+    return -1;
+}
+
+static void fb_draw_column(int16_t x, int16_t y, uint8_t n)
+{
+    if(n >= 8) {
+        fb_blit(x, y, 1, n & ~0x07, fb_rle_full, n / 8);
+        y += n & ~0x07;
+    }
+
+    if(n & 0x07) {
+        fb_blit(x, y, 1, n & 0x07, &fb_rle_partial[n & 0x07], 1);
+    }
+}
+
+// Draw the set runs straight from the encoded data, one column at a time
+static void fb_draw_glyph_rle(int16_t x, int16_t y, uint8_t height, const uint8_t *data, uint8_t len)
+{
+    struct fb_rle_reader reader = { .data = data, .nibbles = 2 * len };
+    uint16_t pos = 0;
+    uint8_t set = 0;
+    int run;
+
+    while((run = fb_rle_next_run(&reader)) >= 0) {
+        if(set) {
+            while(run > 0) {
+                const uint8_t row = pos % height;
+                const uint8_t n = (run < height - row) ? run : height - row;
+
+                fb_draw_column(x + pos / height, y + row, n);
+
+                pos += n;
+                run -= n;
+            }
+        } else {
+            pos += run;
+        }
+
+        set = !set;
+    }
+}
+
+void fb_decode_glyph_rle(uint8_t *dst, uint8_t height, const uint8_t *data, uint8_t len)
+{
+    const uint8_t raster_height = 1 + ((height - 1) / 8);
+    struct fb_rle_reader reader = { .data = data, .nibbles = 2 * len };
+    uint16_t pos = 0;
+    uint8_t set = 0;
+    int run;
+
+    while((run = fb_rle_next_run(&reader)) >= 0) {
+        for(; set && (run > 0); run--, pos++) {
+            const uint8_t row = pos % height;
+
+            dst[(pos / height) * raster_height + row / 8] |= 1 << (row % 8);
+        }
+
+        pos += run;
+        set = !set;
+    }
+}
+
+// Characters to draw instead of the ones from 0x60 that a font does not have.
+// Lower case letters fall back to upper case ones, and accented letters to
+// plain ones. Ä, Ö and Å fall back to [, \ and ], where fonts without Latin-1,
+// such as font_3x5, keep them as in the Swedish variant of ISO 646. A letter
+// falls back at most twice, e.g. from U+00E0 to a to A.
+#define FB_FALLBACK_FIRST 0x60
+
+static const uint8_t fb_fallback[0x100 - FB_FALLBACK_FIRST] = {
+    0x27, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,  // 0x60
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x28, 0x00, 0x29, 0x2D, 0x00,  // 0x70
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x80
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x90
+    0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x00, 0x2D, 0x00, 0x00,  // 0xA0
+    0x00, 0x00, 0x00, 0x00, 0x27, 0x00, 0x00, 0x2E, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00,  // 0xB0
+    0x41, 0x41, 0x41, 0x41, 0x5B, 0x5D, 0x5B, 0x43, 0x45, 0x45, 0x45, 0x45, 0x49, 0x49, 0x49, 0x49,  // 0xC0
+    0x44, 0x4E, 0x4F, 0x4F, 0x4F, 0x4F, 0x5C, 0x78, 0x5C, 0x55, 0x55, 0x55, 0x55, 0x59, 0x00, 0x73,  // 0xD0
+    0x61, 0x61, 0x61, 0x61, 0x5B, 0x5D, 0x5B, 0x63, 0x65, 0x65, 0x65, 0x65, 0x69, 0x69, 0x69, 0x69,  // 0xE0
+    0x64, 0x6E, 0x6F, 0x6F, 0x6F, 0x6F, 0x5C, 0x2F, 0x5C, 0x75, 0x75, 0x75, 0x75, 0x79, 0x00, 0x79,  // 0xF0
+};
+
+const uint8_t *fb_font_entry(const uint8_t *font_data, uint8_t c)
 {
-    const uint8_t char_height = font_data[FONT_HEIGHT_POS];
     const uint8_t first_char = font_data[FONT_FIRST_CHAR_POS];
     const uint8_t char_num = font_data[FONT_CHAR_NUM_POS];
-    const uint16_t jump_table_size = char_num * FONT_JUMPTABLE_BYTES;
+
+    if(font_data[FONT_WIDTH_POS] & FONT_SPARSE_FLAG) {
+        const uint8_t *codes = font_data + FONT_JUMPTABLE_START;
+        uint8_t lo = 0;
+        uint8_t hi = char_num;
+
+        while(lo < hi) {
+            const uint8_t mid = (lo + hi) / 2;
+
+            if(codes[mid] < c) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if((lo == char_num) || (codes[lo] != c)) {
+            return 0;
+        }
+
+        return codes + char_num + lo * FONT_JUMPTABLE_BYTES;
+    }
+
+    if((c < first_char) || (c - first_char >= char_num)) {
+        return 0;
+    }
+
+    return font_data + FONT_JUMPTABLE_START + (c - first_char) * FONT_JUMPTABLE_BYTES;
+}
+
+const uint8_t *fb_font_glyphs(const uint8_t *font_data)
+{
+    const uint8_t char_num = font_data[FONT_CHAR_NUM_POS];
+    const uint8_t *glyphs = font_data + FONT_JUMPTABLE_START + char_num * FONT_JUMPTABLE_BYTES;
+
+    if(font_data[FONT_WIDTH_POS] & FONT_SPARSE_FLAG) {
+        glyphs += char_num;
+    }
+
+    return glyphs;
+}
+
+const uint8_t *fb_next_glyph(const uint8_t *font_data, const char *text, uint8_t len, uint8_t *i)
+{
+    uint8_t c = text[(*i)++];
+
+    if(c & 0x80) {
+        if(((c == 0xC2) || (c == 0xC3)) && (*i < len) && ((text[*i] & 0xC0) == 0x80)) {
+            c = (c << 6) | (text[(*i)++] & 0x3F);
+        } else {
+            while((*i < len) && ((text[*i] & 0xC0) == 0x80)) {
+                (*i)++;
+            }
+            return 0;
+        }
+    }
+
+    const uint8_t *entry = fb_font_entry(font_data, c);
+
+    for(int n = 0; (n < 2) && !entry && (c >= FB_FALLBACK_FIRST); n++) {
+        c = fb_fallback[c - FB_FALLBACK_FIRST];
+
+        if(!c) {
+            break;
+        }
+
+        entry = fb_font_entry(font_data, c);
+    }
+
+    return entry;
+}
+
+void fb_draw_string(int16_t x, int16_t y, const char *text, uint8_t len, const uint8_t *font_data, enum fb_alignment alignment)
+{
+    const uint8_t rle = font_data[FONT_WIDTH_POS] & FONT_RLE_FLAG;
+    const uint8_t char_height = font_data[FONT_HEIGHT_POS];
+    const uint8_t *glyphs = fb_font_glyphs(font_data);
 
     if(!text) {
         return;
@@ -78,21 +312,22 @@ void fb_draw_string(int16_t x, int16_t y, const char *text, uint8_t len, const u
         y -= char_height / 2;
     }
 
-    for(uint8_t i = 0; i < len; i++) {
-        uint8_t c = text[i];
-
-        if(c >= first_char && (c - first_char) < char_num) {
-            c -= first_char;
-
-            const uint8_t *jump_table_entry = font_data + FONT_JUMPTABLE_START + c * FONT_JUMPTABLE_BYTES;
+    for(uint8_t i = 0; i < len;) {
+        const uint8_t *jump_table_entry = fb_next_glyph(font_data, text, len, &i);
 
+        if(jump_table_entry) {
             const uint16_t char_index = (jump_table_entry[FONT_JUMPTABLE_MSB] << 8) | jump_table_entry[FONT_JUMPTABLE_LSB];
             const uint8_t char_bytes = jump_table_entry[FONT_JUMPTABLE_SIZE];
             const uint8_t char_width = jump_table_entry[FONT_JUMPTABLE_WIDTH];
 
             if(char_index != 0xFFFF) {
-                const uint8_t *char_p = font_data + FONT_JUMPTABLE_START + jump_table_size + char_index;
-                fb_blit(x, y, char_width, char_height, char_p, char_bytes);
+                const uint8_t *char_p = glyphs + char_index;
+
+                if(rle) {
+                    fb_draw_glyph_rle(x, y, char_height, char_p, char_bytes);
+                } else {
+                    fb_blit(x, y, char_width, char_height, char_p, char_bytes);
+                }
             }
 
             x += char_width;
@@ -102,19 +337,15 @@ void fb_draw_string(int16_t x, int16_t y, const char *text, uint8_t len, const u
 
 uint16_t fb_string_length(const char *text, uint8_t n, const uint8_t *font_data)
 {
-    const uint8_t first_char = font_data[FONT_FIRST_CHAR_POS];
-    const uint8_t char_num = font_data[FONT_CHAR_NUM_POS];
-
     if(!n) {
         n = strlen(text);
     }
 
     uint16_t len = 0;
-    for(uint8_t i = 0; i < n; i++) {
-        uint8_t c = text[i];
-        if(c >= first_char && (c - first_char) < char_num) {
-            c -= first_char;
-            const uint8_t *jump_table_entry = font_data + FONT_JUMPTABLE_START + c * FONT_JUMPTABLE_BYTES;
+    for(uint8_t i = 0; i < n;) {
+        const uint8_t *jump_table_entry = fb_next_glyph(font_data, text, n, &i);
+
+        if(jump_table_entry) {
             len += jump_table_entry[FONT_JUMPTABLE_WIDTH];
         }
     }
@@ -129,6 +360,24 @@ static uint8_t reverse(uint8_t b)
     return b;
 }
 
+// Parse the decimal number at *p, followed by the separator sep
+static int parse_pbm_number(const char **p, const char *end, char sep)
+{
+    int n = 0;
+    const char *s = *p;
+
+    while((s < end) && (*s >= '0') && (*s <= '9')) {
+        n = 10 * n + (*s++ - '0');
+    }
+
+    if((s == *p) || (s >= end) || (*s != sep)) {
+        return -1;
+    }
+
+    *p = s + 1;
+    return n;
+}
+
 struct icon *fb_load_icon_pbm(const char *filename)
 {
     LOG("Loading icon from file %s", filename);
@@ -140,69 +389,63 @@ struct icon *fb_load_icon_pbm(const char *filename)
         return 0;
     }
 
-    char buf[8];
+    // The header is short, so read it together with the first data bytes
+    char buf[16];
+    const int len = read(fd, buf, sizeof(buf));
 
-    read(fd, buf, 3);
+    const char *p = buf + 3;
+    const char *end = buf + ((len > 0) ? len : 0);
 
-    if((buf[0] != 'P') || (buf[1] != '4') || (buf[2] != '\n'))
+    if((len < 3) || (buf[0] != 'P') || (buf[1] != '4') || (buf[2] != '\n'))
     {
-        buf[3] = 0;
-        LOG("Unexpected PBM magic '%s'", buf);
+        LOG("Unexpected PBM magic");
         close(fd);
         return 0;
     }
 
-    int i = 0;
+    // The icons are stored transposed, with one row per column
+    const int h = parse_pbm_number(&p, end, ' ');
+    const int w = (h > 0) ? parse_pbm_number(&p, end, '\n') : -1;
 
-    do {
-        read(fd, &buf[i++], 1);
-    } while((i < sizeof(buf)-1) && (buf[i-1] != ' '));
-
-    buf[i] = 0;
-    if(buf[i-1] != ' ')
+    if((h <= 0) || (w <= 0))
     {
-        LOG("Could not find width of PBM (got '%s')", buf);
+        LOG("Could not find the size of the PBM");
         close(fd);
         return 0;
     }
 
-    int h = strtol(buf, 0, 10);
-
-    i = 0;
+    const int h_bytes = 1 + (h - 1) / 8;
+    const int data_len = h_bytes * w;
 
-    do {
-        read(fd, &buf[i++], 1);
-    } while((i < sizeof(buf)-1) && (buf[i-1] != '\n'));
+    // The icon and its data share one allocation, see fb_free_icon
+    struct icon *icon = malloc(sizeof(struct icon) + data_len);
 
-    buf[i] = 0;
-    if(buf[i-1] != '\n')
+    if(!icon)
     {
-        LOG("Could not find height of PBM (got '%s')", buf);
         close(fd);
         return 0;
     }
 
-    int w = strtol(buf, 0, 10);
+    uint8_t *data = (uint8_t *)(icon + 1);
+    int n = end - p;
 
-    struct icon *icon = malloc(sizeof(struct icon));
+    if(n > data_len) {
+        n = data_len;
+    }
 
-    int h_bytes = 1 + (h - 1) / 8;
+    memcpy(data, p, n);
 
-    icon->width = w;
-    icon->height = h;
-
-    uint8_t *data = malloc(h_bytes * w);
+    if(n < data_len) {
+        read(fd, data + n, data_len - n);
+    }
 
-    if(data)
+    for(int j = 0; j < data_len; j++)
     {
-        read(fd, data, h_bytes * w);
-
-        for(int j = 0; j < h_bytes * w; j++)
-        {
-            data[j] = reverse(data[j]);
-        }
+        data[j] = reverse(data[j]);
     }
 
+    icon->width = w;
+    icon->height = h;
     icon->data = data;
 
     close(fd);
@@ -211,12 +454,5 @@ struct icon *fb_load_icon_pbm(const char *filename)
 
 void fb_free_icon(struct icon *icon)
 {
-    if(icon)
-    {
-        if(icon->data)
-        {
-            free((char *)icon->data);
-        }
-        free(icon);
-    }
+    free(icon);
 }
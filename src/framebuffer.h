@@ -24,16 +24,47 @@ struct icon {
 
 extern uint8_t *framebuffer;
 
+// The drawing functions of the current display, set by display_driver_select
 extern void (*fb_blit)(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
+extern void (*fb_clear)(void);
+extern void (*fb_fill_rect)(int16_t x, int16_t y, uint16_t w, uint16_t h);
+
+// Blit an image already in the layout of the framebuffer, see the blit_native
+// hook of struct display_driver
+extern void (*fb_blit_native)(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
+
 extern enum fb_pen fb_current_pen;
 
 void fb_set_pen(enum fb_pen pen);
 
+// Draw UTF-8 text. Characters from Latin-1 that the font does not have are
+// drawn with a similar glyph if there is one, see fb_fallback in
+// framebuffer.c, and other characters are left out.
 void fb_draw_string(int16_t x, int16_t y, const char *text, uint8_t len, const uint8_t *font_data, enum fb_alignment alignment);
 uint16_t fb_string_length(const char *text, uint8_t len, const uint8_t *font_data);
 
+// Decode the UTF-8 character at text[*i], move *i past it, and look up the
+// jump table entry of the glyph to draw for it, as fb_draw_string does.
+// Returns 0 for characters that are left out.
+const uint8_t *fb_next_glyph(const uint8_t *font_data, const char *text, uint8_t len, uint8_t *i);
+
+// The jump table entry for the character c, or 0 if the font does not have it
+const uint8_t *fb_font_entry(const uint8_t *font_data, uint8_t c);
+
+// The start of the glyph data, which the jump table indices are relative to
+const uint8_t *fb_font_glyphs(const uint8_t *font_data);
+
+// Decode a run length encoded glyph, see fonts.h, into the column by column
+// layout of plain fonts. dst must be cleared by the caller.
+void fb_decode_glyph_rle(uint8_t *dst, uint8_t height, const uint8_t *data, uint8_t len);
+
 void fb_draw_icon(int16_t x, int16_t y, const struct icon *icon, enum fb_alignment alignment);
 
+// Rectangles with corners rounded over 8 pixels, drawn with fb_blit and
+// fb_fill_rect. w and h should be at least 16.
+void fb_draw_rect_round(int16_t x, int16_t y, uint16_t w, uint16_t h);
+void fb_fill_rect_round(int16_t x, int16_t y, uint16_t w, uint16_t h);
+
 struct icon *fb_load_icon_pbm(const char *filename);
 void fb_free_icon(struct icon *);
 
@@ -0,0 +1,173 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyph-cache.h"
+#include "fonts.h"
+
+#include "log.h"
+#define LOG_SYS LOG_SYS_DISPLAY
+
+static int glyph_cache_index(char c)
+{
+    if((c >= '0') && (c <= '9')) {
+        return c - '0';
+    } else if(c == ':') {
+        return 10;
+    } else if(c == ' ') {
+        return 11;
+    } else if(c == '-') {
+        return 12;
+    }
+
+    return -1;
+}
+
+// Convert the column by column font data to rows, with the leftmost pixel in
+// the most significant bit
+static void glyph_cache_convert_rows(uint8_t *dst, const uint8_t *src, uint8_t src_bytes, uint8_t width, uint8_t height)
+{
+    const uint8_t raster_height = 1 + ((height - 1) / 8);
+    const uint8_t row_bytes = (width + 7) / 8;
+
+    for(uint8_t x = 0; x < width; x++) {
+        for(uint8_t y = 0; y < height; y++) {
+            const uint16_t n = x * raster_height + y / 8;
+
+            if((n < src_bytes) && (src[n] & (1 << (y % 8)))) {
+                dst[y * row_bytes + x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+}
+
+int glyph_cache_init(struct glyph_cache *cache, const uint8_t *font, enum glyph_cache_layout layout)
+{
+    const uint8_t max_width = font[FONT_WIDTH_POS] & FONT_WIDTH_MASK;
+    const uint8_t rle = font[FONT_WIDTH_POS] & FONT_RLE_FLAG;
+    const uint8_t height = font[FONT_HEIGHT_POS];
+    const uint8_t *glyphs = fb_font_glyphs(font);
+
+    cache->font = font;
+    cache->layout = layout;
+    cache->height = height;
+    cache->present = 0;
+
+    if(layout == GLYPH_CACHE_LAYOUT_PAGES) {
+        cache->glyph_bytes = max_width * (1 + ((height - 1) / 8));
+    } else {
+        cache->glyph_bytes = height * ((max_width + 7) / 8);
+    }
+
+    cache->data = calloc(GLYPH_CACHE_NUM_GLYPHS, cache->glyph_bytes);
+
+    // Run length encoded glyphs are decoded to the layout of plain fonts first
+    uint8_t *decoded = rle ? malloc(max_width * (1 + ((height - 1) / 8))) : 0;
+
+    if(!cache->data || (rle && !decoded)) {
+        ERROR("Could not allocate glyph cache");
+        free(cache->data);
+        free(decoded);
+        cache->data = 0;
+        return -1;
+    }
+
+    for(int i = 0; i < GLYPH_CACHE_NUM_GLYPHS; i++) {
+        const uint8_t *entry = fb_font_entry(font, GLYPH_CACHE_CHARS[i]);
+
+        if(!entry) {
+            continue;
+        }
+
+        const uint16_t index = (entry[FONT_JUMPTABLE_MSB] << 8) | entry[FONT_JUMPTABLE_LSB];
+        uint8_t bytes = entry[FONT_JUMPTABLE_SIZE];
+        const uint8_t width = entry[FONT_JUMPTABLE_WIDTH];
+        uint8_t *dst = cache->data + i * cache->glyph_bytes;
+
+        cache->bytes[i] = 0;
+
+        if(width > max_width) {
+            continue;
+        }
+
+        // Glyphs without data, such as space, stay blank
+        if(index != 0xFFFF) {
+            const uint8_t *src = glyphs + index;
+
+            if(rle) {
+                bytes = width * (1 + ((height - 1) / 8));
+                memset(decoded, 0, bytes);
+                fb_decode_glyph_rle(decoded, height, src, entry[FONT_JUMPTABLE_SIZE]);
+                src = decoded;
+
+                // Leave out the trailing empty bytes, as plain fonts do
+                while(bytes && !decoded[bytes - 1]) {
+                    bytes--;
+                }
+            }
+
+            if(layout == GLYPH_CACHE_LAYOUT_PAGES) {
+                cache->bytes[i] = (bytes < cache->glyph_bytes) ? bytes : cache->glyph_bytes;
+                memcpy(dst, src, cache->bytes[i]);
+            } else {
+                glyph_cache_convert_rows(dst, src, bytes, width, height);
+                cache->bytes[i] = cache->glyph_bytes;
+            }
+        }
+
+        cache->width[i] = width;
+        cache->present |= 1 << i;
+    }
+
+    free(decoded);
+
+    return 0;
+}
+
+void glyph_cache_free(struct glyph_cache *cache)
+{
+    free(cache->data);
+    cache->data = 0;
+    cache->present = 0;
+}
+
+void glyph_cache_draw_string(const struct glyph_cache *cache, int16_t x, int16_t y, const char *text, enum fb_alignment alignment)
+{
+    int8_t index[8];
+    uint8_t len = 0;
+    uint16_t width = 0;
+
+    for(; text[len]; len++) {
+        const int i = glyph_cache_index(text[len]);
+
+        if((len >= sizeof(index)) || (i < 0) || !(cache->present & (1 << i))) {
+            fb_draw_string(x, y, text, 0, cache->font, alignment);
+            return;
+        }
+
+        index[len] = i;
+        width += cache->width[i];
+    }
+
+    if(alignment & FB_ALIGN_CENTER_H) {
+        x -= width / 2;
+    } else if(alignment & FB_ALIGN_END_H) {
+        x -= width;
+    }
+
+    // Same vertical alignment as fb_draw_string
+    if(alignment & (FB_ALIGN_CENTER_V | FB_ALIGN_END_V)) {
+        y -= cache->height / 2;
+    }
+
+    for(uint8_t n = 0; n < len; n++) {
+        const uint8_t *data = cache->data + index[n] * cache->glyph_bytes;
+        const uint8_t w = cache->width[index[n]];
+
+        if(cache->bytes[index[n]]) {
+            fb_blit_native(x, y, w, cache->height, data, cache->bytes[index[n]]);
+        }
+
+        x += w;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef GLYPH_CACHE_H_
+#define GLYPH_CACHE_H_
+
+#include <stdint.h>
+
+#include "framebuffer.h"
+
+// The glyphs needed to show a time, "--:--" included, converted once into
+// the native layout of the display. Strings made of these glyphs are blitted
+// straight from the cache without walking the jump table of the font.
+#define GLYPH_CACHE_CHARS "0123456789: -"
+#define GLYPH_CACHE_NUM_GLYPHS 13
+
+enum glyph_cache_layout {
+    // Column by column, as the font and the OLED framebuffer
+    GLYPH_CACHE_LAYOUT_PAGES,
+    // Row by row, as the LED matrix framebuffer
+    GLYPH_CACHE_LAYOUT_ROWS,
+};
+
+struct glyph_cache
+{
+    const uint8_t *font;
+    uint8_t layout;
+    uint8_t height;
+    uint8_t glyph_bytes;
+    uint16_t present;
+    uint8_t width[GLYPH_CACHE_NUM_GLYPHS];
+    // Bytes of glyph data, without the trailing empty bytes left out by the
+    // font, or 0 for glyphs without any
+    uint8_t bytes[GLYPH_CACHE_NUM_GLYPHS];
+    uint8_t *data;
+};
+
+// Returns 0 on success. If the cache could not be allocated, strings are
+// drawn with fb_draw_string instead.
+int glyph_cache_init(struct glyph_cache *cache, const uint8_t *font, enum glyph_cache_layout layout);
+void glyph_cache_free(struct glyph_cache *cache);
+
+// Draw a string like fb_draw_string, blitting the glyphs with fb_blit_native,
+// so the layout of the cache must be that of the current display. Falls back to fb_draw_string if the
+// string contains a character that is not in the cache.
+void glyph_cache_draw_string(const struct glyph_cache *cache, int16_t x, int16_t y, const char *text, enum fb_alignment alignment);
+
+#endif
@@ -21,6 +21,8 @@
 #include "http-sm/websocket.h"
 #include "http-server-task.h"
 #include "http-server-url-handlers.h"
+#include "status-cache.h"
+#include "display-mirror.h"
 
 
 #define LOG_SYS LOG_SYS_HTTPD
@@ -43,6 +45,123 @@ void http_server_write_simple_response(struct http_request* request, int status,
     http_end_body(request);
 }
 
+struct json_response_writer {
+    struct http_request *request;
+    int remaining;
+    int overflow;
+};
+
+static int json_response_write_string(struct json_response_writer *writer, const char *s)
+{
+    int n = strlen(s);
+
+    if(n > writer->remaining) {
+        writer->overflow += n - writer->remaining;
+        n = writer->remaining;
+    }
+
+    if(n > 0) {
+        http_write_bytes(writer->request, s, n);
+        writer->remaining -= n;
+    }
+
+    return n;
+}
+
+// Bodies up to this size are serialized into a buffer before they are sent,
+// and the tries at it if the body grows in the meantime
+#define JSON_RESPONSE_MAX_BUFFER 1024
+#define JSON_RESPONSE_MAX_TRIES 3
+
+// Serialize a small body into a buffer and send it. Returns 0 if the body
+// does not fit in JSON_RESPONSE_MAX_BUFFER or the buffer cannot be allocated,
+// with *content_length the size of the body at the last pass.
+static int write_buffered_json_response(struct http_request* request, int status, http_server_json_func func, void *arg, int *content_length)
+{
+    struct json_writer json;
+
+    for(int i = 0; (i < JSON_RESPONSE_MAX_TRIES) && (*content_length <= JSON_RESPONSE_MAX_BUFFER); i++) {
+        struct json_writer_buffer buffer;
+        char *buf = malloc(*content_length + 1);
+
+        if(!buf) {
+            return 0;
+        }
+
+        json_writer_buffer_init(&json, &buffer, buf, *content_length);
+        func(&json, arg);
+
+        if(!buffer.overflow) {
+            http_begin_response(request, status, "application/json");
+            http_write_header(request, "Cache-Control", "no-cache");
+            http_set_content_length(request, buffer.pos);
+            http_end_header(request);
+
+            http_write_bytes(request, buf, buffer.pos);
+            http_end_body(request);
+
+            free(buf);
+            return 1;
+        }
+
+        *content_length += buffer.overflow;
+        free(buf);
+    }
+
+    return 0;
+}
+
+// Run the serializer once to find the size of the body, then once more to
+// write it. With a known Content-Length the connection can be kept open.
+//
+// Small bodies are written to a buffer first, so that the data may change
+// between the two passes: if it grew, the buffer is enlarged and the body
+// serialized again. Larger bodies are streamed, so func should give the same
+// output on both passes, e.g. by fixing the range of data as cgi_log does. If
+// it does not, the body is truncated or padded with whitespace to keep the
+// framing intact.
+void http_server_write_json_response(struct http_request* request, int status, http_server_json_func func, void *arg)
+{
+    struct json_writer json;
+    int content_length = 0;
+
+    json_writer_count_init(&json, &content_length);
+    func(&json, arg);
+
+    if(write_buffered_json_response(request, status, func, arg, &content_length)) {
+        return;
+    }
+
+    http_begin_response(request, status, "application/json");
+    http_write_header(request, "Cache-Control", "no-cache");
+    http_set_content_length(request, content_length);
+    http_end_header(request);
+
+    struct json_response_writer writer = {
+        .request = request,
+        .remaining = content_length,
+        .overflow = 0,
+    };
+
+    json.user = &writer;
+    json.current = 0;
+    json.write_string = (json_writer_io) json_response_write_string;
+
+    func(&json, arg);
+
+    if(writer.overflow > 0) {
+        WARNING("JSON response grew by %d bytes after it was sized", writer.overflow);
+    } else if(writer.remaining > 0) {
+        WARNING("JSON response shrunk by %d bytes after it was sized", writer.remaining);
+
+        while(writer.remaining > 0) {
+            json_response_write_string(&writer, " ");
+        }
+    }
+
+    http_end_body(request);
+}
+
 enum http_cgi_state cgi_not_found(struct http_request* request)
 {
     http_server_write_simple_response(request, 404, "text/plain", "Not found\r\n");
@@ -358,13 +477,10 @@ void ws_in_message(struct websocket_connection* conn)
     free(str);
 }
 
-struct websocket_connection* ws_display_conn = 0;
-
 int ws_display_open(struct websocket_connection* conn, struct http_request* request)
 {
-    if(ws_display_conn == 0) {
-        LOG("WS: new in connection %d", request->fd);
-        ws_display_conn = conn;
+    if(display_mirror_add(conn)) {
+        LOG("WS: new display connection %d", request->fd);
         return 1;
     }
     return 0;
@@ -372,7 +488,7 @@ int ws_display_open(struct websocket_connection* conn, struct http_request* requ
 
 void ws_display_close(struct websocket_connection* conn)
 {
-    ws_display_conn = 0;
+    display_mirror_remove(conn);
 }
 
 
@@ -409,6 +525,8 @@ struct http_url_handler http_url_tab[] = {
     {"/api/syslog-config.json", cgi_syslog_config, NULL},
     {"/api/led-matrix-config.json", cgi_led_matrix_config, NULL},
     {"/api/led-matrix-status.json", cgi_led_matrix_status, NULL},
+    {"/api/screenshot.pbm", cgi_screenshot_pbm, NULL},
+    {"/api/screenshot.png", cgi_screenshot_png, NULL},
     {"/", cgi_fs, "/www/index.html"},
     {"/*", cgi_fs, NULL},
     {NULL, NULL, NULL}
@@ -425,6 +543,8 @@ struct websocket_url_handler websocket_url_tab[] = {
 
 void http_server_task(void *pvParameters)
 {
+    status_cache_init(os_random());
+
     for(;;) {
         http_server_main(80);
         ERROR("The http server has returned!");
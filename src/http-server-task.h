@@ -4,6 +4,11 @@
 void http_server_task(void *pvParameters);
 
 struct http_request;
+struct json_writer;
+
+typedef void (*http_server_json_func)(struct json_writer *json, void *arg);
+
 void http_server_write_simple_response(struct http_request* request, int status, const char* content_type, const char* reply);
+void http_server_write_json_response(struct http_request* request, int status, http_server_json_func func, void *arg);
 
 #endif
@@ -20,7 +20,13 @@
 #include "http-server-url-handlers.h"
 #include "config.h"
 #include "display.h"
+#include "display-driver.h"
 #include "matrix_display.h"
+#include "status-cache.h"
+#include "tasks.h"
+#include "display-stats.h"
+#include "display-flush.h"
+#include "screenshot.h"
 
 #define LOG_SYS LOG_SYS_HTTPD
 
@@ -39,33 +45,29 @@ static const char *get_status_of_ap(const struct wifi_ap *ap)
     return "";
 }
 
-enum http_cgi_state cgi_wifi_list(struct http_request* request)
+static void write_wifi_list(struct json_writer *json, void *arg)
 {
-    if(request->method == HTTP_METHOD_GET) {
-        http_begin_response(request, 200, "application/json");
-        http_write_header(request, "Cache-Control", "no-cache");
-        http_end_header(request);
+    json_writer_begin_array(json, NULL);
 
-        struct json_writer json;
-        json_writer_http_init(&json, request);
-
-        json_writer_begin_array(&json, NULL);
-
-        wifi_take_mutex();
+    wifi_take_mutex();
 
-        for(const struct wifi_ap *ap = wifi_first_ap; ap; ap = ap->next) {
-            json_writer_begin_object(&json, NULL);
-            json_writer_write_string(&json, "ssid", ap->ssid);
-            json_writer_write_bool(&json, "saved", 1);
-            json_writer_write_string(&json, "status", get_status_of_ap(ap));
-            json_writer_end_object(&json);
-        }
+    for(const struct wifi_ap *ap = wifi_first_ap; ap; ap = ap->next) {
+        json_writer_begin_object(json, NULL);
+        json_writer_write_string(json, "ssid", ap->ssid);
+        json_writer_write_bool(json, "saved", 1);
+        json_writer_write_string(json, "status", get_status_of_ap(ap));
+        json_writer_end_object(json);
+    }
 
-        wifi_give_mutex();
+    wifi_give_mutex();
 
-        json_writer_end_array(&json);
+    json_writer_end_array(json);
+}
 
-        http_end_body(request);
+enum http_cgi_state cgi_wifi_list(struct http_request* request)
+{
+    if(request->method == HTTP_METHOD_GET) {
+        http_server_write_json_response(request, 200, write_wifi_list, NULL);
 
         return HTTP_CGI_DONE;
     } else if(request->method == HTTP_METHOD_POST) {
@@ -102,6 +104,8 @@ enum http_cgi_state cgi_wifi_list(struct http_request* request)
                             wifi_ap_add(ssid, password);
                             wifi_give_mutex();
 
+                            status_cache_invalidate(STATUS_SECTION_WIFI);
+
                             LOG("Added new AP %s", ssid);
 
                             if(wifi_state == WIFI_STATE_AP_CONNECTED) {
@@ -158,6 +162,8 @@ enum http_cgi_state cgi_wifi_list(struct http_request* request)
 
                     wifi_give_mutex();
 
+                    status_cache_invalidate(STATUS_SECTION_WIFI);
+
                     LOG("Removed AP %s", ssid);
 
                     free(ssid);
@@ -198,6 +204,21 @@ static const char* format_authmode(uint8_t authmode)
     }
 }
 
+static void write_wifi_scan(struct json_writer *json, void *arg)
+{
+    json_writer_begin_array(json, NULL);
+
+    for(struct wifi_scan_ap *ap = wifi_first_scan_ap; ap; ap = ap->next) {
+        json_writer_begin_object(json, NULL);
+        json_writer_write_string(json, "ssid", ap->ssid);
+        json_writer_write_int(json, "rssi", ap->rssi);
+        json_writer_write_string(json, "encryption", format_authmode(ap->authmode));
+        json_writer_end_object(json);
+    }
+
+    json_writer_end_array(json);
+}
+
 enum http_cgi_state cgi_wifi_scan(struct http_request* request)
 {
     if(request->method != HTTP_METHOD_GET) {
@@ -207,9 +228,6 @@ enum http_cgi_state cgi_wifi_scan(struct http_request* request)
     if(!request->cgi_data) {
         wifi_start_scan();
 
-        http_begin_response(request, 200, "application/json");
-        http_end_header(request);
-
         request->cgi_data = malloc(1);
         return HTTP_CGI_MORE;
     } else {
@@ -217,22 +235,7 @@ enum http_cgi_state cgi_wifi_scan(struct http_request* request)
             return HTTP_CGI_MORE;
         }
 
-        struct json_writer json;
-        json_writer_http_init(&json, request);
-
-        json_writer_begin_array(&json, NULL);
-
-        for(struct wifi_scan_ap *ap = wifi_first_scan_ap; ap; ap = ap->next) {
-            json_writer_begin_object(&json, NULL);
-            json_writer_write_string(&json, "ssid", ap->ssid);
-            json_writer_write_int(&json, "rssi", ap->rssi);
-            json_writer_write_string(&json, "encryption", format_authmode(ap->authmode));
-            json_writer_end_object(&json);
-        }
-
-        json_writer_end_array(&json);
-
-        http_end_body(request);
+        http_server_write_json_response(request, 200, write_wifi_scan, NULL);
 
         free(request->cgi_data);
 
@@ -240,18 +243,15 @@ enum http_cgi_state cgi_wifi_scan(struct http_request* request)
     }
 }
 
+static void write_journey_config(struct json_writer *json, void *arg)
+{
+    config_save_journies(json, NULL);
+}
+
 enum http_cgi_state cgi_journey_config(struct http_request* request)
 {
     if(request->method == HTTP_METHOD_GET) {
-        http_begin_response(request, 200, "application/json");
-        http_end_header(request);
-
-        struct json_writer json;
-        json_writer_http_init(&json, request);
-
-        config_save_journies(&json, NULL);
-
-        http_end_body(request);
+        http_server_write_json_response(request, 200, write_journey_config, NULL);
 
         return HTTP_CGI_DONE;
     } else if(request->method == HTTP_METHOD_POST) {
@@ -270,21 +270,11 @@ enum http_cgi_state cgi_journey_config(struct http_request* request)
     }
 }
 
-extern xTaskHandle task_handle[];
-extern const char *task_names[];
-
 static void write_system_status(struct json_writer* json)
 {
     json_writer_begin_object(json, "system");
 
-    const char *graphics = "None";
-    if(display_type == DISPLAY_TYPE_OLED) {
-        graphics = "SH1106";
-    } else if(display_type == DISPLAY_TYPE_MATRIX) {
-        graphics = "LED Matrix";
-    }
-
-    json_writer_write_string(json, "graphics", graphics);
+    json_writer_write_string(json, "graphics", display_driver ? display_driver->name : "None");
 
     json_writer_write_int(json, "heap", xPortGetFreeHeapSize());
     json_writer_begin_array(json, "tasks");
@@ -454,63 +444,203 @@ static void write_journies_status(struct json_writer *json)
     json_writer_end_array(json);
 }
 
+// The client passes the ETag it already has as a query argument, since the
+// request headers are not available to the handler
+static int etag_matches(const char *etag, const char *arg)
+{
+    int len = strlen(etag) - 2;
+
+    if(*arg == '"') {
+        arg++;
+    }
+
+    return (strncmp(etag + 1, arg, len) == 0) && (arg[len] == '\0' || (arg[len] == '"' && arg[len+1] == '\0'));
+}
+
 enum http_cgi_state cgi_status(struct http_request* request)
 {
     if(request->method != HTTP_METHOD_GET) {
         return HTTP_CGI_NOT_FOUND;
     }
 
+    time_t now = time(0);
+
+    status_cache_update(STATUS_SECTION_SYSTEM, write_system_status, now);
+    status_cache_update(STATUS_SECTION_WIFI, write_wifi_status, now);
+    status_cache_update(STATUS_SECTION_TIME, write_time_status, now);
+    status_cache_update(STATUS_SECTION_JOURNIES, write_journies_status, now);
+    status_cache_update(STATUS_SECTION_DISPLAY, display_stats_write, now);
+
+    char etag[STATUS_CACHE_ETAG_LEN];
+    status_cache_get_etag(etag, sizeof(etag));
+
+    const char *client_etag = http_get_query_arg(request, "etag");
+
+    if(client_etag && etag_matches(etag, client_etag)) {
+        http_begin_response(request, 304, NULL);
+        http_write_header(request, "Cache-Control", "no-cache");
+        http_write_header(request, "ETag", etag);
+        http_set_content_length(request, 0);
+        http_end_header(request);
+        http_end_body(request);
+
+        return HTTP_CGI_DONE;
+    }
+
     http_begin_response(request, 200, "application/json");
     http_write_header(request, "Cache-Control", "no-cache");
+    http_write_header(request, "ETag", etag);
+    http_set_content_length(request, status_cache_get_length());
     http_end_header(request);
 
     struct json_writer json;
     json_writer_http_init(&json, request);
 
-    json_writer_begin_object(&json, NULL);
-
-    write_system_status(&json);
-    write_wifi_status(&json);
-    write_time_status(&json);
-    write_journies_status(&json);
-
-    json_writer_end_object(&json);
+    status_cache_write(&json);
 
     http_end_body(request);
+
     return HTTP_CGI_DONE;
 }
 
+#define LOG_MAX_WAIT 30
+
+// A waiting request blocks the HTTP task for at most this long at a time, so
+// that the other connections are still served
+#define LOG_POLL_MS 100
+
+struct log_query {
+    uint32_t since;
+    uint32_t until;
+    enum log_level level;
+    enum log_system system;
+    uint8_t cursor;
+    portTickType deadline;
+};
+
+static void write_log(struct json_writer *json, void *arg)
+{
+    const struct log_query *query = arg;
+    struct log_cbuf_message msg;
+
+    if(query->cursor) {
+        json_writer_begin_object(json, NULL);
+        json_writer_write_int(json, "cursor", query->until);
+        json_writer_begin_array(json, "messages");
+    } else {
+        json_writer_begin_array(json, NULL);
+    }
+
+    for(uint32_t seq = query->since; (seq = log_cbuf_next(seq, query->until, query->level, query->system, &msg)) != 0; ) {
+        json_writer_begin_object(json, NULL);
+
+        if(query->cursor) {
+            json_writer_write_int(json, "seq", msg.seq);
+        }
+        json_writer_write_int(json, "timestamp", msg.timestamp);
+        json_writer_write_int(json, "level", msg.level);
+        json_writer_write_int(json, "system", msg.system);
+        json_writer_write_string(json, "message", msg.message);
+
+        json_writer_end_object(json);
+    }
+
+    json_writer_end_array(json);
+
+    if(query->cursor) {
+        json_writer_end_object(json);
+    }
+}
+
+// GET /api/log.json returns all messages in the buffer as an array.
+//
+// With ?since=<seq> only messages newer than seq are returned, together with
+// the cursor to pass as since in the next request. The messages can be
+// filtered with level=<n> (at most level n) and system=<id>. With wait=<s>
+// the request is held for up to s seconds until a matching message arrives.
 enum http_cgi_state cgi_log(struct http_request* request)
 {
     if(request->method != HTTP_METHOD_GET) {
         return HTTP_CGI_NOT_FOUND;
     }
 
-    http_begin_response(request, 200, "application/json");
-    http_write_header(request, "Cache-Control", "no-cache");
-    http_end_header(request);
+    struct log_query *query = request->cgi_data;
 
-    struct json_writer json;
-    json_writer_http_init(&json, request);
+    if(!query) {
+        query = malloc(sizeof(*query));
+
+        if(!query) {
+            http_server_write_simple_response(request, 500, "application/json", "{\"message\" : \"Out of memory\"}");
+            return HTTP_CGI_DONE;
+        }
+
+        const char *since = http_get_query_arg(request, "since");
+        const char *level = http_get_query_arg(request, "level");
+        const char *system = http_get_query_arg(request, "system");
+        const char *wait = http_get_query_arg(request, "wait");
+
+        query->since = since ? strtoul(since, NULL, 10) : 0;
+        query->cursor = since ? 1 : 0;
+
+        // A cursor from before a reboot
+        if(query->since > log_cbuf.seq) {
+            query->since = 0;
+        }
+
+        query->level = LOG_LEVEL_DEBUG;
+        query->system = LOG_SYS_ALL;
+        query->deadline = xTaskGetTickCount();
+
+        if(level) {
+            int n = atoi(level);
+            if(n >= 0 && n < LOG_NUM_LEVELS) {
+                query->level = n;
+            }
+        }
 
-    json_writer_begin_array(&json, NULL);
+        if(system) {
+            int n = atoi(system);
+            if(n >= 0 && n < LOG_NUM_SYSTEMS) {
+                query->system = n;
+            }
+        }
 
-    for(int tail = (log_cbuf.head + 1) % LOG_CBUF_LEN; tail != log_cbuf.head; tail = (tail + 1) % LOG_CBUF_LEN) {
-        if(log_cbuf.message[tail].message[0]) {
-            json_writer_begin_object(&json, NULL);
+        if(wait && query->cursor) {
+            int n = atoi(wait);
+            if(n > LOG_MAX_WAIT) {
+                n = LOG_MAX_WAIT;
+            }
+            if(n > 0) {
+                query->deadline += n * 1000 / portTICK_RATE_MS;
+            }
+        }
 
-            json_writer_write_int(&json, "timestamp", log_cbuf.message[tail].timestamp);
-            json_writer_write_int(&json, "level", log_cbuf.message[tail].level);
-            json_writer_write_int(&json, "system", log_cbuf.message[tail].system);
-            json_writer_write_string(&json, "message", log_cbuf.message[tail].message);
+        request->cgi_data = query;
+    }
 
-            json_writer_end_object(&json);
+    const int32_t remaining = query->deadline - xTaskGetTickCount();
+
+    if(remaining > 0) {
+        uint32_t timeout_ms = remaining * portTICK_RATE_MS;
+
+        if(timeout_ms > LOG_POLL_MS) {
+            timeout_ms = LOG_POLL_MS;
+        }
+
+        if(!log_cbuf_poll(query->since, query->level, query->system, timeout_ms)) {
+            return HTTP_CGI_MORE;
         }
     }
 
-    json_writer_end_array(&json);
+    // Fix the range before sizing the response, so that messages logged
+    // while it is written do not change its length
+    query->until = log_cbuf.seq;
+
+    http_server_write_json_response(request, 200, write_log, query);
+
+    free(query);
+    request->cgi_data = NULL;
 
-    http_end_body(request);
     return HTTP_CGI_DONE;
 }
 
@@ -519,47 +649,43 @@ extern ip_addr_t syslog_addr;
 extern int syslog_enabled;
 
 
-enum http_cgi_state cgi_syslog_config(struct http_request* request)
+static void write_syslog_config(struct json_writer *json, void *arg)
 {
-    if(request->method == HTTP_METHOD_GET) {
-        http_begin_response(request, 200, "application/json");
-        http_write_header(request, "Cache-Control", "no-cache");
-        http_end_header(request);
-
-        struct json_writer json;
-        json_writer_http_init(&json, request);
-
-        json_writer_begin_object(&json, NULL);
+    json_writer_begin_object(json, NULL);
 
-        char buf[16];
+    char buf[16];
 
-        ipaddr_ntoa_r(&syslog_addr, buf, sizeof(buf));
-        json_writer_write_string(&json, "ip", buf);
+    ipaddr_ntoa_r(&syslog_addr, buf, sizeof(buf));
+    json_writer_write_string(json, "ip", buf);
 
-        json_writer_write_bool(&json, "enabled", syslog_enabled);
+    json_writer_write_bool(json, "enabled", syslog_enabled);
 
-        json_writer_begin_array(&json, "systems");
-        for(enum log_system system = 0; system < LOG_NUM_SYSTEMS; system++) {
-            json_writer_write_string(&json, NULL, log_system_names[system]);
-        }
-        json_writer_end_array(&json);
+    json_writer_begin_array(json, "systems");
+    for(enum log_system system = 0; system < LOG_NUM_SYSTEMS; system++) {
+        json_writer_write_string(json, NULL, log_system_names[system]);
+    }
+    json_writer_end_array(json);
 
-        json_writer_begin_array(&json, "levels");
-        for(enum log_level level = 0; level < LOG_NUM_LEVELS; level++) {
-            json_writer_write_string(&json, NULL, log_level_names[level]);
-        }
-        json_writer_end_array(&json);
+    json_writer_begin_array(json, "levels");
+    for(enum log_level level = 0; level < LOG_NUM_LEVELS; level++) {
+        json_writer_write_string(json, NULL, log_level_names[level]);
+    }
+    json_writer_end_array(json);
 
-        json_writer_begin_array(&json, "system-levels");
-        for(enum log_system system = 0; system < LOG_NUM_SYSTEMS; system++) {
-            json_writer_write_int(&json, NULL, log_get_level(LOG_CBUF, system));
-        }
-        json_writer_end_array(&json);
+    json_writer_begin_array(json, "system-levels");
+    for(enum log_system system = 0; system < LOG_NUM_SYSTEMS; system++) {
+        json_writer_write_int(json, NULL, log_get_level(LOG_CBUF, system));
+    }
+    json_writer_end_array(json);
 
+    json_writer_end_object(json);
+}
 
-        json_writer_end_object(&json);
+enum http_cgi_state cgi_syslog_config(struct http_request* request)
+{
+    if(request->method == HTTP_METHOD_GET) {
+        http_server_write_json_response(request, 200, write_syslog_config, NULL);
 
-        http_end_body(request);
         return HTTP_CGI_DONE;
     } else if(request->method == HTTP_METHOD_POST) {
         json_stream json;
@@ -661,21 +787,18 @@ enum http_cgi_state cgi_syslog_config(struct http_request* request)
     return HTTP_CGI_NOT_FOUND;
 }
 
+static void write_led_matrix_config(struct json_writer *json, void *arg)
+{
+    config_save_led_matrix(json, NULL);
+}
+
 enum http_cgi_state cgi_led_matrix_config(struct http_request* request)
 {
     if(request->method == HTTP_METHOD_GET) {
         if((matrix_intensity_mutex != NULL) && (xSemaphoreTake(matrix_intensity_mutex, portMAX_DELAY) == pdTRUE)) {
-            http_begin_response(request, 200, "application/json");
-            http_write_header(request, "Cache-Control", "no-cache");
-            http_end_header(request);
-
-            struct json_writer json;
-            json_writer_http_init(&json, request);
-
-            config_save_led_matrix(&json, NULL);
+            http_server_write_json_response(request, 200, write_led_matrix_config, NULL);
 
             xSemaphoreGive(matrix_intensity_mutex);
-            http_end_body(request);
         } else {
             WARNING("Could not get matrix mutex");
             http_server_write_simple_response(request, 503, NULL, NULL);
@@ -703,28 +826,116 @@ enum http_cgi_state cgi_led_matrix_config(struct http_request* request)
     return HTTP_CGI_NOT_FOUND;
 }
 
-enum http_cgi_state cgi_led_matrix_status(struct http_request* request)
+struct led_matrix_status {
+    uint8_t valid;
+    uint8_t level;
+    uint16_t adc;
+};
+
+static void write_led_matrix_status(struct json_writer *json, void *arg)
 {
-    if(request->method == HTTP_METHOD_GET) {
-        http_begin_response(request, 200, "application/json");
-        http_write_header(request, "Cache-Control", "no-cache");
-        http_end_header(request);
+    const struct led_matrix_status *status = arg;
 
-        struct json_writer json;
-        json_writer_http_init(&json, request);
+    json_writer_begin_object(json, NULL);
 
-        json_writer_begin_object(&json, NULL);
+    if(status->valid) {
+        json_writer_write_int(json, "level", status->level);
+        json_writer_write_int(json, "adc", status->adc);
+    }
+
+    json_writer_end_object(json);
+}
+
+enum http_cgi_state cgi_led_matrix_status(struct http_request* request)
+{
+    if(request->method == HTTP_METHOD_GET) {
+        struct led_matrix_status status = { .valid = 0 };
 
         if((matrix_intensity_mutex != NULL) && (xSemaphoreTake(matrix_intensity_mutex, portMAX_DELAY) == pdTRUE)) {
-            json_writer_write_int(&json, "level", matrix_intensity_level);
-            json_writer_write_int(&json, "adc", matrix_intensity_adc);
+            status.level = matrix_intensity_level;
+            status.adc = matrix_intensity_adc;
+            status.valid = 1;
             xSemaphoreGive(matrix_intensity_mutex);
         }
 
-        json_writer_end_object(&json);
+        http_server_write_json_response(request, 200, write_led_matrix_status, &status);
 
-        http_end_body(request);
         return HTTP_CGI_DONE;
     }
     return HTTP_CGI_NOT_FOUND;
 }
+
+struct screenshot_response {
+    struct screenshot screenshot;
+    uint8_t frame[];
+};
+
+// Take a copy of the frame on the first call, then stream the image a few
+// rows per call
+static enum http_cgi_state cgi_screenshot(struct http_request* request, enum screenshot_type type)
+{
+    if(request->method != HTTP_METHOD_GET) {
+        return HTTP_CGI_NOT_FOUND;
+    }
+
+    struct screenshot_response *response = request->cgi_data;
+
+    if(!response) {
+        const struct display_driver *driver = display_driver;
+
+        if(!driver) {
+            http_server_write_simple_response(request, 503, "text/plain", "No display");
+            return HTTP_CGI_DONE;
+        }
+
+        const uint16_t len = display_driver_frame_len(driver);
+
+        response = malloc(sizeof(*response) + len);
+
+        if(!response) {
+            http_server_write_simple_response(request, 500, "text/plain", "Out of memory");
+            return HTTP_CGI_DONE;
+        }
+
+        if(!display_flush_copy_frame(response->frame, len)) {
+            free(response);
+            http_server_write_simple_response(request, 503, "text/plain", "No frame");
+            return HTTP_CGI_DONE;
+        }
+
+        screenshot_init(&response->screenshot, type, &driver->format, response->frame);
+
+        http_begin_response(request, 200, (type == SCREENSHOT_PNG) ? "image/png" : "image/x-portable-bitmap");
+        http_write_header(request, "Cache-Control", "no-cache");
+        http_set_content_length(request, screenshot_length(&response->screenshot));
+        http_end_header(request);
+
+        request->cgi_data = response;
+        return HTTP_CGI_MORE;
+    }
+
+    uint8_t buf[SCREENSHOT_MIN_LEN];
+    const uint16_t n = screenshot_read(&response->screenshot, buf, sizeof(buf));
+
+    if(n > 0) {
+        http_write_bytes(request, (const char *) buf, n);
+        return HTTP_CGI_MORE;
+    }
+
+    http_end_body(request);
+
+    free(response);
+    request->cgi_data = NULL;
+
+    return HTTP_CGI_DONE;
+}
+
+enum http_cgi_state cgi_screenshot_pbm(struct http_request* request)
+{
+    return cgi_screenshot(request, SCREENSHOT_PBM);
+}
+
+enum http_cgi_state cgi_screenshot_png(struct http_request* request)
+{
+    return cgi_screenshot(request, SCREENSHOT_PNG);
+}
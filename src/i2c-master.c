@@ -85,6 +85,8 @@ void IRAM_ATTR i2c_master_init(void)
     ETS_GPIO_INTR_ENABLE();
 }
 
+uint32_t i2c_byte_count;
+
 uint8_t IRAM_ATTR i2c_start(uint8_t address, uint8_t rw)
 {
     i2c_sda_high();
@@ -187,6 +189,8 @@ uint8_t IRAM_ATTR i2c_write_byte(uint8_t data)
         data <<= 1;
     }
 
+    i2c_byte_count++;
+
     return i2c_read_ack();
 }
 
@@ -203,6 +207,8 @@ uint8_t IRAM_ATTR i2c_read_byte(uint8_t ack)
     i2c_sda_output();
     i2c_write_ack(ack);
 
+    i2c_byte_count++;
+
     return data;
 }
 
@@ -227,6 +233,8 @@ uint8_t IRAM_ATTR i2c_write_byte_lsb_first(uint8_t data)
         data >>= 1;
     }
 
+    i2c_byte_count++;
+
     return i2c_read_ack();
 }
 
@@ -16,6 +16,9 @@
 
 void i2c_master_init(void);
 
+// Bytes written or read since boot, including addresses
+extern uint32_t i2c_byte_count;
+
 uint8_t i2c_start(uint8_t address, uint8_t rw);
 void i2c_stop(void);
 
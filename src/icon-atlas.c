@@ -0,0 +1,122 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include "icon-atlas.h"
+
+#include "log.h"
+#define LOG_SYS LOG_SYS_DISPLAY
+
+// Upper bound on the size of an atlas, to reject garbage before allocating
+#define ICON_ATLAS_MAX_SIZE 16384
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+struct icon_atlas *icon_atlas_load(const char *filename)
+{
+    uint8_t header[ICON_ATLAS_HEADER_LEN];
+
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) {
+        LOG("File '%s' not found", filename);
+        return 0;
+    }
+
+    if((read(fd, header, sizeof(header)) != sizeof(header)) || memcmp(header, ICON_ATLAS_MAGIC, 4)) {
+        WARNING("'%s' is not an icon atlas", filename);
+        close(fd);
+        return 0;
+    }
+
+    const uint16_t num_icons = get_u16(&header[4]);
+    const uint32_t size = get_u32(&header[8]);
+
+    if((size < ICON_ATLAS_HEADER_LEN + num_icons * ICON_ATLAS_ENTRY_LEN) || (size > ICON_ATLAS_MAX_SIZE)) {
+        WARNING("Icon atlas '%s' has a bad size %u", filename, size);
+        close(fd);
+        return 0;
+    }
+
+    // The atlas, the icons and the names all point into one allocation,
+    // which holds the contents of the file at the end
+    const uint32_t table_len = sizeof(struct icon_atlas) + num_icons * (sizeof(struct icon) + sizeof(char *));
+    uint8_t *block = malloc(table_len + size);
+
+    if(!block) {
+        ERROR("Could not allocate %u bytes for icon atlas", table_len + size);
+        close(fd);
+        return 0;
+    }
+
+    struct icon_atlas *atlas = (struct icon_atlas *)block;
+    uint8_t *file = block + table_len;
+
+    atlas->num_icons = num_icons;
+    atlas->icons = (struct icon *)(atlas + 1);
+    atlas->names = (const char **)(atlas->icons + num_icons);
+
+    memcpy(file, header, sizeof(header));
+
+    const int len = read(fd, file + sizeof(header), size - sizeof(header));
+
+    close(fd);
+
+    if(len != size - sizeof(header)) {
+        WARNING("Icon atlas '%s' is truncated", filename);
+        free(block);
+        return 0;
+    }
+
+    for(uint16_t i = 0; i < num_icons; i++) {
+        const uint8_t *entry = file + ICON_ATLAS_HEADER_LEN + i * ICON_ATLAS_ENTRY_LEN;
+        const uint16_t width = get_u16(&entry[ICON_ATLAS_NAME_LEN]);
+        const uint16_t height = get_u16(&entry[ICON_ATLAS_NAME_LEN + 2]);
+        const uint32_t offset = get_u32(&entry[ICON_ATLAS_NAME_LEN + 4]);
+        const uint32_t data_len = width * (1 + (height - 1) / 8);
+
+        if(!memchr(entry, 0, ICON_ATLAS_NAME_LEN) || !width || !height || (offset > size) || (data_len > size - offset)) {
+            WARNING("Icon %d in atlas '%s' is malformed", i, filename);
+            free(block);
+            return 0;
+        }
+
+        atlas->names[i] = (const char *)entry;
+        atlas->icons[i] = (struct icon) { .width = width, .height = height, .data = file + offset };
+    }
+
+    INFO("Loaded %d icons from '%s'", num_icons, filename);
+
+    return atlas;
+}
+
+void icon_atlas_free(struct icon_atlas *atlas)
+{
+    free(atlas);
+}
+
+const struct icon *icon_atlas_get(const struct icon_atlas *atlas, const char *name)
+{
+    if(!atlas) {
+        return 0;
+    }
+
+    for(uint16_t i = 0; i < atlas->num_icons; i++) {
+        if(!strcmp(atlas->names[i], name)) {
+            return &atlas->icons[i];
+        }
+    }
+
+    return 0;
+}
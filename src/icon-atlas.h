@@ -0,0 +1,43 @@
+#ifndef ICON_ATLAS_H_
+#define ICON_ATLAS_H_
+
+#include <stdint.h>
+
+#include "framebuffer.h"
+
+// An icon atlas is a single file holding several icons, so that a set of
+// icons is loaded with one open and one allocation. All numbers are little
+// endian.
+//
+//   0  "ICAT"
+//   4  u16 number of icons
+//   6  u16 reserved, 0
+//   8  u32 size of the file
+//  12  one entry per icon:
+//        0  name, NUL terminated, e.g. "/icons/bus.pbm"
+//       24  u16 width
+//       26  u16 height
+//       28  u32 offset of the icon data from the start of the file
+//
+// The icon data is in the fb_blit layout. Atlases are made with
+// utils/pbm-to-c -a.
+
+#define ICON_ATLAS_MAGIC "ICAT"
+#define ICON_ATLAS_HEADER_LEN 12
+#define ICON_ATLAS_ENTRY_LEN 32
+#define ICON_ATLAS_NAME_LEN 24
+
+struct icon_atlas
+{
+    uint16_t num_icons;
+    const char **names;
+    struct icon *icons;
+};
+
+// Returns 0 if the file is missing or malformed
+struct icon_atlas *icon_atlas_load(const char *filename);
+void icon_atlas_free(struct icon_atlas *atlas);
+
+const struct icon *icon_atlas_get(const struct icon_atlas *atlas, const char *name);
+
+#endif
@@ -0,0 +1,131 @@
+// Generated by utils/pbm-to-c from the icons in data. Do not edit.
+
+#include <stdint.h>
+
+#include "framebuffer.h"
+#include "icons.h"
+
+static const uint8_t icons_boat_data[] = {
+    0x00, 0x00, 0x08, 0x00, 0x00, 0x08, 0x00, 0x00, 0x04, 0x00, 0x00, 0x02, 0x00, 0x00, 0x04, 0x00,
+    0x60, 0x08, 0x00, 0xA0, 0x09, 0x00, 0x20, 0x0A, 0xF0, 0x1F, 0x04, 0x08, 0x10, 0x02, 0xE8, 0x13,
+    0x04, 0x28, 0x0A, 0x08, 0x28, 0x08, 0x08, 0x28, 0x04, 0x08, 0x2E, 0x04, 0x04, 0x29, 0x02, 0x02,
+    0x2E, 0x04, 0x04, 0x28, 0x04, 0x08, 0x28, 0x08, 0x08, 0x28, 0x0A, 0x08, 0xE8, 0x13, 0x04, 0x08,
+    0x10, 0x02, 0xF0, 0x1F, 0x04, 0x00, 0x20, 0x0A, 0x00, 0xA0, 0x09, 0x00, 0x60, 0x08, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x02, 0x00, 0x00, 0x04, 0x00, 0x00, 0x08, 0x00, 0x00, 0x08,
+};
+
+static const uint8_t icons_bus_data[] = {
+    0x00, 0x04, 0xFC, 0x0F, 0x02, 0x10, 0x79, 0x10, 0x45, 0x10, 0x45, 0x00, 0x7D, 0x18, 0x01, 0x24,
+    0x01, 0x42, 0x7D, 0x42, 0x45, 0x24, 0x45, 0x18, 0x7D, 0x00, 0x01, 0x10, 0x01, 0x10, 0x7D, 0x10,
+    0x45, 0x10, 0x45, 0x10, 0x7D, 0x10, 0x01, 0x10, 0x01, 0x10, 0x7D, 0x00, 0x45, 0x18, 0x45, 0x24,
+    0x7D, 0x42, 0x01, 0x42, 0x01, 0x24, 0xFD, 0x18, 0x05, 0x01, 0x05, 0x12, 0xF9, 0x13, 0x02, 0x10,
+    0xFC, 0x0F,
+};
+
+static const uint8_t icons_clock_data[] = {
+    0x06, 0x00, 0x00, 0x89, 0x0F, 0x06, 0x61, 0x30, 0x09, 0x12, 0x47, 0x08, 0xC8, 0x98, 0x08, 0x24,
+    0x20, 0x05, 0x14, 0x40, 0x01, 0x12, 0x40, 0x02, 0x0A, 0x80, 0x02, 0xCB, 0x83, 0x02, 0x0A, 0x84,
+    0x02, 0x12, 0x48, 0x02, 0x14, 0x40, 0x01, 0x24, 0x20, 0x05, 0xC8, 0x98, 0x08, 0x12, 0x47, 0x08,
+    0x61, 0x30, 0x09, 0x89, 0x0F, 0x06, 0x06, 0x00, 0x00,
+};
+
+static const uint8_t icons_noclock_data[] = {
+    0x06, 0x00, 0x00, 0x89, 0x0F, 0x06, 0x61, 0x30, 0x09, 0x12, 0x40, 0x08, 0x08, 0x80, 0x08, 0x04,
+    0x00, 0x05, 0x04, 0x00, 0x01, 0x22, 0x0E, 0x02, 0x12, 0x11, 0x02, 0x13, 0x51, 0x02, 0x12, 0x11,
+    0x02, 0xE2, 0x08, 0x02, 0x04, 0x00, 0x01, 0x04, 0x00, 0x05, 0x08, 0x80, 0x08, 0x12, 0x40, 0x08,
+    0x61, 0x30, 0x09, 0x89, 0x0F, 0x06, 0x06, 0x00, 0x00,
+};
+
+static const uint8_t icons_nowifi1_data[] = {
+    0x06, 0x00, 0x00, 0x89, 0x0F, 0x06, 0x61, 0x30, 0x09, 0x12, 0x40, 0x08, 0x08, 0x80, 0x08, 0x04,
+    0x00, 0x05, 0x04, 0x00, 0x01, 0x02, 0x00, 0x02, 0x02, 0x00, 0x02, 0x03, 0x40, 0x02, 0x02, 0x00,
+    0x02, 0x02, 0x00, 0x02, 0x04, 0x00, 0x01, 0x04, 0x00, 0x05, 0x08, 0x80, 0x08, 0x12, 0x40, 0x08,
+    0x61, 0x30, 0x09, 0x89, 0x0F, 0x06, 0x06, 0x00, 0x00,
+};
+
+static const uint8_t icons_nowifi2_data[] = {
+    0x06, 0x00, 0x00, 0x89, 0x0F, 0x06, 0x61, 0x30, 0x09, 0x12, 0x40, 0x08, 0x08, 0x80, 0x08, 0x04,
+    0x00, 0x05, 0x04, 0x00, 0x01, 0x02, 0x10, 0x02, 0x02, 0x08, 0x02, 0x03, 0x48, 0x02, 0x02, 0x08,
+    0x02, 0x02, 0x10, 0x02, 0x04, 0x00, 0x01, 0x04, 0x00, 0x05, 0x08, 0x80, 0x08, 0x12, 0x40, 0x08,
+    0x61, 0x30, 0x09, 0x89, 0x0F, 0x06, 0x06, 0x00, 0x00,
+};
+
+static const uint8_t icons_nowifi3_data[] = {
+    0x06, 0x00, 0x00, 0x89, 0x0F, 0x06, 0x61, 0x30, 0x09, 0x12, 0x40, 0x08, 0x08, 0x80, 0x08, 0x04,
+    0x00, 0x05, 0x04, 0x02, 0x01, 0x02, 0x11, 0x02, 0x02, 0x09, 0x02, 0x03, 0x49, 0x02, 0x02, 0x09,
+    0x02, 0x02, 0x11, 0x02, 0x04, 0x02, 0x01, 0x04, 0x00, 0x05, 0x08, 0x80, 0x08, 0x12, 0x40, 0x08,
+    0x61, 0x30, 0x09, 0x89, 0x0F, 0x06, 0x06, 0x00, 0x00,
+};
+
+static const uint8_t icons_nowifi4_data[] = {
+    0x06, 0x00, 0x00, 0x89, 0x0F, 0x06, 0x61, 0x30, 0x09, 0x12, 0x40, 0x08, 0x08, 0x80, 0x08, 0x44,
+    0x00, 0x05, 0x24, 0x02, 0x01, 0x22, 0x11, 0x02, 0x22, 0x09, 0x02, 0x23, 0x49, 0x02, 0x22, 0x09,
+    0x02, 0x22, 0x11, 0x02, 0x24, 0x02, 0x01, 0x44, 0x00, 0x05, 0x08, 0x80, 0x08, 0x12, 0x40, 0x08,
+    0x61, 0x30, 0x09, 0x89, 0x0F, 0x06, 0x06, 0x00, 0x00,
+};
+
+static const uint8_t icons_subway_data[] = {
+    0xF8, 0xFF, 0x04, 0x00, 0x02, 0x00, 0xE1, 0x1F, 0x11, 0x90, 0xC9, 0x55, 0x29, 0x35, 0x29, 0x11,
+    0x29, 0x11, 0x29, 0x11, 0x29, 0x35, 0xC9, 0x55, 0x11, 0x90, 0xE1, 0x1F, 0x02, 0x00, 0x04, 0x00,
+    0xF8, 0xFF,
+};
+
+static const uint8_t icons_train_data[] = {
+    0x70, 0x00, 0x03, 0x90, 0xFF, 0x04, 0x10, 0x00, 0x05, 0x90, 0x07, 0x00, 0x50, 0x08, 0x06, 0x50,
+    0x08, 0x09, 0x50, 0x08, 0x09, 0x50, 0x08, 0x06, 0x50, 0x08, 0x00, 0x90, 0x07, 0x05, 0x10, 0x00,
+    0x05, 0xF2, 0x7D, 0x00, 0x05, 0x02, 0x06, 0x05, 0x02, 0x09, 0x05, 0x02, 0x09, 0x02, 0x02, 0x06,
+    0x00, 0x02, 0x00, 0x08, 0x02, 0x05, 0x88, 0x03, 0x05, 0xA0, 0x02, 0x00, 0x80, 0x02, 0x06, 0x80,
+    0x03, 0x09, 0x00, 0x02, 0x09, 0x00, 0x02, 0x06, 0x00, 0x04, 0x00, 0x00, 0x04, 0x05, 0x00, 0x08,
+    0x05, 0x00, 0xF0, 0x04, 0x00, 0x00, 0x05, 0x00, 0x00, 0x06,
+};
+
+static const uint8_t icons_tram_data[] = {
+    0xC0, 0xFF, 0x00, 0x20, 0x00, 0x01, 0x10, 0x00, 0x01, 0x90, 0x7F, 0x03, 0x52, 0x40, 0x05, 0x55,
+    0x40, 0x05, 0xD5, 0x7F, 0x03, 0x19, 0x00, 0x01, 0x15, 0x00, 0x03, 0xD5, 0x07, 0x05, 0x52, 0x04,
+    0x05, 0x50, 0x04, 0x03, 0xD0, 0x07, 0x01, 0x10, 0x00, 0x01, 0x10, 0x00, 0x01, 0xD0, 0x07, 0x01,
+    0x50, 0x04, 0x01, 0x50, 0x04, 0x01, 0xD0, 0x07, 0x01, 0x10, 0x00, 0x01, 0x10, 0x00, 0x01, 0xD0,
+    0x07, 0x03, 0x52, 0x04, 0x05, 0x55, 0x04, 0x05, 0xD5, 0x07, 0x03, 0x19, 0x00, 0x01, 0x15, 0x00,
+    0x03, 0xD5, 0x7F, 0x05, 0x52, 0x40, 0x05, 0x50, 0x40, 0x03, 0x90, 0x7F, 0x01, 0x20, 0x00, 0x01,
+    0xC0, 0xFF, 0x00,
+};
+
+static const uint8_t icons_small_boat_data[] = {
+    0x40, 0xD8, 0xD4, 0xD2, 0xD1, 0xFF, 0xC0, 0xC0, 0x40,
+};
+
+static const uint8_t icons_small_bus_data[] = {
+    0x3C, 0x62, 0x6A, 0x22, 0x2A, 0x22, 0x6A, 0x62, 0x3C,
+};
+
+static const uint8_t icons_small_subway_data[] = {
+    0xFE, 0x01, 0x01, 0x59, 0x19, 0x59, 0x01, 0x01, 0xFE,
+};
+
+static const uint8_t icons_small_train_data[] = {
+    0x7F, 0x81, 0x81, 0x41, 0x4E, 0x48, 0x8E, 0x88, 0x70,
+};
+
+static const uint8_t icons_small_tram_data[] = {
+    0x70, 0xCA, 0xCC, 0x48, 0x48, 0x4A, 0xCC, 0xC8, 0x70,
+};
+
+const struct icon_entry icon_table[] = {
+    { "/icons/boat.pbm", { .width = 31, .height = 20, .data = icons_boat_data } },
+    { "/icons/bus.pbm", { .width = 33, .height = 15, .data = icons_bus_data } },
+    { "/icons/clock.pbm", { .width = 19, .height = 20, .data = icons_clock_data } },
+    { "/icons/noclock.pbm", { .width = 19, .height = 20, .data = icons_noclock_data } },
+    { "/icons/nowifi1.pbm", { .width = 19, .height = 20, .data = icons_nowifi1_data } },
+    { "/icons/nowifi2.pbm", { .width = 19, .height = 20, .data = icons_nowifi2_data } },
+    { "/icons/nowifi3.pbm", { .width = 19, .height = 20, .data = icons_nowifi3_data } },
+    { "/icons/nowifi4.pbm", { .width = 19, .height = 20, .data = icons_nowifi4_data } },
+    { "/icons/subway.pbm", { .width = 17, .height = 16, .data = icons_subway_data } },
+    { "/icons/train.pbm", { .width = 30, .height = 20, .data = icons_train_data } },
+    { "/icons/tram.pbm", { .width = 33, .height = 19, .data = icons_tram_data } },
+    { "/icons-small/boat.pbm", { .width = 9, .height = 8, .data = icons_small_boat_data } },
+    { "/icons-small/bus.pbm", { .width = 9, .height = 8, .data = icons_small_bus_data } },
+    { "/icons-small/subway.pbm", { .width = 9, .height = 8, .data = icons_small_subway_data } },
+    { "/icons-small/train.pbm", { .width = 9, .height = 8, .data = icons_small_train_data } },
+    { "/icons-small/tram.pbm", { .width = 9, .height = 8, .data = icons_small_tram_data } },
+};
+
+const uint16_t icon_table_len = sizeof(icon_table) / sizeof(icon_table[0]);
@@ -0,0 +1,42 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "icons.h"
+#include "icon-atlas.h"
+#include "framebuffer.h"
+
+#include "log.h"
+#define LOG_SYS LOG_SYS_DISPLAY
+
+static struct icon_atlas *custom_icons;
+static uint8_t custom_icons_loaded;
+
+const struct icon *icon_get(const char *name)
+{
+    const struct icon *icon;
+
+    // The atlas is opened once, on the first lookup
+    if(!custom_icons_loaded) {
+        custom_icons = icon_atlas_load(ICON_ATLAS_FILE);
+        custom_icons_loaded = 1;
+    }
+
+    if((icon = icon_atlas_get(custom_icons, name))) {
+        return icon;
+    }
+
+    for(uint16_t i = 0; i < icon_table_len; i++) {
+        if(!strcmp(icon_table[i].name, name)) {
+            return &icon_table[i].icon;
+        }
+    }
+
+    // Icons that are not built in may still be on SPIFFS as plain PBM files
+    if((icon = fb_load_icon_pbm(name))) {
+        return icon;
+    }
+
+    WARNING("Icon %s not found", name);
+    return 0;
+}
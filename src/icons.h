@@ -0,0 +1,29 @@
+#ifndef ICONS_H_
+#define ICONS_H_
+
+#include <stdint.h>
+
+#include "framebuffer.h"
+
+// The icons in data/icons and data/icons-small are compiled into the firmware
+// by utils/pbm-to-c, see the icons target of the Makefile. Icons can be
+// replaced without reflashing by putting an icon atlas with the same names
+// on SPIFFS as ICON_ATLAS_FILE, see the icon-atlas target of the Makefile.
+
+#define ICON_ATLAS_FILE "/custom/icons.atlas"
+
+struct icon_entry
+{
+    const char *name;
+    struct icon icon;
+};
+
+extern const struct icon_entry icon_table[];
+extern const uint16_t icon_table_len;
+
+// Look up an icon by its name in the SPIFFS image, e.g. "/icons/bus.pbm",
+// first in the custom atlas, then among the built in icons and last as a PBM
+// file on SPIFFS. Returns 0 if there is no such icon.
+const struct icon *icon_get(const char *name);
+
+#endif
@@ -10,6 +10,8 @@
 #include "status.h"
 #include "http-sm/http.h"
 #include "log.h"
+#include "status-cache.h"
+#include "display.h"
 
 #define LOG_SYS LOG_SYS_JOURNEY
 
@@ -26,6 +28,9 @@ void journey_set_journey(uint8_t num, const struct journey *jour)
 
         journies[num].next_update = time(0);
         journies[num].timeout = JOURNEY_ERROR_INTERVAL;
+
+        status_cache_invalidate(STATUS_SECTION_JOURNIES);
+        display_wake();
     } else {
         WARNING("Trying to set journey #%d!", num);
     }
@@ -126,6 +131,9 @@ void journey_task(void *pvParameters)
                     for(int i = 0; i < JOURNEY_MAX_DEPARTURES - 1; i++) {
                         journey->departures[i] = journey->departures[i+1];
                     }
+
+                    status_cache_invalidate(STATUS_SECTION_JOURNIES);
+                    display_wake();
                 }
             } else {
                 LOG("Updating journey %d", j);
@@ -159,6 +167,9 @@ void journey_task(void *pvParameters)
                 strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&journey->next_update));
                 LOG("Next update at %s", buf);
                 printf("\n");
+
+                status_cache_invalidate(STATUS_SECTION_JOURNIES);
+                display_wake();
             }
         }
     }
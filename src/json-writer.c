@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "json-writer.h"
 
 static int file_write_string(FILE *f, const char *s)
@@ -5,6 +7,28 @@ static int file_write_string(FILE *f, const char *s)
     return fputs(s, f);
 }
 
+static int count_write_string(int *count, const char *s)
+{
+    int n = strlen(s);
+    *count += n;
+    return n;
+}
+
+static int buffer_write_string(struct json_writer_buffer *buffer, const char *s)
+{
+    int n = strlen(s);
+
+    if(n > buffer->len - buffer->pos) {
+        buffer->overflow += n - (buffer->len - buffer->pos);
+        n = buffer->len - buffer->pos;
+    }
+
+    memcpy(buffer->buf + buffer->pos, s, n);
+    buffer->pos += n;
+
+    return n;
+}
+
 void json_writer_http_init(struct json_writer *json, struct http_request *request)
 {
     json->user = request;
@@ -19,6 +43,28 @@ void json_writer_file_init(struct json_writer *json, FILE *f)
     json->write_string = (json_writer_io) file_write_string;
 }
 
+// Nothing is written, the number of bytes that would have been written is
+// added to *count. Useful to size a response before streaming it.
+void json_writer_count_init(struct json_writer *json, int *count)
+{
+    json->user = count;
+    json->current = 0;
+    json->write_string = (json_writer_io) count_write_string;
+}
+
+// Write into buf, which is not NUL terminated. See struct json_writer_buffer.
+void json_writer_buffer_init(struct json_writer *json, struct json_writer_buffer *buffer, char *buf, int len)
+{
+    buffer->buf = buf;
+    buffer->len = len;
+    buffer->pos = 0;
+    buffer->overflow = 0;
+
+    json->user = buffer;
+    json->current = 0;
+    json->write_string = (json_writer_io) buffer_write_string;
+}
+
 static inline int write_string(struct json_writer *json, const char *s)
 {
     return json->write_string(json->user, s);
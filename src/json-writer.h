@@ -19,8 +19,19 @@ struct json_writer {
     json_writer_io write_string;
 };
 
+// Output of json_writer_buffer_init. Bytes which do not fit in buf are
+// counted in overflow, so that the caller can retry with a larger buffer.
+struct json_writer_buffer {
+    char *buf;
+    int len;
+    int pos;
+    int overflow;
+};
+
 void json_writer_http_init(struct json_writer *json, struct http_request *request);
 void json_writer_file_init(struct json_writer *json, FILE *f);
+void json_writer_count_init(struct json_writer *json, int *count);
+void json_writer_buffer_init(struct json_writer *json, struct json_writer_buffer *buffer, char *buf, int len);
 
 void json_writer_begin_object(struct json_writer *json, const char *name);
 void json_writer_end_object(struct json_writer *json);
@@ -0,0 +1,36 @@
+#include <esp_common.h>
+#include <freertos/semphr.h>
+
+#include "log.h"
+
+// Given when a message is logged, and taken by a reader waiting for one. A
+// message logged while no one waits wakes the next reader early, which then
+// only finds nothing new and waits again.
+static xSemaphoreHandle log_cbuf_added = NULL;
+
+void log_cbuf_wait(uint32_t timeout_ms)
+{
+    portTickType ticks = timeout_ms / portTICK_RATE_MS;
+
+    // Always give up the CPU for at least a tick
+    if(ticks == 0) {
+        ticks = 1;
+    }
+
+    if(log_cbuf_added == NULL) {
+        vSemaphoreCreateBinary(log_cbuf_added);
+    }
+
+    if(log_cbuf_added == NULL) {
+        vTaskDelay(ticks);
+    } else {
+        xSemaphoreTake(log_cbuf_added, ticks);
+    }
+}
+
+void log_cbuf_wake(void)
+{
+    if(log_cbuf_added != NULL) {
+        xSemaphoreGive(log_cbuf_added);
+    }
+}
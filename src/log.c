@@ -56,16 +56,76 @@ struct log_cbuf log_cbuf;
 
 void log_cbuf_writer(enum log_level level, enum log_system system, const char *msg)
 {
-    log_cbuf.message[log_cbuf.head].level = level;
-    log_cbuf.message[log_cbuf.head].system = system;
-    log_cbuf.message[log_cbuf.head].timestamp = time(0);
-    strncpy(log_cbuf.message[log_cbuf.head].message, msg, LOG_CBUF_STRLEN);
+    uint32_t seq = log_cbuf.seq + 1;
+    struct log_cbuf_message *message = &log_cbuf.message[(seq - 1) % LOG_CBUF_LEN];
 
-    log_cbuf.head = (log_cbuf.head + 1) % LOG_CBUF_LEN;
+    // Mark the slot as being written, so that log_cbuf_next does not return
+    // a half-written message
+    message->seq = 0;
+
+    message->level = level;
+    message->system = system;
+    message->timestamp = time(0);
+    strncpy(message->message, msg, LOG_CBUF_STRLEN);
+
+    message->seq = seq;
+    log_cbuf.seq = seq;
+
+    log_cbuf.head = seq % LOG_CBUF_LEN;
 
     if(log_cbuf.head == log_cbuf.tail) {
         log_cbuf.tail = (log_cbuf.tail + 1) % LOG_CBUF_LEN;
     }
+
+    log_cbuf_wake();
+}
+
+// Find the first message with a sequence number in (since, until] with at
+// most the given level, from the given system or from any system if system is
+// LOG_SYS_ALL. The message is copied to *msg and its sequence number is
+// returned. If there is no such message 0 is returned.
+uint32_t log_cbuf_next(uint32_t since, uint32_t until, enum log_level level, enum log_system system, struct log_cbuf_message *msg)
+{
+    uint32_t seq = since + 1;
+
+    // Skip messages which have already been overwritten
+    if((until >= LOG_CBUF_LEN) && (seq <= until - LOG_CBUF_LEN)) {
+        seq = until - LOG_CBUF_LEN + 1;
+    }
+
+    for(; seq <= until; seq++) {
+        const struct log_cbuf_message *message = &log_cbuf.message[(seq - 1) % LOG_CBUF_LEN];
+
+        if(message->seq != seq) {
+            continue;
+        }
+
+        if((message->level > level) || ((system != LOG_SYS_ALL) && (message->system != system))) {
+            continue;
+        }
+
+        memcpy(msg, message, sizeof(*msg));
+
+        // The message might have been overwritten while we copied it
+        if(message->seq == seq) {
+            return seq;
+        }
+    }
+
+    return 0;
+}
+
+int log_cbuf_poll(uint32_t since, enum log_level level, enum log_system system, uint32_t timeout_ms)
+{
+    struct log_cbuf_message msg;
+
+    if(log_cbuf_next(since, log_cbuf.seq, level, system, &msg)) {
+        return 1;
+    }
+
+    log_cbuf_wait(timeout_ms);
+
+    return log_cbuf_next(since, log_cbuf.seq, level, system, &msg) != 0;
 }
 
 void log_string(enum log_level level, enum log_system system, const char *msg)
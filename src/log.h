@@ -71,6 +71,7 @@ enum log_level log_get_level(uint8_t dests, enum log_system system);
 #define LOG_CBUF_STRLEN 80
 
 struct log_cbuf_message {
+    uint32_t seq;
     time_t timestamp;
     enum log_level level;
     enum log_system system;
@@ -78,13 +79,32 @@ struct log_cbuf_message {
     char zero;
 };
 
+// Every message in the circular buffer gets a sequence number, starting at
+// 1. The message with sequence number seq is stored at index
+// (seq - 1) % LOG_CBUF_LEN, and seq is the number of the latest message.
 struct log_cbuf {
     uint8_t head;
     uint8_t tail;
+    volatile uint32_t seq;
     struct log_cbuf_message message[LOG_CBUF_LEN];
 };
 
 extern struct log_cbuf log_cbuf;
+
+uint32_t log_cbuf_next(uint32_t since, uint32_t until, enum log_level level, enum log_system system, struct log_cbuf_message *msg);
+
+// Wait for up to timeout_ms for a message newer than since, with the same
+// filter as log_cbuf_next. Returns 1 if there is one. The caller is blocked
+// in log_cbuf_wait meanwhile, so that polling for messages gives up the CPU.
+int log_cbuf_poll(uint32_t since, enum log_level level, enum log_system system, uint32_t timeout_ms);
+
+// Block for up to timeout_ms, or until log_cbuf_wake is called. Given by the
+// platform, see log-wait.c.
+void log_cbuf_wait(uint32_t timeout_ms);
+
+// Called for each message added to the circular buffer
+void log_cbuf_wake(void);
+
 extern const char* log_system_names[LOG_NUM_SYSTEMS];
 extern const char* log_level_names[LOG_NUM_LEVELS];
 
@@ -1,5 +1,4 @@
 #include <string.h>
-#include <time.h>
 #include <esp_common.h>
 #include <freertos/semphr.h>
 
@@ -7,12 +6,9 @@
 #include "display.h"
 #include "matrix_framebuffer.h"
 #include "matrix_display.h"
-#include "fonts.h"
-#include "journey.h"
-#include "status.h"
+#include "display-driver.h"
+#include "display-stats.h"
 #include "log.h"
-#include "http-sm/http.h"
-#include "http-sm/websocket.h"
 
 #include "../avr/avr-i2c-led-matrix.h"
 
@@ -20,116 +16,6 @@
 
 #define vTaskDelayMs(ms)	vTaskDelay((ms)/portTICK_RATE_MS)
 
-#define STATE_DISPLAY 0
-#define STATE_SHIFT_OUT 1
-#define STATE_SHIFT_IN 2
-#define STATE_NO_DISPLAY 3
-
-#define Y_CLOCK 7
-#define Y_JOURNEY_1 19
-#define Y_JOURNEY_2 28
-
-#define X_ICON 1
-#define X_TIME 12
-
-extern struct websocket_connection *ws_display_conn;
-
-static int16_t journey_shift[2];
-
-static struct icon *journey_icons[6];
-
-struct animation
-{
-    int16_t *variable;
-    portTickType start_tick;
-    int16_t start;
-    int16_t end;
-    uint8_t tick_rate_shift;
-};
-
-struct journey_display_state
-{
-    time_t current;
-    time_t next;
-    int16_t shift;
-    uint8_t state;
-    uint8_t y;
-
-    struct animation anim;
-};
-
-
-static struct animation journey_1_shift_out = { .variable = &journey_shift[0], .start = 0, .end = 32, .tick_rate_shift = 4 };
-static struct animation journey_1_shift_in = { .variable = &journey_shift[0], .start = 32, .end = 0, .tick_rate_shift = 4 };
-
-static struct journey_display_state journey_display_states[2] = { { .y = Y_JOURNEY_1 }, { .y = Y_JOURNEY_2 } };
-
-
-static void animation_start(struct animation *anim)
-{
-    anim->start_tick = xTaskGetTickCount();
-    *anim->variable = anim->start;
-}
-
-static int animation_run(struct animation *anim)
-{
-    if(anim->start < anim->end) {
-        *anim->variable = anim->start + (xTaskGetTickCount() - anim->start_tick) / anim->tick_rate_shift;
-        if(*anim->variable >= anim->end) {
-            *anim->variable = anim->end;
-            return 1;
-        }
-    } else {
-        *anim->variable = anim->start - (xTaskGetTickCount() - anim->start_tick) / anim->tick_rate_shift;
-        if(*anim->variable <= anim->end) {
-            *anim->variable = anim->end;
-            return 1;
-        }
-    }
-    return 0;
-}
-
-static uint8_t animation_running;
-
-static void update_journey_display_state(struct journey_display_state *state, const time_t *next)
-{
-    switch(state->state)
-    {
-    case STATE_DISPLAY:
-        if(*next != state->current) {
-            LOG("current = %ld, next = %ld", state->current, *next);
-            state->state = STATE_SHIFT_OUT;
-            state->next = *next;
-            state->anim.variable = &state->shift;
-            state->anim.start = 0;
-            state->anim.end = 32;
-            state->anim.tick_rate_shift = 4;
-
-            animation_start(&state->anim);
-            animation_running++;
-        }
-        break;
-
-    case STATE_SHIFT_OUT:
-        if(animation_run(&state->anim)) {
-            state->state = STATE_SHIFT_IN;
-            state->current = state->next;
-            state->anim.start = 32;
-            state->anim.end = 0;
-
-            animation_start(&state->anim);
-        }
-        break;
-
-    case STATE_SHIFT_IN:
-        if(animation_run(&state->anim)) {
-            state->state = STATE_DISPLAY;
-            animation_running--;
-        }
-    }
-}
-
-
 uint16_t matrix_intensity_low[AVR_I2C_NUM_LEVELS] = { 0, 8, 16, 32, 64, 128, 256, 512 };
 uint16_t matrix_intensity_high[AVR_I2C_NUM_LEVELS] = { 12, 23, 46, 91, 182, 363, 725, 1023 };
 uint8_t matrix_intensity_override = 0;
@@ -142,12 +28,19 @@ uint8_t matrix_intensity_level;
 
 xSemaphoreHandle matrix_intensity_mutex = NULL;
 
-static void send_actual_intensity(uint8_t command, uint16_t *tab)
+// Start a write, retrying until the matrix acknowledges its address
+static void matrix_start(void)
 {
     while(i2c_start(MATRIX_I2C_ADDRESS, I2C_WRITE) != I2C_ACK) {
         LOG("No ACK");
+        display_stats_add_retry();
         vTaskDelayMs(5);
     }
+}
+
+static void send_actual_intensity(uint8_t command, uint16_t *tab)
+{
+    matrix_start();
 
     i2c_write_byte(command);
     for(int i = 0; i < AVR_I2C_NUM_LEVELS; i++) {
@@ -160,10 +53,7 @@ static void send_actual_intensity(uint8_t command, uint16_t *tab)
 
 static void send_fixed_intensity(uint8_t command, uint8_t level)
 {
-    while(i2c_start(MATRIX_I2C_ADDRESS, I2C_WRITE) != I2C_ACK) {
-        LOG("No ACK");
-        vTaskDelayMs(5);
-    }
+    matrix_start();
 
     i2c_write_byte(command);
     for(int i = 0; i < level; i++) {
@@ -219,87 +109,109 @@ static void read_intensity(void)
     i2c_stop();
 }
 
-void matrix_display_main(void)
-{
-    matrix_init();
+// The last frame sent to the matrix
+static uint8_t sent_frame[MATRIX_SIZE];
+static uint8_t sent_frame_valid = 0;
 
-    matrix_intensity_mutex = xSemaphoreCreateMutex();
+#if MATRIX_SIZE <= 255
 
-    fb_blit = matrix_blit;
+// Frames which fit in AVR_I2C_CMD_FRAMEBUFFER are sent whole with it, so that
+// matrices with AVR firmware from before AVR_I2C_CMD_FRAMEBUFFER_CHUNK keep
+// working. The AVR can only be reflashed over ISP.
+static int send_changes(const uint8_t *frame)
+{
+    if(sent_frame_valid && !memcmp(sent_frame, frame, MATRIX_SIZE)) {
+        return 0;
+    }
 
-    journey_icons[TRANSPORT_MODE_UNKNOWN] = 0;
-    journey_icons[TRANSPORT_MODE_BUS] = fb_load_icon_pbm("/icons-small/bus.pbm");
-    journey_icons[TRANSPORT_MODE_METRO] = fb_load_icon_pbm("/icons-small/subway.pbm");
-    journey_icons[TRANSPORT_MODE_TRAIN] = fb_load_icon_pbm("/icons-small/train.pbm");
-    journey_icons[TRANSPORT_MODE_TRAM] = fb_load_icon_pbm("/icons-small/tram.pbm");
-    journey_icons[TRANSPORT_MODE_SHIP] = fb_load_icon_pbm("/icons-small/boat.pbm");
+    matrix_start();
 
-    int anim = 0;
-    animation_start(&journey_1_shift_out);
+    i2c_write_byte(AVR_I2C_CMD_FRAMEBUFFER);
+    i2c_write_lsb_first(frame, MATRIX_SIZE);
+    i2c_stop();
 
-    char buf[6];
-    for(;;) {
-        matrix_clear();
+    return 1;
+}
 
-        fb_set_pen(FB_NORMAL);
+#else
 
-        time_t now = time(0);
-        time_t *t = &now;
+// Larger frames are sent in chunks of a row of modules, and only the chunks
+// that changed since the last frame. The matrix shows the new frame when it
+// gets AVR_I2C_CMD_SHOW, so the time to send a frame grows with the number of
+// rows of modules that changed. This needs AVR firmware which knows
+// AVR_I2C_CMD_FRAMEBUFFER_CHUNK.
+#define MATRIX_CHUNK_LEN (8 * (MATRIX_WIDTH / 8))
 
-        if(!(app_status.obtained_time && app_status.obtained_tz)) {
-            now = 0;
-        }
+static void send_chunk(const uint8_t *frame, uint16_t offset)
+{
+    matrix_start();
 
-        if(*t) {
-            strftime(buf, sizeof(buf), "%H:%M", localtime(t));
-            fb_draw_string(1, Y_CLOCK, buf, 0, font_6x12, FB_ALIGN_CENTER_V);
-        }
+    i2c_write_byte(AVR_I2C_CMD_FRAMEBUFFER_CHUNK);
+    i2c_write_byte(offset & 0xFF);
+    i2c_write_byte((offset >> 8) & 0xFF);
+    i2c_write_lsb_first(frame + offset, MATRIX_CHUNK_LEN);
+    i2c_stop();
+}
 
+static int send_changes(const uint8_t *frame)
+{
+    int changed = 0;
 
-        if(anim == 0) {
-            if(animation_run(&journey_1_shift_out)) {
-                animation_start(&journey_1_shift_in);
-                anim = 1;
-            }
-        } else {
-            if(animation_run(&journey_1_shift_in)) {
-                animation_start(&journey_1_shift_out);
-                anim = 0;
-            }
+    for(uint16_t offset = 0; offset < MATRIX_SIZE; offset += MATRIX_CHUNK_LEN) {
+        if(!sent_frame_valid || memcmp(sent_frame + offset, frame + offset, MATRIX_CHUNK_LEN)) {
+            send_chunk(frame, offset);
+            changed = 1;
         }
+    }
 
-        for(int i = 0; i < 2; i++) {
-            update_journey_display_state(&journey_display_states[i], &journies[i].departures[0]);
+    if(changed) {
+        matrix_start();
+        i2c_write_byte(AVR_I2C_CMD_SHOW);
+        i2c_stop();
+    }
 
-            if(journey_display_states[i].current) {
-                strftime(buf, sizeof(buf), "%H:%M", localtime(&journey_display_states[i].current));
-            } else {
-                sprintf(buf, "--:--");
-            }
-            fb_draw_string(X_TIME + journey_display_states[i].shift, journey_display_states[i].y, buf, 0, font_3x5, FB_ALIGN_CENTER_V);
-            fb_draw_icon(X_ICON + journey_display_states[i].shift, journey_display_states[i].y, journey_icons[journies[i].mode], FB_ALIGN_CENTER_V);
-        }
+    return changed;
+}
 
-        if(display_type == DISPLAY_TYPE_MATRIX) {
-            read_intensity();
-            send_intensity();
+#endif
 
-            while(i2c_start(MATRIX_I2C_ADDRESS, I2C_WRITE) != I2C_ACK) {
-                LOG("No ACK");
-                vTaskDelayMs(5);
-            }
+// Runs in the flush task, which owns the I2C bus once it has been started
+static void send_frame(const uint8_t *frame)
+{
+    read_intensity();
+    send_intensity();
 
-            i2c_write_byte(AVR_I2C_CMD_FRAMEBUFFER);
-            i2c_write_lsb_first(framebuffer, 128 );
-            i2c_stop();
-        } else if(ws_display_conn) {
-            websocket_send(ws_display_conn, framebuffer, 128, WEBSOCKET_FRAME_OPCODE_BIN | WEBSOCKET_FRAME_FIN);
+    if(send_changes(frame)) {
+        if(!sent_frame_valid) {
+            INFO("First frame shown %u ms after boot", display_time_ms());
         }
 
-        if(animation_running) {
-            vTaskDelayMs(25);
-        } else {
-            vTaskDelayMs(250);
-        }
+        memcpy(sent_frame, frame, MATRIX_SIZE);
+        sent_frame_valid = 1;
     }
 }
+
+static int matrix_driver_init(void)
+{
+    if(matrix_init() != 0) {
+        return -1;
+    }
+
+    if(matrix_intensity_mutex == NULL) {
+        matrix_intensity_mutex = xSemaphoreCreateMutex();
+    }
+
+    return 0;
+}
+
+// The intensity is sent together with the frames
+const struct display_driver matrix_driver = {
+    .name = "LED Matrix",
+    .format = { .layout = DISPLAY_CODEC_LAYOUT_ROWS, .width = MATRIX_WIDTH, .height = MATRIX_HEIGHT },
+    .init = matrix_driver_init,
+    .blit = matrix_blit,
+    .clear = matrix_clear,
+    .fill_rect = matrix_fill_rect,
+    .blit_native = matrix_blit_rows,
+    .flush = send_frame,
+};
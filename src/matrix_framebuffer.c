@@ -7,7 +7,7 @@
 
 #define LOG_SYS LOG_SYS_MATRIX
 
-static void matrix_set_pixel_row(uint8_t n, uint8_t m)
+static void matrix_set_pixel_row(uint16_t n, uint8_t m)
 {
     if(fb_current_pen == FB_NORMAL) {
         framebuffer[n] |= m;
@@ -20,7 +20,7 @@ void matrix_set_pixel(int16_t x,int16_t y)
 {
     if((0 <= x) && (x < MATRIX_WIDTH) && (0 <= y) && (y < MATRIX_HEIGHT))
     {
-        const uint8_t n = (x / 8) + (MATRIX_WIDTH / 8) * y;
+        const uint16_t n = (x / 8) + (MATRIX_WIDTH / 8) * y;
         const uint8_t m = 1 << (7 - (x % 8));
 
         matrix_set_pixel_row(n, m);
@@ -32,6 +32,55 @@ void matrix_clear(void)
     memset(framebuffer, 0, MATRIX_SIZE);
 }
 
+// Transpose an 8x8 block of glyph columns, with the top pixel in the least
+// significant bit, into matrix rows, with the leftmost pixel in the most
+// significant bit. The block is handled as two 32-bit words, see Hacker's
+// Delight, section 7-3.
+static void matrix_transpose8(const uint8_t *columns, uint8_t *rows)
+{
+    uint32_t x = ((uint32_t) columns[0] << 24) | (columns[1] << 16) | (columns[2] << 8) | columns[3];
+    uint32_t y = ((uint32_t) columns[4] << 24) | (columns[5] << 16) | (columns[6] << 8) | columns[7];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;
+    y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000CCCC;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC;
+    y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    rows[0] = y;
+    rows[1] = y >> 8;
+    rows[2] = y >> 16;
+    rows[3] = y >> 24;
+    rows[4] = x;
+    rows[5] = x >> 8;
+    rows[6] = x >> 16;
+    rows[7] = x >> 24;
+}
+
+// Draw eight pixels of row y starting at column x, where -8 < x < MATRIX_WIDTH
+static void matrix_set_pixel_byte(int16_t x, int16_t y, uint8_t m)
+{
+    const int16_t n = ((x + 8) / 8 - 1) + (MATRIX_WIDTH / 8) * y;
+    const uint8_t shift = (x + 8) % 8;
+
+    if(x >= 0) {
+        matrix_set_pixel_row(n, m >> shift);
+    }
+
+    if(shift && (x + 8 < MATRIX_WIDTH)) {
+        matrix_set_pixel_row(n + 1, m << (8 - shift));
+    }
+}
+
 void matrix_blit(int16_t x0, int16_t y0, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len)
 {
     uint8_t raster_height = 1 + ((h - 1) / 8);
@@ -41,16 +90,97 @@ void matrix_blit(int16_t x0, int16_t y0, uint16_t w, uint16_t h, const uint8_t *
         len = w * raster_height;
     }
 
-    for(int16_t x = 0; x < w; x++) {
-        for(int16_t y = 0; y < h; y++) {
-            uint8_t n = (y / 8) + x * raster_height;
-            if((n < len) && (data[n] & (1 << (y % 8)))) {
-                matrix_set_pixel(x0+x,y0+y);
+    // The part of the glyph that is on screen. x_start is rounded down to a
+    // whole block.
+    const int16_t y_start = (y0 < 0) ? -y0 : 0;
+    const int16_t y_end = (y0 + h > MATRIX_HEIGHT) ? MATRIX_HEIGHT - y0 : h;
+    const int16_t x_start = (x0 < 0) ? (-x0 & ~0x07) : 0;
+    const int16_t x_end = (x0 + w > MATRIX_WIDTH) ? MATRIX_WIDTH - x0 : w;
+
+    if((y_start >= y_end) || (x_start >= x_end)) {
+        return;
+    }
+
+    for(int16_t r = y_start / 8; r * 8 < y_end; r++) {
+        const int16_t j_start = (y_start > r * 8) ? y_start - r * 8 : 0;
+        const int16_t j_end = (y_end < r * 8 + 8) ? y_end - r * 8 : 8;
+
+        for(int16_t bx = x_start; bx < x_end; bx += 8) {
+            uint8_t columns[8];
+            uint8_t rows[8];
+
+            for(int16_t i = 0; i < 8; i++) {
+                const uint16_t n = (bx + i) * raster_height + r;
+                columns[i] = ((bx + i < x_end) && (n < len)) ? data[n] : 0;
+            }
+
+            matrix_transpose8(columns, rows);
+
+            for(int16_t j = j_start; j < j_end; j++) {
+                if(rows[j]) {
+                    matrix_set_pixel_byte(x0 + bx, y0 + r * 8 + j, rows[j]);
+                }
+            }
+        }
+    }
+}
+
+void matrix_blit_rows(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len)
+{
+    const uint8_t row_bytes = (w + 7) / 8;
+
+    for(uint16_t j = 0; j < h; j++) {
+        if((y + j < 0) || (y + j >= MATRIX_HEIGHT)) {
+            continue;
+        }
+
+        for(uint8_t b = 0; b < row_bytes; b++) {
+            const int16_t bx = x + 8 * b;
+            const uint8_t m = data[j * row_bytes + b];
+
+            if(m && (-8 < bx) && (bx < MATRIX_WIDTH)) {
+                matrix_set_pixel_byte(bx, y + j, m);
             }
         }
     }
 }
 
+// Apply the mask m to the bytes [n1, n2] of a row, with the bytes in between
+// set or cleared with memset
+static void matrix_fill_span(uint16_t n1, uint16_t n2, uint8_t m1, uint8_t m2)
+{
+    if(n1 == n2) {
+        matrix_set_pixel_row(n1, m1 & m2);
+        return;
+    }
+
+    matrix_set_pixel_row(n1, m1);
+    memset(framebuffer + n1 + 1, (fb_current_pen == FB_NORMAL) ? 0xFF : 0x00, n2 - n1 - 1);
+    matrix_set_pixel_row(n2, m2);
+}
+
+void matrix_fill_rect(int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+    int16_t x1 = (x < 0) ? 0 : x;
+    int16_t x2 = (x + w > MATRIX_WIDTH) ? MATRIX_WIDTH - 1 : x + w - 1;
+    int16_t y1 = (y < 0) ? 0 : y;
+    int16_t y2 = (y + h > MATRIX_HEIGHT) ? MATRIX_HEIGHT - 1 : y + h - 1;
+
+    if((x2 < x1) || (y2 < y1)) {
+        return;
+    }
+
+    // The masks of the leftmost and rightmost bytes are the same for every row
+    const uint8_t m1 = 0xFF >> (x1 % 8);
+    const uint8_t m2 = 0xFF << (7 - (x2 % 8));
+
+    for(int16_t j = y1; j <= y2; j++) {
+        const uint16_t row = (MATRIX_WIDTH / 8) * j;
+
+        matrix_fill_span(row + x1 / 8, row + x2 / 8, m1, m2);
+    }
+}
+
 int matrix_init(void)
 {
     int ret = i2c_start(MATRIX_I2C_ADDRESS, I2C_WRITE) != I2C_ACK;
@@ -5,8 +5,18 @@
 
 #define MATRIX_I2C_ADDRESS 0x5B
 
+// The matrix is made of 8x8 LED modules. Larger panels, up to 64x32, are
+// built by setting MATRIX_WIDTH and MATRIX_HEIGHT in the Makefile, to the
+// same values as for the AVR firmware. See avr/config.h for the AVR parts
+// which have RAM for each size.
+#ifndef MATRIX_WIDTH
 #define MATRIX_WIDTH 32
+#endif
+
+#ifndef MATRIX_HEIGHT
 #define MATRIX_HEIGHT 32
+#endif
+
 #define MATRIX_SIZE (MATRIX_WIDTH * MATRIX_HEIGHT / 8)
 
 void matrix_set_pixel(int16_t x, int16_t y);
@@ -17,6 +27,13 @@ void matrix_splash(void);
 
 void matrix_blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
 
+// Blit an image stored row by row, (w + 7) / 8 bytes per row with the
+// leftmost pixel in the most significant bit. len is not used, and is there
+// to match fb_blit.
+void matrix_blit_rows(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
+
+void matrix_fill_rect(int16_t x, int16_t y, uint16_t w, uint16_t h);
+
 int matrix_init(void);
 
 #endif
@@ -0,0 +1,157 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "matrix_render.h"
+#include "matrix_framebuffer.h"
+#include "fonts.h"
+#include "display-schedule.h"
+#include "animation.h"
+#include "glyph-cache.h"
+#include "icons.h"
+#include "ticker.h"
+#include "journey.h"
+#include "status.h"
+
+#include "log.h"
+#define LOG_SYS LOG_SYS_DISPLAY
+
+#define STATE_DISPLAY 0
+#define STATE_SHIFT_OUT 1
+#define STATE_SHIFT_IN 2
+#define STATE_NO_DISPLAY 3
+
+// The rows are spread out over taller matrices
+#define Y_CLOCK 7
+#define Y_JOURNEY_1 19
+#define Y_JOURNEY_2 (Y_JOURNEY_1 + (MATRIX_HEIGHT - Y_JOURNEY_1 + 5) / 2)
+
+#define X_ICON 1
+#define X_TIME 12
+
+// Matrices wide enough show the destination right of the time
+#define X_DESTINATION 34
+#define DESTINATION_WIDTH (MATRIX_WIDTH - X_DESTINATION)
+#define SHOW_DESTINATION (MATRIX_WIDTH >= 64)
+
+static const struct icon *journey_icons[6];
+
+static struct glyph_cache clock_glyphs;
+static struct glyph_cache journey_glyphs;
+
+#define SHIFT_MS 1280
+
+// Shift a row out to the right and back in again
+static const struct animation_step shift_steps[] = {
+    { .from = 0, .to = MATRIX_WIDTH, .duration_ms = SHIFT_MS, .easing = ANIMATION_EASE_IN },
+    { .from = MATRIX_WIDTH, .to = 0, .duration_ms = SHIFT_MS, .easing = ANIMATION_EASE_OUT },
+};
+
+struct journey_display_state
+{
+    time_t current;
+    time_t next;
+    int16_t shift;
+    uint8_t state;
+    uint8_t y;
+
+    struct animation anim;
+};
+
+static struct journey_display_state journey_display_states[2] = { { .y = Y_JOURNEY_1 }, { .y = Y_JOURNEY_2 } };
+
+#if SHOW_DESTINATION
+static struct ticker destination_tickers[2];
+#endif
+
+static void update_journey_display_state(struct journey_display_state *state, const time_t *next, uint32_t now)
+{
+    int step;
+
+    switch(state->state)
+    {
+    case STATE_DISPLAY:
+        if(*next != state->current) {
+            LOG("current = %ld, next = %ld", state->current, *next);
+            state->state = STATE_SHIFT_OUT;
+            state->next = *next;
+
+            animation_start(&state->anim, &state->shift, shift_steps, 2, now);
+        }
+        break;
+
+    case STATE_SHIFT_OUT:
+    case STATE_SHIFT_IN:
+        step = animation_update(&state->anim, now);
+
+        if((step != 0) && (state->state == STATE_SHIFT_OUT)) {
+            state->state = STATE_SHIFT_IN;
+            state->current = state->next;
+        }
+
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_DISPLAY;
+        }
+        break;
+    }
+}
+
+void matrix_render_init(void)
+{
+    journey_icons[TRANSPORT_MODE_UNKNOWN] = 0;
+    journey_icons[TRANSPORT_MODE_BUS] = icon_get("/icons-small/bus.pbm");
+    journey_icons[TRANSPORT_MODE_METRO] = icon_get("/icons-small/subway.pbm");
+    journey_icons[TRANSPORT_MODE_TRAIN] = icon_get("/icons-small/train.pbm");
+    journey_icons[TRANSPORT_MODE_TRAM] = icon_get("/icons-small/tram.pbm");
+    journey_icons[TRANSPORT_MODE_SHIP] = icon_get("/icons-small/boat.pbm");
+
+    glyph_cache_free(&clock_glyphs);
+    glyph_cache_free(&journey_glyphs);
+    glyph_cache_init(&clock_glyphs, font_6x12, GLYPH_CACHE_LAYOUT_ROWS);
+    glyph_cache_init(&journey_glyphs, font_3x5, GLYPH_CACHE_LAYOUT_ROWS);
+
+    journey_display_states[0] = (struct journey_display_state) { .y = Y_JOURNEY_1 };
+    journey_display_states[1] = (struct journey_display_state) { .y = Y_JOURNEY_2 };
+
+#if SHOW_DESTINATION
+    ticker_init(&destination_tickers[0], font_3x5, DESTINATION_WIDTH);
+    ticker_init(&destination_tickers[1], font_3x5, DESTINATION_WIDTH);
+#endif
+}
+
+void matrix_render_frame(uint32_t now_ms, const struct timeval *now, struct display_schedule *schedule)
+{
+    char buf[6];
+
+    fb_clear();
+
+    fb_set_pen(FB_NORMAL);
+
+    if(app_status.obtained_time && app_status.obtained_tz) {
+        const time_t t = now->tv_sec;
+
+        display_schedule_clock(schedule, now, 60);
+
+        strftime(buf, sizeof(buf), "%H:%M", localtime(&t));
+        glyph_cache_draw_string(&clock_glyphs, 1, Y_CLOCK, buf, FB_ALIGN_CENTER_V);
+    }
+
+    for(int i = 0; i < 2; i++) {
+        update_journey_display_state(&journey_display_states[i], &journies[i].departures[0], now_ms);
+
+        if(journey_display_states[i].current) {
+            strftime(buf, sizeof(buf), "%H:%M", localtime(&journey_display_states[i].current));
+        } else {
+            sprintf(buf, "--:--");
+        }
+        glyph_cache_draw_string(&journey_glyphs, X_TIME + journey_display_states[i].shift, journey_display_states[i].y, buf, FB_ALIGN_CENTER_V);
+        fb_draw_icon(X_ICON + journey_display_states[i].shift, journey_display_states[i].y, journey_icons[journies[i].mode], FB_ALIGN_CENTER_V);
+
+#if SHOW_DESTINATION
+        ticker_set_text(&destination_tickers[i], journies[i].destination, now_ms);
+        ticker_draw(&destination_tickers[i], X_DESTINATION + journey_display_states[i].shift, journey_display_states[i].y, now_ms, schedule);
+#endif
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef MATRIX_RENDER_H_
+#define MATRIX_RENDER_H_
+
+#include <stdint.h>
+#include <sys/time.h>
+
+// Drawing of the LED matrix display. The frames only depend on the arguments
+// and on the journies and app_status, so that they can be rendered on the
+// host with a virtual clock.
+
+struct display_schedule;
+
+void matrix_render_init(void);
+
+// Draw the frame at animation time now_ms and wall clock time now
+void matrix_render_frame(uint32_t now_ms, const struct timeval *now, struct display_schedule *schedule);
+
+#endif
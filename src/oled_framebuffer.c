@@ -14,8 +14,46 @@
 #include "log.h"
 #define LOG_SYS LOG_SYS_DISPLAY
 
+#define OLED_PAGES (OLED_HEIGHT / 8)
+
+struct oled_range {
+    uint8_t start;
+    uint8_t end;
+};
+
+// Columns written since the last oled_clear, and columns cleared since the
+// last oled_clear_dirty. Together they cover every byte that may differ from
+// what was last sent to the display.
+static struct oled_range oled_drawn[OLED_PAGES];
+static struct oled_range oled_cleared[OLED_PAGES];
+
+// A range is empty if start >= end
+static void oled_range_add(struct oled_range *range, uint8_t start, uint8_t end)
+{
+    if(start >= end) {
+        return;
+    }
+
+    if(range->start >= range->end) {
+        range->start = start;
+        range->end = end;
+        return;
+    }
+
+    if(start < range->start) {
+        range->start = start;
+    }
+    if(end > range->end) {
+        range->end = end;
+    }
+}
+
 static void oled_set_pixel_row(uint16_t n, uint8_t m)
 {
+    const uint8_t x = n % OLED_WIDTH;
+
+    oled_range_add(&oled_drawn[n / OLED_WIDTH], x, x + 1);
+
     if(fb_current_pen == FB_NORMAL) {
         framebuffer[n] |= m;
     } else {
@@ -38,9 +76,33 @@ void oled_set_pixel(int16_t x,int16_t y)
 void oled_clear(void)
 {
     memset(framebuffer, 0, OLED_SIZE);
+
+    for(int page = 0; page < OLED_PAGES; page++) {
+        oled_range_add(&oled_cleared[page], oled_drawn[page].start, oled_drawn[page].end);
+        oled_drawn[page] = (struct oled_range) { 0, 0 };
+    }
 }
 
-void oled_blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len)
+int oled_get_dirty(uint8_t page, uint8_t *start, uint8_t *end)
+{
+    struct oled_range range = oled_cleared[page];
+
+    oled_range_add(&range, oled_drawn[page].start, oled_drawn[page].end);
+
+    *start = range.start;
+    *end = range.end;
+
+    return range.start < range.end;
+}
+
+void oled_clear_dirty(void)
+{
+    for(int page = 0; page < OLED_PAGES; page++) {
+        oled_cleared[page] = (struct oled_range) { 0, 0 };
+    }
+}
+
+void oled_blit_generic(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len)
 {
     if(-h >= y || y > OLED_HEIGHT) {
         return;
@@ -74,60 +136,127 @@ void oled_blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data
     }
 }
 
-void oled_splash(void)
+// Load a column of a glyph at most 24 rows high into a word
+static inline uint32_t oled_load_column(const uint8_t *data, uint8_t n)
 {
-    oled_clear();
+    switch(n) {
+    case 3:
+        return data[0] | (data[1] << 8) | ((uint32_t) data[2] << 16);
+    case 2:
+        return data[0] | (data[1] << 8);
+    default:
+        return data[0];
+    }
+}
 
-    for(int y = 0; y < 8; y++)
-    {
-        oled_blit(32, y * 8, 64, 8, &paw_64x64[y * 64], 64);
+static inline void oled_store_column(uint8_t *dst, uint32_t column, uint8_t pages)
+{
+    if(fb_current_pen == FB_NORMAL) {
+        for(uint8_t p = 0; p < pages; p++) {
+            dst[p * OLED_WIDTH] |= column >> (8 * p);
+        }
+    } else {
+        for(uint8_t p = 0; p < pages; p++) {
+            dst[p * OLED_WIDTH] &= ~(column >> (8 * p));
+        }
     }
+}
 
-    oled_display();
+// Blit a glyph at most 24 rows high whose columns are all on screen. Each
+// column is shifted into place as a single word, so the bytes of a column
+// that is not page aligned are only read once. Rows below the bottom of the
+// screen are dropped.
+static void oled_blit_columns(int16_t x, int16_t y, uint8_t raster_height, const uint8_t *data, uint16_t len)
+{
+    const uint8_t page = y >> 3;
+    const uint8_t offset = y & 0x07;
+    const uint16_t columns = len / raster_height;
+    const uint8_t rest = len % raster_height;
+
+    uint8_t pages = raster_height + (offset ? 1 : 0);
+
+    if(page + pages > OLED_PAGES) {
+        pages = OLED_PAGES - page;
+    }
+
+    for(uint8_t p = 0; p < pages; p++) {
+        oled_range_add(&oled_drawn[page + p], x, x + columns + (rest ? 1 : 0));
+    }
+
+    uint8_t *dst = framebuffer + x + page * OLED_WIDTH;
+
+    for(uint16_t i = 0; i < columns; i++) {
+        oled_store_column(dst++, oled_load_column(data, raster_height) << offset, pages);
+        data += raster_height;
+    }
+
+    if(rest) {
+        oled_store_column(dst, oled_load_column(data, rest) << offset, pages);
+    }
 }
 
-static void oled_draw_line_v(int16_t x, int16_t y1, int16_t y2)
+void oled_blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len)
 {
-    if((0 > x) || (x >= OLED_WIDTH)) {
+    if(-h >= y || y >= OLED_HEIGHT) {
         return;
     }
+    uint8_t raster_height = 1 + ((h - 1) / 8);
 
-    if(y1 < 0) {
-        y1 = 0;
+    if(!len)
+    {
+        len = w * raster_height;
     }
 
-    if(y2 >= OLED_HEIGHT) {
-        y2 = OLED_HEIGHT - 1;
+    const uint16_t columns = (len + raster_height - 1) / raster_height;
+
+    if((raster_height <= 3) && (0 <= y) && (0 <= x) && (x + columns <= OLED_WIDTH)) {
+        oled_blit_columns(x, y, raster_height, data, len);
+    } else {
+        oled_blit_generic(x, y, w, h, data, len);
     }
+}
 
-    if(y2 < y1) {
-        return;
+void oled_splash(void)
+{
+    oled_clear();
+
+    for(int y = 0; y < 8; y++)
+    {
+        oled_blit(32, y * 8, 64, 8, &paw_64x64[y * 64], 64);
     }
 
-    const uint8_t site1 = y1 / 8;
-    const uint8_t site2 = y2 / 8;
+    oled_display();
+}
 
-    const uint8_t m1 = 0xFF << (y1 & 0x07);
-    const uint8_t m2 = 0xFF >> (7 - (y2 & 0x07));
+// Apply the mask m to the columns [x1, x2] of a page. Whole bytes are set
+// or cleared with memset.
+static void oled_fill_span(uint8_t page, uint8_t x1, uint8_t x2, uint8_t m)
+{
+    uint8_t *dst = framebuffer + x1 + page * OLED_WIDTH;
+    const uint8_t n = x2 - x1 + 1;
 
-    if(site2 > site1) {
-        oled_set_pixel_row(x + site1 * OLED_WIDTH, m1);
-        oled_set_pixel_row(x + site2 * OLED_WIDTH, m2);
+    oled_range_add(&oled_drawn[page], x1, x2 + 1);
 
-        for(uint8_t s = site1 + 1; s < site2; s++) {
-            oled_set_pixel_row(x + s * OLED_WIDTH, 0xFF);
+    if(m == 0xFF) {
+        memset(dst, (fb_current_pen == FB_NORMAL) ? 0xFF : 0x00, n);
+    } else if(fb_current_pen == FB_NORMAL) {
+        for(uint8_t i = 0; i < n; i++) {
+            dst[i] |= m;
         }
     } else {
-        oled_set_pixel_row(x + site1 * OLED_WIDTH, m1 & m2);
+        const uint8_t keep = ~m;
+
+        for(uint8_t i = 0; i < n; i++) {
+            dst[i] &= keep;
+        }
     }
 }
 
-static void oled_draw_line_h(int16_t x1, int16_t x2, int16_t y)
+// Fill the pixels x1 <= x <= x2, y1 <= y <= y2, clipped to the screen. The
+// masks for the top and bottom pages are computed once and applied across
+// the whole span.
+static void oled_fill_area(int16_t x1, int16_t x2, int16_t y1, int16_t y2)
 {
-    if((0 > y) || (y >= OLED_HEIGHT)) {
-        return;
-    }
-
     if(x1 < 0) {
         x1 = 0;
     }
@@ -136,27 +265,47 @@ static void oled_draw_line_h(int16_t x1, int16_t x2, int16_t y)
         x2 = OLED_WIDTH - 1;
     }
 
-    if(x2 < x1) {
+    if(y1 < 0) {
+        y1 = 0;
+    }
+
+    if(y2 >= OLED_HEIGHT) {
+        y2 = OLED_HEIGHT - 1;
+    }
+
+    if((x2 < x1) || (y2 < y1)) {
         return;
     }
 
-    uint8_t s = y / 8;
-    uint8_t m = 1 << (y & 0x07);
+    const uint8_t page1 = y1 / 8;
+    const uint8_t page2 = y2 / 8;
+
+    const uint8_t m1 = 0xFF << (y1 & 0x07);
+    const uint8_t m2 = 0xFF >> (7 - (y2 & 0x07));
 
-    for(uint8_t x = x1; x <= x2; x++) {
-        oled_set_pixel_row(x + s * OLED_WIDTH, m);
+    if(page2 > page1) {
+        oled_fill_span(page1, x1, x2, m1);
+
+        for(uint8_t page = page1 + 1; page < page2; page++) {
+            oled_fill_span(page, x1, x2, 0xFF);
+        }
+
+        oled_fill_span(page2, x1, x2, m2);
+    } else {
+        oled_fill_span(page1, x1, x2, m1 & m2);
     }
 }
 
+static void oled_draw_line_v(int16_t x, int16_t y1, int16_t y2)
+{
+    oled_fill_area(x, x, y1, y2);
+}
+
+static void oled_draw_line_h(int16_t x1, int16_t x2, int16_t y)
+{
+    oled_fill_area(x1, x2, y, y);
+}
 
-const uint8_t corner_sw[] = { 0b00000111, 0b00011000, 0b00100000, 0b01000000, 0b01000000, 0b10000000, 0b10000000, 0b10000000, };
-const uint8_t corner_nw[] = { 0b11100000, 0b00011000, 0b00000100, 0b00000010, 0b00000010, 0b00000001, 0b00000001, 0b00000001, };
-const uint8_t corner_se[] = { 0b10000000, 0b10000000, 0b10000000, 0b01000000, 0b01000000, 0b00100000, 0b00011000, 0b00000111, };
-const uint8_t corner_ne[] = { 0b00000001, 0b00000001, 0b00000001, 0b00000010, 0b00000010, 0b00000100, 0b00011000, 0b11100000, };
-static const uint8_t corner_fill_sw[] = { 0b00000111, 0b00011111, 0b00111111, 0b01111111, 0b01111111, 0b11111111, 0b11111111, 0b11111111, };
-static const uint8_t corner_fill_nw[] = { 0b11100000, 0b11111000, 0b11111100, 0b11111110, 0b11111110, 0b11111111, 0b11111111, 0b11111111, };
-static const uint8_t corner_fill_se[] = { 0b11111111, 0b11111111, 0b11111111, 0b01111111, 0b01111111, 0b00111111, 0b00011111, 0b00000111, };
-static const uint8_t corner_fill_ne[] = { 0b11111111, 0b11111111, 0b11111111, 0b11111110, 0b11111110, 0b11111100, 0b11111000, 0b11100000, };
 
 void oled_draw_rect(int16_t x, int16_t y, uint16_t w, uint16_t h)
 {
@@ -168,40 +317,7 @@ void oled_draw_rect(int16_t x, int16_t y, uint16_t w, uint16_t h)
 }
 
 
-void oled_draw_rect_round(int16_t x, int16_t y, uint16_t w, uint16_t h)
-{
-    oled_blit(x,     y,     8, 8, corner_nw, 0);
-    oled_blit(x+w-8, y,     8, 8, corner_ne, 0);
-    oled_blit(x,     y+h-8, 8, 8, corner_sw, 0);
-    oled_blit(x+w-8, y+h-8, 8, 8, corner_se, 0);
-
-    oled_draw_line_h(x+8,x+w-8-1,y);
-    oled_draw_line_h(x+8,x+w-8-1,y+h-1);
-
-    oled_draw_line_v(x,    y+8,y+h-8-1);
-    oled_draw_line_v(x+w-1,y+8,y+h-8-1);
-}
-
 void oled_fill_rect(int16_t x, int16_t y, uint16_t w, uint16_t h)
 {
-    for(uint16_t i = 0; i < w; i++) {
-        oled_draw_line_v(x + i, y, y + h - 1);
-    }
-}
-
-void oled_fill_rect_round(int16_t x, int16_t y, uint16_t w, uint16_t h)
-{
-    oled_blit(x,     y,     8, 8, corner_fill_nw, 0);
-    oled_blit(x+w-8, y,     8, 8, corner_fill_ne, 0);
-    oled_blit(x,     y+h-8, 8, 8, corner_fill_sw, 0);
-    oled_blit(x+w-8, y+h-8, 8, 8, corner_fill_se, 0);
-
-    for(uint8_t i = 0; i < 8; i++) {
-        oled_draw_line_v(x+i,     y+8, y+h-9);
-        oled_draw_line_v(x+w-8+i, y+8, y+h-9);
-    }
-
-    for(uint16_t i = x + 8; i < x + w - 8; i++) {
-        oled_draw_line_v(i, y, y+h-1);
-    }
+    oled_fill_area(x, x + w - 1, y, y + h - 1);
 }
@@ -13,11 +13,18 @@ void oled_display(void);
 void oled_clear(void);
 void oled_splash(void);
 
+// Get the columns [start, end) of a page that may have changed since the last
+// call to oled_clear_dirty. Returns 0 if the page is unchanged.
+int oled_get_dirty(uint8_t page, uint8_t *start, uint8_t *end);
+void oled_clear_dirty(void);
+
 void oled_blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
 
+// Handles any clipping, one byte at a time. oled_blit uses this for glyphs
+// that do not fit its faster kernels.
+void oled_blit_generic(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len);
+
 void oled_draw_rect(int16_t x, int16_t y, uint16_t w, uint16_t h);
-void oled_draw_rect_round(int16_t x, int16_t y, uint16_t w, uint16_t h);
 void oled_fill_rect(int16_t x, int16_t y, uint16_t w, uint16_t h);
-void oled_fill_rect_round(int16_t x, int16_t y, uint16_t w, uint16_t h);
 
 #endif
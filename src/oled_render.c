@@ -0,0 +1,496 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "oled_render.h"
+#include "oled_framebuffer.h"
+#include "fonts.h"
+#include "display-message.h"
+#include "display-schedule.h"
+#include "animation.h"
+#include "glyph-cache.h"
+#include "icons.h"
+#include "text-layout.h"
+#include "ticker.h"
+#include "journey.h"
+#include "status.h"
+
+#include "log.h"
+#define LOG_SYS LOG_SYS_DISPLAY
+
+#define STATE_DISPLAY 0
+#define STATE_SHIFT_OUT 1
+#define STATE_SHIFT_IN 2
+#define STATE_NO_DISPLAY 3
+
+#define STATE_SINGLE_DISPLAY 0
+#define STATE_SINGLE_SHIFT_BOTH_OUT 1
+#define STATE_SINGLE_SHIFT_BOTH_IN 2
+#define STATE_SINGLE_SHIFT_ONE_OUT 3
+#define STATE_SINGLE_SHIFT_ICON_UP_OUT 4
+#define STATE_SINGLE_SHIFT_JOURNEY_UP 5
+#define STATE_SINGLE_SHIFT_ONE_IN 6
+#define STATE_SINGLE_SHIFT_ICON_UP_IN 7
+
+#define BLINK 1
+#define NOBLINK 0
+
+#define X_ICON 20
+#define X_TIME 75
+#define X_LINE 40
+#define X_DESTINATION 36
+
+#define DESTINATION_WIDTH 70
+
+#define Y_CLOCK 10
+#define Y_JOURNEY_1 32
+#define Y_JOURNEY_2 54
+#define Y_JOURNEY_MID ((Y_JOURNEY_1 + Y_JOURNEY_2) / 2)
+#define Y_DESTINATION 26
+
+#define SHIFT_MS 1280
+#define ICON_UP_MS 220
+#define JOURNEY_UP_MS 440
+#define MESSAGE_MS 1920
+
+struct journey_display_state
+{
+    time_t current;
+    time_t next;
+    int16_t x_shift;
+    int16_t y_shift;
+    uint8_t state;
+
+    struct animation anim;
+
+    const struct icon *icon;
+};
+
+struct journey_single_display_state
+{
+    time_t current[2];
+    time_t next[2];
+    int16_t x_shift;
+    int16_t y_shift;
+    uint8_t state;
+
+    struct animation anim;
+
+    const struct icon *icon;
+};
+
+struct message_state
+{
+    uint8_t state;
+
+    struct animation anim;
+
+    int16_t y;
+
+    enum display_message current;
+    enum display_message next;
+
+    // Formatted and measured once when the message is posted
+    struct text_layout layout;
+    struct text_layout next_layout;
+};
+
+static const struct icon *clock_icon;
+static const struct icon *noclock_icon;
+static const struct icon *nowifi_icons[4];
+static const struct icon *journey_icons[6];
+
+static struct glyph_cache time_glyphs;
+
+static struct ticker destination_ticker;
+
+static struct journey_display_state journey_display_states[2];
+static struct journey_single_display_state journey_single_display_state;
+
+// Shift a row out to the right and back in again
+static const struct animation_step shift_steps[] = {
+    { .from = 0, .to = OLED_WIDTH, .duration_ms = SHIFT_MS, .easing = ANIMATION_EASE_IN },
+    { .from = OLED_WIDTH, .to = 0, .duration_ms = SHIFT_MS, .easing = ANIMATION_EASE_OUT },
+};
+
+static const struct animation_step icon_up_out_step = { .from = Y_JOURNEY_MID, .to = Y_JOURNEY_1, .duration_ms = ICON_UP_MS, .easing = ANIMATION_EASE_IN_OUT };
+static const struct animation_step journey_up_step = { .from = Y_JOURNEY_2, .to = Y_JOURNEY_1, .duration_ms = JOURNEY_UP_MS, .easing = ANIMATION_EASE_IN_OUT };
+static const struct animation_step icon_up_in_step = { .from = Y_JOURNEY_2, .to = Y_JOURNEY_MID, .duration_ms = ICON_UP_MS, .easing = ANIMATION_EASE_IN_OUT };
+
+static const struct animation_step message_in_step = { .from = 2*OLED_HEIGHT, .to = OLED_HEIGHT/2, .duration_ms = MESSAGE_MS, .easing = ANIMATION_EASE_OUT };
+static const struct animation_step message_out_step = { .from = OLED_HEIGHT/2, .to = -OLED_HEIGHT, .duration_ms = MESSAGE_MS, .easing = ANIMATION_EASE_IN };
+
+static struct message_state message_state = { .state = STATE_NO_DISPLAY, .current = DISPLAY_MESSAGE_NONE, .next = DISPLAY_MESSAGE_NONE, .y = 2*OLED_HEIGHT };
+
+static void draw_row(int16_t x, int16_t y, const struct icon *icon, const time_t *t, int blink)
+{
+    char str[6];
+
+    if(*t)
+    {
+        if(blink && (*t & 0x01))
+        {
+            strftime(str, sizeof(str), "%H %M", localtime(t));
+        } else {
+            strftime(str, sizeof(str), "%H:%M", localtime(t));
+        }
+    } else {
+        sprintf(str, "--:--");
+    }
+
+    if(icon) {
+        fb_draw_icon(X_ICON + x, y, icon, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+    }
+
+    glyph_cache_draw_string(&time_glyphs, X_TIME + x, y, str, FB_ALIGN_CENTER_V);
+}
+
+static void update_journey_display_state(struct journey_display_state *state, const time_t *next, uint32_t now)
+{
+    int step;
+
+    switch(state->state)
+    {
+    case STATE_DISPLAY:
+        if(*next != state->current)
+        {
+            state->state = STATE_SHIFT_OUT;
+            state->next = *next;
+
+            animation_start(&state->anim, &state->x_shift, shift_steps, 2, now);
+        }
+        break;
+
+    case STATE_SHIFT_OUT:
+    case STATE_SHIFT_IN:
+        step = animation_update(&state->anim, now);
+
+        if((step != 0) && (state->state == STATE_SHIFT_OUT)) {
+            state->state = STATE_SHIFT_IN;
+            state->current = state->next;
+        }
+
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_DISPLAY;
+        }
+        break;
+    }
+}
+
+static void update_journey_single_display_state(struct journey_single_display_state *state, const time_t *next, uint32_t now)
+{
+    if(state->state == STATE_SINGLE_DISPLAY) {
+        if(next[0] != state->current[0]) {
+            state->next[0] = next[0];
+            state->next[1] = next[1];
+
+            if(next[0] != state->current[1]) {
+                state->state = STATE_SINGLE_SHIFT_BOTH_OUT;
+                animation_start(&state->anim, &state->x_shift, shift_steps, 2, now);
+            } else {
+                state->state = STATE_SINGLE_SHIFT_ICON_UP_OUT;
+                animation_start(&state->anim, &state->y_shift, &icon_up_out_step, 1, now);
+            }
+        }
+        return;
+    }
+
+    const int step = animation_update(&state->anim, now);
+
+    switch(state->state)
+    {
+    case STATE_SINGLE_SHIFT_BOTH_OUT:
+        if(step != 0) {
+            state->state = STATE_SINGLE_SHIFT_BOTH_IN;
+            state->current[0] = state->next[0];
+            state->current[1] = state->next[1];
+        }
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_SINGLE_DISPLAY;
+        }
+        break;
+
+    case STATE_SINGLE_SHIFT_BOTH_IN:
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_SINGLE_DISPLAY;
+        }
+        break;
+
+    case STATE_SINGLE_SHIFT_ICON_UP_OUT:
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_SINGLE_SHIFT_ONE_OUT;
+            animation_continue(&state->anim, &state->x_shift, &shift_steps[0], 1, now);
+        }
+        break;
+
+    case STATE_SINGLE_SHIFT_ONE_OUT:
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_SINGLE_SHIFT_JOURNEY_UP;
+            state->current[0] = state->next[0];
+            state->current[1] = state->next[1];
+            animation_continue(&state->anim, &state->y_shift, &journey_up_step, 1, now);
+        }
+        break;
+
+    case STATE_SINGLE_SHIFT_JOURNEY_UP:
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_SINGLE_SHIFT_ONE_IN;
+            animation_continue(&state->anim, &state->x_shift, &shift_steps[1], 1, now);
+        }
+        break;
+
+    case STATE_SINGLE_SHIFT_ONE_IN:
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_SINGLE_SHIFT_ICON_UP_IN;
+            animation_continue(&state->anim, &state->y_shift, &icon_up_in_step, 1, now);
+        }
+        break;
+
+    case STATE_SINGLE_SHIFT_ICON_UP_IN:
+        if(step == ANIMATION_DONE) {
+            state->state = STATE_SINGLE_DISPLAY;
+        }
+        break;
+    }
+}
+
+
+static void draw_journey_row(const struct journey_display_state *state, const struct journey *journey)
+{
+    draw_row(state->x_shift, state->y_shift, state->icon, &state->current, 0);
+    fb_draw_string(X_LINE + state->x_shift, state->y_shift, journey->line, 0, font_3x5, FB_ALIGN_CENTER_V);
+}
+
+// The destination is shown above the icon when there is a single journey, and
+// scrolls if it does not fit left of the times
+static void draw_destination(int16_t x, const struct journey *journey, uint32_t now_ms, struct display_schedule *schedule)
+{
+    ticker_set_text(&destination_ticker, journey->destination, now_ms);
+    ticker_draw(&destination_ticker, X_DESTINATION - DESTINATION_WIDTH / 2 + x, Y_DESTINATION, now_ms, schedule);
+}
+
+static void draw_journey_single(struct journey_single_display_state *state, uint32_t now_ms, struct display_schedule *schedule)
+{
+    switch(state->state)
+    {
+    case STATE_SINGLE_DISPLAY:
+        draw_row(0, Y_JOURNEY_1, 0, &state->current[0], 0);
+        draw_row(0, Y_JOURNEY_2, 0, &state->current[1], 0);
+        fb_draw_icon(X_ICON, (Y_JOURNEY_1 + Y_JOURNEY_2)/2, state->icon, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+        fb_draw_string(X_LINE, (Y_JOURNEY_1 + Y_JOURNEY_2)/2, journies[0].line, 0, font_3x5, FB_ALIGN_CENTER_V);
+        draw_destination(0, &journies[0], now_ms, schedule);
+        break;
+
+    case STATE_SINGLE_SHIFT_BOTH_IN:
+    case STATE_SINGLE_SHIFT_BOTH_OUT:
+        draw_row(state->x_shift, Y_JOURNEY_1, 0, &state->current[0], 0);
+        draw_row(state->x_shift, Y_JOURNEY_2, 0, &state->current[1], 0);
+        fb_draw_icon(X_ICON + state->x_shift, (Y_JOURNEY_1 + Y_JOURNEY_2)/2, state->icon, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+        fb_draw_string(X_LINE + state->x_shift, (Y_JOURNEY_1 + Y_JOURNEY_2)/2, journies[0].line, 0, font_3x5, FB_ALIGN_CENTER_V);
+        draw_destination(state->x_shift, &journies[0], now_ms, schedule);
+        break;
+
+    case STATE_SINGLE_SHIFT_ICON_UP_OUT:
+    case STATE_SINGLE_SHIFT_ICON_UP_IN:
+        draw_row(0, Y_JOURNEY_1, 0, &state->current[0], 0);
+        draw_row(0, Y_JOURNEY_2, 0, &state->current[1], 0);
+        fb_draw_icon(X_ICON, state->y_shift, state->icon, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+        fb_draw_string(X_LINE, state->y_shift, journies[0].line, 0, font_3x5, FB_ALIGN_CENTER_V);
+        break;
+
+    case STATE_SINGLE_SHIFT_ONE_OUT:
+        draw_row(state->x_shift, Y_JOURNEY_1, 0, &state->current[0], 0);
+        draw_row(0, Y_JOURNEY_2, 0, &state->current[1], 0);
+        fb_draw_icon(X_ICON + state->x_shift, Y_JOURNEY_1, state->icon, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+        fb_draw_string(X_LINE + state->x_shift, Y_JOURNEY_1, journies[0].line, 0, font_3x5, FB_ALIGN_CENTER_V);
+        break;
+
+    case STATE_SINGLE_SHIFT_JOURNEY_UP:
+        draw_row(0, state->y_shift, 0, &state->current[0], 0);
+        break;
+
+    case STATE_SINGLE_SHIFT_ONE_IN:
+        draw_row(0, Y_JOURNEY_1, 0, &state->current[0], 0);
+        draw_row(state->x_shift, Y_JOURNEY_2, 0, &state->current[1], 0);
+        fb_draw_icon(X_ICON + state->x_shift, Y_JOURNEY_2, state->icon, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+        fb_draw_string(X_LINE + state->x_shift, Y_JOURNEY_2, journies[0].line, 0, font_3x5, FB_ALIGN_CENTER_V);
+        break;
+    }
+}
+
+#define NOWIFI_ICON_MS 250
+
+static void draw_clock_row(uint32_t now_ms, const struct timeval *tv, struct display_schedule *schedule)
+{
+    if(app_status.obtained_time && app_status.obtained_tz) {
+        // The colon blinks every second
+        display_schedule_clock(schedule, tv, 1);
+    }
+
+    if(!app_status.wifi_connected)
+    {
+        time_t now;
+
+        if(app_status.obtained_time && app_status.obtained_tz)
+        {
+            now = tv->tv_sec;
+        } else {
+            now = 0;
+        }
+
+        uint32_t n = now_ms / NOWIFI_ICON_MS;
+
+        display_schedule_every(schedule, now_ms, NOWIFI_ICON_MS);
+
+        draw_row(0, Y_CLOCK, nowifi_icons[n & 0x03], &now, BLINK);
+    } else if(!(app_status.obtained_time && app_status.obtained_tz)) {
+        time_t now = 0;
+        draw_row(0, Y_CLOCK, noclock_icon, &now, BLINK);
+    } else {
+        time_t now = tv->tv_sec;
+        draw_row(0, Y_CLOCK, clock_icon, &now, BLINK);
+    }
+}
+
+static void draw_message_box(int16_t x, int16_t y, const struct text_layout *layout)
+{
+    const uint16_t w = layout->width;
+    const uint16_t h = layout->height;
+
+    fb_set_pen(FB_INVERSE);
+    fb_fill_rect_round(x-w/2-1-4, y-h/2-1, w+2+8, h+2);
+    fb_set_pen(FB_NORMAL);
+    fb_draw_rect_round(x-w/2-4, y-h/2, w+8, h);
+
+    text_layout_draw(layout, x, y);
+}
+
+
+static void show_message_animation(uint32_t now)
+{
+    struct message_state * state = &message_state;
+
+    switch(state->state) {
+    case STATE_DISPLAY:
+        if(state->next != state->current) {
+            state->state = STATE_SHIFT_OUT;
+            animation_start(&state->anim, &state->y, &message_out_step, 1, now);
+        }
+        break;
+
+    case STATE_SHIFT_IN:
+        if(animation_update(&state->anim, now) == ANIMATION_DONE) {
+            state->state = STATE_DISPLAY;
+        }
+        break;
+
+    case STATE_SHIFT_OUT:
+        if(animation_update(&state->anim, now) == ANIMATION_DONE) {
+            state->state = STATE_NO_DISPLAY;
+            state->current = DISPLAY_MESSAGE_NONE;
+        }
+        break;
+
+    case STATE_NO_DISPLAY:
+        if(state->next != DISPLAY_MESSAGE_NONE) {
+            state->state = STATE_SHIFT_IN;
+            state->current = state->next;
+            state->layout = state->next_layout;
+            animation_start(&state->anim, &state->y, &message_in_step, 1, now);
+        }
+        break;
+    }
+
+    if(message_state.state != STATE_NO_DISPLAY) {
+        draw_message_box(OLED_WIDTH/2, state->y, &state->layout);
+    }
+}
+
+void oled_render_init(void)
+{
+    clock_icon = icon_get("/icons/clock.pbm");
+    noclock_icon = icon_get("/icons/noclock.pbm");
+
+    nowifi_icons[0] = icon_get("/icons/nowifi1.pbm");
+    nowifi_icons[1] = icon_get("/icons/nowifi2.pbm");
+    nowifi_icons[2] = icon_get("/icons/nowifi3.pbm");
+    nowifi_icons[3] = icon_get("/icons/nowifi4.pbm");
+
+    journey_icons[TRANSPORT_MODE_UNKNOWN] = 0;
+    journey_icons[TRANSPORT_MODE_BUS] = icon_get("/icons/bus.pbm");
+    journey_icons[TRANSPORT_MODE_METRO] = icon_get("/icons/subway.pbm");
+    journey_icons[TRANSPORT_MODE_TRAIN] = icon_get("/icons/train.pbm");
+    journey_icons[TRANSPORT_MODE_TRAM] = icon_get("/icons/tram.pbm");
+    journey_icons[TRANSPORT_MODE_SHIP] = icon_get("/icons/boat.pbm");
+
+    glyph_cache_free(&time_glyphs);
+    glyph_cache_init(&time_glyphs, Monospaced_bold_16_rle, GLYPH_CACHE_LAYOUT_PAGES);
+
+    ticker_init(&destination_ticker, font_3x5, DESTINATION_WIDTH);
+
+    journey_display_states[0] = (struct journey_display_state) { .x_shift = 0, .y_shift = Y_JOURNEY_1, .state = STATE_DISPLAY, .current = 0, .next = 0, .icon = 0 };
+    journey_display_states[1] = (struct journey_display_state) { .x_shift = 0, .y_shift = Y_JOURNEY_2, .state = STATE_DISPLAY, .current = 0, .next = 0, .icon = 0 };
+
+    journey_single_display_state = (struct journey_single_display_state) { .x_shift = 0, .y_shift = 0, .state = STATE_SINGLE_DISPLAY };
+    journey_single_display_state.current[0] = 0;
+    journey_single_display_state.current[1] = 0;
+
+    message_state = (struct message_state) { .state = STATE_NO_DISPLAY, .current = DISPLAY_MESSAGE_NONE, .next = DISPLAY_MESSAGE_NONE, .y = 2*OLED_HEIGHT };
+}
+
+int oled_render_wants_message(void)
+{
+    return message_state.current == message_state.next;
+}
+
+void oled_render_set_message(enum display_message message, const char *text)
+{
+    // DISPLAY_MESSAGE_NONE only removes the message, so has no text to lay out
+    if(message != DISPLAY_MESSAGE_NONE) {
+        // Posting the shown message again updates its text, e.g. the IP address
+        if((message == message_state.current) && (message_state.state != STATE_NO_DISPLAY)) {
+            text_layout_init(&message_state.layout, text, ArialMT_Plain_10);
+        } else {
+            text_layout_init(&message_state.next_layout, text, ArialMT_Plain_10);
+        }
+    }
+
+    message_state.next = message;
+}
+
+void oled_render_frame(uint32_t now_ms, const struct timeval *now, struct display_schedule *schedule)
+{
+    fb_clear();
+
+    fb_set_pen(FB_NORMAL);
+
+    draw_clock_row(now_ms, now, schedule);
+
+    int num_journies = 0;
+
+    if(journies[1].line[0]) {
+        num_journies = 2;
+    } else if(journies[0].line[0]) {
+        num_journies = 1;
+    }
+
+    if(num_journies == 2) {
+        for(int i = 0; i < 2; i++) {
+            journey_display_states[i].icon = journey_icons[journies[i].mode];
+            update_journey_display_state(&journey_display_states[i], &journies[i].departures[0], now_ms);
+        }
+
+        for(int i = 0; i < 2; i++) {
+            draw_journey_row(&journey_display_states[i], &journies[i]);
+        }
+    } else if(num_journies == 1) {
+        journey_single_display_state.icon = journey_icons[journies[0].mode];
+
+        update_journey_single_display_state(&journey_single_display_state, journies[0].departures, now_ms);
+        draw_journey_single(&journey_single_display_state, now_ms, schedule);
+    }
+
+    show_message_animation(now_ms);
+}
@@ -0,0 +1,24 @@
+#ifndef OLED_RENDER_H_
+#define OLED_RENDER_H_
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#include "display-message.h"
+
+// Drawing of the OLED display. The frames only depend on the arguments and
+// on the journies and app_status, so that they can be rendered on the host
+// with a virtual clock.
+
+struct display_schedule;
+
+void oled_render_init(void);
+
+// Returns 1 when the next message can be set
+int oled_render_wants_message(void);
+void oled_render_set_message(enum display_message message, const char *text);
+
+// Draw the frame at animation time now_ms and wall clock time now
+void oled_render_frame(uint32_t now_ms, const struct timeval *now, struct display_schedule *schedule);
+
+#endif
@@ -0,0 +1,207 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "screenshot.h"
+
+static const uint8_t png_signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+static const uint8_t png_iend[] = { 0, 0, 0, 0, 'I', 'E', 'N', 'D', 0xAE, 0x42, 0x60, 0x82 };
+
+// Signature, IHDR chunk, and the start of the IDAT chunk up to the image data
+#define PNG_HEADER_LEN (8 + 25 + 8 + 2 + 5)
+// Adler-32 of the image data, CRC of the IDAT chunk, and the IEND chunk
+#define PNG_TRAILER_LEN (4 + 4 + 12)
+
+static uint8_t *put32(uint8_t *p, uint32_t v)
+{
+    *p++ = v >> 24;
+    *p++ = v >> 16;
+    *p++ = v >> 8;
+    *p++ = v;
+
+    return p;
+}
+
+// CRC-32 as used by PNG, one bit at a time to avoid a table
+static uint32_t crc_update(uint32_t crc, const uint8_t *data, uint16_t len)
+{
+    for(uint16_t i = 0; i < len; i++) {
+        crc ^= data[i];
+
+        for(int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t adler_update(uint32_t adler, const uint8_t *data, uint16_t len)
+{
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+
+    for(uint16_t i = 0; i < len; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    return (b << 16) | a;
+}
+
+static uint16_t screenshot_row_bytes(const struct screenshot *screenshot)
+{
+    return (screenshot->format.width + 7) / 8;
+}
+
+// PNG rows start with a filter type byte
+static uint16_t screenshot_row_len(const struct screenshot *screenshot)
+{
+    return screenshot_row_bytes(screenshot) + ((screenshot->type == SCREENSHOT_PNG) ? 1 : 0);
+}
+
+// Length of the rows of the image
+static uint16_t screenshot_data_len(const struct screenshot *screenshot)
+{
+    return screenshot->format.height * screenshot_row_len(screenshot);
+}
+
+static uint16_t pbm_header(const struct screenshot *screenshot, uint8_t *buf, uint16_t len)
+{
+    return snprintf((char *) buf, len, "P4\n%d %d\n", screenshot->format.width, screenshot->format.height);
+}
+
+static uint16_t png_header(struct screenshot *screenshot, uint8_t *buf)
+{
+    const uint16_t data_len = screenshot_data_len(screenshot);
+    const uint16_t data_nlen = ~data_len;
+    uint8_t *p = buf;
+
+    memcpy(p, png_signature, sizeof(png_signature));
+    p += sizeof(png_signature);
+
+    // One bit greyscale, no interlacing
+    uint8_t *chunk = p;
+    p = put32(p, 13);
+    memcpy(p, "IHDR", 4);
+    p = put32(p + 4, screenshot->format.width);
+    p = put32(p, screenshot->format.height);
+    *p++ = 1;
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 0;
+    p = put32(p, ~crc_update(0xFFFFFFFF, chunk + 4, p - chunk - 4));
+
+    // A zlib stream with a single stored block
+    chunk = p;
+    p = put32(p, 2 + 5 + data_len + 4);
+    memcpy(p, "IDAT", 4);
+    p += 4;
+    *p++ = 0x78;
+    *p++ = 0x01;
+    *p++ = 0x01;
+    *p++ = data_len & 0xFF;
+    *p++ = data_len >> 8;
+    *p++ = data_nlen & 0xFF;
+    *p++ = data_nlen >> 8;
+
+    screenshot->crc = crc_update(0xFFFFFFFF, chunk + 4, p - chunk - 4);
+    screenshot->adler = 1;
+
+    return p - buf;
+}
+
+static uint16_t png_trailer(struct screenshot *screenshot, uint8_t *buf)
+{
+    uint8_t *p = put32(buf, screenshot->adler);
+
+    screenshot->crc = crc_update(screenshot->crc, buf, 4);
+
+    p = put32(p, ~screenshot->crc);
+
+    memcpy(p, png_iend, sizeof(png_iend));
+    p += sizeof(png_iend);
+
+    return p - buf;
+}
+
+static void screenshot_row(struct screenshot *screenshot, uint16_t y, uint8_t *buf)
+{
+    const struct display_codec_format *format = &screenshot->format;
+    uint8_t *row = buf;
+
+    if(screenshot->type == SCREENSHOT_PNG) {
+        *row++ = 0;
+    }
+
+    for(uint16_t x = 0; x < format->width; x += 8) {
+        uint8_t b = 0;
+
+        for(uint16_t i = 0; (i < 8) && (x + i < format->width); i++) {
+            if(display_codec_get_pixel(format, screenshot->frame, x + i, y)) {
+                b |= 0x80 >> i;
+            }
+        }
+
+        *row++ = b;
+    }
+
+    if(screenshot->type == SCREENSHOT_PNG) {
+        screenshot->crc = crc_update(screenshot->crc, buf, row - buf);
+        screenshot->adler = adler_update(screenshot->adler, buf, row - buf);
+    }
+}
+
+void screenshot_init(struct screenshot *screenshot, enum screenshot_type type, const struct display_codec_format *format, const uint8_t *frame)
+{
+    screenshot->type = type;
+    screenshot->format = *format;
+    screenshot->frame = frame;
+    screenshot->part = 0;
+    screenshot->crc = 0;
+    screenshot->adler = 0;
+}
+
+uint32_t screenshot_length(const struct screenshot *screenshot)
+{
+    if(screenshot->type == SCREENSHOT_PNG) {
+        return PNG_HEADER_LEN + screenshot_data_len(screenshot) + PNG_TRAILER_LEN;
+    } else {
+        uint8_t header[16];
+        return pbm_header(screenshot, header, sizeof(header)) + screenshot_data_len(screenshot);
+    }
+}
+
+uint16_t screenshot_read(struct screenshot *screenshot, uint8_t *buf, uint16_t len)
+{
+    const uint16_t height = screenshot->format.height;
+    const uint16_t row_len = screenshot_row_len(screenshot);
+    uint16_t n = 0;
+
+    if(screenshot->part == 0) {
+        if(screenshot->type == SCREENSHOT_PNG) {
+            n = png_header(screenshot, buf);
+        } else {
+            n = pbm_header(screenshot, buf, len);
+        }
+        screenshot->part++;
+    }
+
+    while((screenshot->part <= height) && (n + row_len <= len)) {
+        screenshot_row(screenshot, screenshot->part - 1, buf + n);
+        n += row_len;
+        screenshot->part++;
+    }
+
+    if(screenshot->part == height + 1) {
+        if(screenshot->type != SCREENSHOT_PNG) {
+            screenshot->part++;
+        } else if(n + PNG_TRAILER_LEN <= len) {
+            n += png_trailer(screenshot, buf + n);
+            screenshot->part++;
+        }
+    }
+
+    return n;
+}
@@ -0,0 +1,49 @@
+#ifndef SCREENSHOT_H_
+#define SCREENSHOT_H_
+
+#include <stdint.h>
+
+#include "display-codec.h"
+
+// Encode a frame as an image a few rows at a time, so that it can be
+// streamed through a small buffer.
+//
+// PBM images are binary (P4), with lit pixels black like display_pbm_write.
+// PNG images are one bit greyscale with lit pixels white, and the image data
+// is stored uncompressed in a single deflate block.
+
+enum screenshot_type {
+    SCREENSHOT_PBM,
+    SCREENSHOT_PNG,
+};
+
+// The smallest buffer screenshot_read accepts, enough for the PNG headers
+// and for a row of the widest frame
+#define SCREENSHOT_MIN_LEN 64
+
+struct screenshot
+{
+    enum screenshot_type type;
+    struct display_codec_format format;
+    const uint8_t *frame;
+
+    // The next part to write: 0 is the header, 1 to height the rows, and
+    // height + 1 the trailer
+    uint16_t part;
+
+    uint32_t crc;
+    uint32_t adler;
+};
+
+// The frame must stay unchanged until the whole image has been read
+void screenshot_init(struct screenshot *screenshot, enum screenshot_type type, const struct display_codec_format *format, const uint8_t *frame);
+
+// Total number of bytes of the image
+uint32_t screenshot_length(const struct screenshot *screenshot);
+
+// Write the next part of the image to buf, which is at least
+// SCREENSHOT_MIN_LEN bytes. Returns the number of bytes written, or 0 when
+// the whole image has been read.
+uint16_t screenshot_read(struct screenshot *screenshot, uint8_t *buf, uint16_t len);
+
+#endif
@@ -1,7 +1,8 @@
 // Based on https://github.com/SonalPinto/Arduino_SSD1306_OLED
 
 #include <stdint.h>
-#include <esp_common.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "i2c-master.h"
 
@@ -60,26 +61,121 @@ const uint8_t sh1106_init_seq[] = {
 
 #define OLED_START_COL 2
 
-void oled_display(void)
+// Unchanged bytes between two changed spans of a page are resent rather than
+// starting a new span if the gap is shorter than the cost of the extra
+// addressing transaction
+#define SH1106_MIN_GAP 8
+
+// Bytes on the bus for the transactions addressing a span, including the
+// I2C address bytes and the data control byte
+#define SH1106_SPAN_OVERHEAD 7
+
+// What the panel currently shows. Only valid after a complete frame has been
+// sent since the last sh1106_init.
+static uint8_t *sh1106_shadow;
+static uint8_t sh1106_shadow_valid;
+
+static uint16_t sh1106_frame_bytes;
+
+// The columns of each page to compare with the shadow by the next call to
+// sh1106_send_frame
+static uint8_t sh1106_dirty_start[OLED_HEIGHT / 8];
+static uint8_t sh1106_dirty_end[OLED_HEIGHT / 8];
+
+static void sh1106_send_span(const uint8_t *frame, uint8_t page, uint8_t start, uint8_t end)
 {
-    for(int y = 0; y < 8; y++) {
-        const uint8_t init_page[] = {
-            OLED_CONTROL_BYTE_CMD_STREAM,
-            OLED_CMD_COL_ADDRESS_LOW + OLED_START_COL,
-            OLED_CMD_COL_ADDRESS_HIGH,
-            OLED_CMD_PAGE_ADDRESS + y,
-        };
-
-        i2c_start(OLED_I2C_ADDRESS, I2C_WRITE);
-        i2c_write(init_page, sizeof(init_page));
-        i2c_stop();
-
-
-        i2c_start(OLED_I2C_ADDRESS, I2C_WRITE);
-        i2c_write_byte(OLED_CONTROL_BYTE_DATA_STREAM);
-        i2c_write(framebuffer + y * 128, 128);
-        i2c_stop();
+    const uint8_t col = start + OLED_START_COL;
+    const uint8_t init_page[] = {
+        OLED_CONTROL_BYTE_CMD_STREAM,
+        OLED_CMD_COL_ADDRESS_LOW + (col & 0x0F),
+        OLED_CMD_COL_ADDRESS_HIGH + (col >> 4),
+        OLED_CMD_PAGE_ADDRESS + page,
+    };
+    const uint8_t *data = frame + page * OLED_WIDTH + start;
+
+    i2c_start(OLED_I2C_ADDRESS, I2C_WRITE);
+    i2c_write(init_page, sizeof(init_page));
+    i2c_stop();
+
+    i2c_start(OLED_I2C_ADDRESS, I2C_WRITE);
+    i2c_write_byte(OLED_CONTROL_BYTE_DATA_STREAM);
+    i2c_write(data, end - start);
+    i2c_stop();
+
+    if(sh1106_shadow) {
+        memcpy(sh1106_shadow + page * OLED_WIDTH + start, data, end - start);
     }
+
+    sh1106_frame_bytes += SH1106_SPAN_OVERHEAD + end - start;
+}
+
+// Send the bytes of columns [start, end) of a page that differ from the
+// shadow, joining spans separated by less than SH1106_MIN_GAP bytes
+static void sh1106_send_changes(const uint8_t *frame, uint8_t page, uint8_t start, uint8_t end)
+{
+    const uint8_t *row = frame + page * OLED_WIDTH;
+    const uint8_t *shadow = sh1106_shadow + page * OLED_WIDTH;
+
+    uint8_t x = start;
+
+    for(;;) {
+        while((x < end) && (row[x] == shadow[x])) {
+            x++;
+        }
+
+        if(x == end) {
+            return;
+        }
+
+        const uint8_t span_start = x;
+        uint8_t span_end = ++x;
+
+        while((x < end) && (x - span_end < SH1106_MIN_GAP)) {
+            if(row[x] != shadow[x]) {
+                span_end = x + 1;
+            }
+            x++;
+        }
+
+        sh1106_send_span(frame, page, span_start, span_end);
+    }
+}
+
+void sh1106_prepare_frame(void)
+{
+    for(int page = 0; page < OLED_HEIGHT / 8; page++) {
+        if(!oled_get_dirty(page, &sh1106_dirty_start[page], &sh1106_dirty_end[page])) {
+            sh1106_dirty_start[page] = sh1106_dirty_end[page] = 0;
+        }
+    }
+
+    oled_clear_dirty();
+}
+
+void sh1106_send_frame(const uint8_t *frame)
+{
+    sh1106_frame_bytes = 0;
+
+    for(int page = 0; page < OLED_HEIGHT / 8; page++) {
+        if(!sh1106_shadow || !sh1106_shadow_valid) {
+            sh1106_send_span(frame, page, 0, OLED_WIDTH);
+        } else if(sh1106_dirty_start[page] < sh1106_dirty_end[page]) {
+            sh1106_send_changes(frame, page, sh1106_dirty_start[page], sh1106_dirty_end[page]);
+        }
+    }
+
+    sh1106_shadow_valid = 1;
+}
+
+void oled_display(void)
+{
+    sh1106_prepare_frame();
+    sh1106_send_frame(framebuffer);
+}
+
+uint16_t sh1106_get_frame_bytes(void)
+{
+    return sh1106_frame_bytes;
 }
 
 int sh1106_init(void)
@@ -88,6 +184,13 @@ int sh1106_init(void)
     if(!ret) {
         i2c_write(sh1106_init_seq, sizeof(sh1106_init_seq));
         fb_blit = oled_blit;
+
+        // The contents of the display RAM are unknown until the first
+        // complete frame has been sent
+        if(!sh1106_shadow) {
+            sh1106_shadow = malloc(OLED_SIZE);
+        }
+        sh1106_shadow_valid = 0;
     } else {
         LOG("No ACK");
     }
@@ -1,8 +1,20 @@
 #ifndef SH1106_h_
 #define SH1106_h_
 
+#include <stdint.h>
+
 #define SH1106_I2C_FREQ 800
 
 int sh1106_init(void);
 
+// oled_display split in two, for sending a frame that is no longer in
+// framebuffer. sh1106_prepare_frame takes the columns that may have changed
+// since the last frame, and must be called before framebuffer is drawn into
+// again.
+void sh1106_prepare_frame(void);
+void sh1106_send_frame(const uint8_t *frame);
+
+// Number of bytes sent over I2C for the last frame
+uint16_t sh1106_get_frame_bytes(void);
+
 #endif
@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "status-cache.h"
+#include "json-writer.h"
+#include "log.h"
+
+#define LOG_SYS LOG_SYS_HTTPD
+
+// Sections with a non-zero max age are rebuilt at least this often (in
+// seconds) even if nobody invalidated them. This is used for values which are
+// sampled rather than signalled, such as free heap, stack usage and RSSI.
+static const time_t status_cache_max_age[STATUS_NUM_SECTIONS] = {
+    [STATUS_SECTION_SYSTEM] = 10,
+    [STATUS_SECTION_WIFI] = 10,
+    [STATUS_SECTION_TIME] = 1,
+    [STATUS_SECTION_JOURNIES] = 0,
+    [STATUS_SECTION_DISPLAY] = 10,
+};
+
+// Tries at serializing a section whose data grows while it is written
+#define STATUS_CACHE_MAX_TRIES 3
+
+struct status_fragment {
+    char *data;
+    uint16_t len;
+    uint16_t version;
+    time_t updated;
+    volatile uint8_t dirty;
+};
+
+static struct status_fragment status_cache[STATUS_NUM_SECTIONS];
+static uint32_t status_cache_epoch;
+
+// The fragments are written as members of the top level object, so start the
+// writer one level down inside an object without a pending comma.
+static void begin_fragment(struct json_writer *json)
+{
+    json->current = 1;
+    json->stack[0] = JSON_WRITER_OBJECT;
+}
+
+void status_cache_init(uint32_t epoch)
+{
+    status_cache_epoch = epoch;
+
+    for(int i = 0; i < STATUS_NUM_SECTIONS; i++) {
+        free(status_cache[i].data);
+        status_cache[i].data = NULL;
+        status_cache[i].len = 0;
+        status_cache[i].version = 0;
+        status_cache[i].updated = 0;
+        status_cache[i].dirty = 1;
+    }
+}
+
+void status_cache_invalidate(enum status_section section)
+{
+    if(section < STATUS_NUM_SECTIONS) {
+        status_cache[section].dirty = 1;
+    }
+}
+
+// Rebuild the fragment of a section if it has been invalidated or has expired.
+// Returns 1 if the contents of the fragment changed.
+int status_cache_update(enum status_section section, status_section_writer writer, time_t now)
+{
+    struct status_fragment *fragment = &status_cache[section];
+
+    if(fragment->data && !fragment->dirty) {
+        time_t max_age = status_cache_max_age[section];
+
+        if(!max_age || ((now >= fragment->updated) && (now - fragment->updated < max_age))) {
+            return 0;
+        }
+    }
+
+    // Clear the flag before serializing, so that an invalidation while we are
+    // busy is not lost
+    fragment->dirty = 0;
+    fragment->updated = now;
+
+    struct json_writer json;
+    int len = 0;
+
+    json_writer_count_init(&json, &len);
+    begin_fragment(&json);
+    writer(&json);
+
+    // The data might have changed between the two passes. If it grew, try
+    // again with a larger buffer rather than caching a truncated fragment.
+    for(int i = 0; i < STATUS_CACHE_MAX_TRIES; i++) {
+        struct json_writer_buffer buffer;
+        char *data = malloc(len + 1);
+
+        if(!data) {
+            ERROR("Could not allocate %d bytes for status section %d", len + 1, section);
+            break;
+        }
+
+        json_writer_buffer_init(&json, &buffer, data, len);
+        begin_fragment(&json);
+        writer(&json);
+
+        if(buffer.overflow) {
+            len += buffer.overflow;
+            free(data);
+            continue;
+        }
+
+        len = buffer.pos;
+        data[len] = 0;
+
+        if(fragment->data && (fragment->len == len) && (memcmp(fragment->data, data, len) == 0)) {
+            free(data);
+            return 0;
+        }
+
+        free(fragment->data);
+        fragment->data = data;
+        fragment->len = len;
+        fragment->version++;
+
+        return 1;
+    }
+
+    // Keep the old fragment, and rebuild it on the next request
+    fragment->dirty = 1;
+
+    return 0;
+}
+
+uint16_t status_cache_get_version(enum status_section section)
+{
+    return status_cache[section].version;
+}
+
+const char *status_cache_get_etag(char *buf, int len)
+{
+    snprintf(buf, len, "\"%08x-%04x-%04x-%04x-%04x-%04x\"",
+             (unsigned) status_cache_epoch,
+             status_cache[STATUS_SECTION_SYSTEM].version,
+             status_cache[STATUS_SECTION_WIFI].version,
+             status_cache[STATUS_SECTION_TIME].version,
+             status_cache[STATUS_SECTION_JOURNIES].version,
+             status_cache[STATUS_SECTION_DISPLAY].version);
+
+    return buf;
+}
+
+int status_cache_get_length(void)
+{
+    int len = 2;
+    int num = 0;
+
+    for(int i = 0; i < STATUS_NUM_SECTIONS; i++) {
+        if(status_cache[i].len > 0) {
+            len += status_cache[i].len;
+            num++;
+        }
+    }
+
+    if(num > 1) {
+        len += num - 1;
+    }
+
+    return len;
+}
+
+void status_cache_write(struct json_writer *json)
+{
+    int first = 1;
+
+    json->write_string(json->user, "{");
+
+    for(int i = 0; i < STATUS_NUM_SECTIONS; i++) {
+        if(status_cache[i].len > 0) {
+            if(!first) {
+                json->write_string(json->user, ",");
+            }
+            json->write_string(json->user, status_cache[i].data);
+            first = 0;
+        }
+    }
+
+    json->write_string(json->user, "}");
+}
@@ -0,0 +1,39 @@
+#ifndef STATUS_CACHE_H_
+#define STATUS_CACHE_H_
+
+#include <stdint.h>
+#include <time.h>
+
+// The status document is built from a number of sections. Each section keeps
+// its last serialized fragment together with a version which is bumped only
+// when the fragment actually changes. Other tasks call
+// status_cache_invalidate() when the data behind a section changes, the
+// fragment is then rebuilt on the next request.
+
+#define STATUS_CACHE_ETAG_LEN 40
+
+enum status_section {
+    STATUS_SECTION_SYSTEM = 0,
+    STATUS_SECTION_WIFI,
+    STATUS_SECTION_TIME,
+    STATUS_SECTION_JOURNIES,
+    STATUS_SECTION_DISPLAY,
+
+    STATUS_NUM_SECTIONS,
+};
+
+struct json_writer;
+
+typedef void (*status_section_writer)(struct json_writer *json);
+
+void status_cache_init(uint32_t epoch);
+void status_cache_invalidate(enum status_section section);
+int status_cache_update(enum status_section section, status_section_writer writer, time_t now);
+
+uint16_t status_cache_get_version(enum status_section section);
+const char *status_cache_get_etag(char *buf, int len);
+
+int status_cache_get_length(void);
+void status_cache_write(struct json_writer *json);
+
+#endif
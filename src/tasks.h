@@ -0,0 +1,28 @@
+#ifndef TASKS_H_
+#define TASKS_H_
+
+#include <freertos/task.h>
+
+// The tasks whose stack high-water marks are shown in /api/status.json. Most
+// are created by user_init, the flush task by display_flush_init.
+
+#define MAX_TASKS 9
+
+#define TASK_WIFI 0
+#define TASK_DISPLAY 1
+#define TASK_SNTP 2
+#define TASK_TZDB 3
+#define TASK_JOURNEY 4
+#define TASK_HTTPD 5
+#define TASK_SYSLOG 6
+
+#define TASK_LED_MATRIX 7
+
+#define TASK_FLUSH 8
+
+extern xTaskHandle task_handle[MAX_TASKS];
+
+// Terminated by NULL
+extern const char *task_names[MAX_TASKS+1];
+
+#endif
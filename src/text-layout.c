@@ -0,0 +1,57 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "text-layout.h"
+#include "framebuffer.h"
+#include "fonts.h"
+
+void text_layout_init(struct text_layout *layout, const char *text, const uint8_t *font)
+{
+    uint8_t n = 0;
+
+    layout->font = font;
+    layout->num_lines = 0;
+    layout->width = 0;
+
+    strncpy(layout->text, text, sizeof(layout->text) - 1);
+    layout->text[sizeof(layout->text) - 1] = 0;
+
+    for(;;) {
+        const uint8_t start = n;
+
+        while(layout->text[n] && (layout->text[n] != '\n')) {
+            n++;
+        }
+
+        const uint8_t i = layout->num_lines++;
+
+        layout->line_start[i] = start;
+        layout->line_len[i] = n - start;
+        layout->line_width[i] = (n > start) ? fb_string_length(&layout->text[start], n - start, font) : 0;
+
+        if(layout->line_width[i] > layout->width) {
+            layout->width = layout->line_width[i];
+        }
+
+        if(!layout->text[n] || (layout->num_lines >= TEXT_LAYOUT_MAX_LINES)) {
+            break;
+        }
+
+        n++;
+    }
+
+    layout->height = layout->num_lines * font[FONT_HEIGHT_POS];
+}
+
+void text_layout_draw(const struct text_layout *layout, int16_t x, int16_t y)
+{
+    const uint8_t line_h = layout->font[FONT_HEIGHT_POS];
+
+    y -= layout->height / 2;
+
+    for(uint8_t i = 0; i < layout->num_lines; i++) {
+        if(layout->line_len[i]) {
+            fb_draw_string(x - layout->line_width[i] / 2, y + line_h * i + line_h / 2, &layout->text[layout->line_start[i]], layout->line_len[i], layout->font, FB_ALIGN_CENTER_V);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef TEXT_LAYOUT_H_
+#define TEXT_LAYOUT_H_
+
+#include <stdint.h>
+
+// A block of centered lines, such as the text of a message box. The text is
+// split and measured once, so that the layout can be redrawn on every frame
+// of an animation without rescanning it.
+
+#define TEXT_LAYOUT_MAX_LINES 4
+#define TEXT_LAYOUT_MAX_LEN 64
+
+struct text_layout
+{
+    const uint8_t *font;
+
+    // Copy of the text. Lines end in '\n' and lines beyond the last are left out
+    char text[TEXT_LAYOUT_MAX_LEN];
+
+    uint8_t num_lines;
+    uint8_t line_start[TEXT_LAYOUT_MAX_LINES];
+    uint8_t line_len[TEXT_LAYOUT_MAX_LINES];
+    uint16_t line_width[TEXT_LAYOUT_MAX_LINES];
+
+    // Size of the text block
+    uint16_t width;
+    uint16_t height;
+};
+
+void text_layout_init(struct text_layout *layout, const char *text, const uint8_t *font);
+
+// Draw the lines centered horizontally at x, with the text block centered
+// vertically at y
+void text_layout_draw(const struct text_layout *layout, int16_t x, int16_t y);
+
+#endif
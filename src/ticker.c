@@ -0,0 +1,162 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "ticker.h"
+#include "framebuffer.h"
+#include "fonts.h"
+
+static void ticker_rewind(struct ticker *ticker)
+{
+    ticker->next = 0;
+    ticker->next_char = 0;
+    ticker->glyph_column = 0;
+    ticker->gap = 0;
+    ticker->glyph = 0;
+    ticker->pos = 0;
+}
+
+void ticker_init(struct ticker *ticker, const uint8_t *font, uint16_t width)
+{
+    ticker->font = font;
+    ticker->pages = 1 + (font[FONT_HEIGHT_POS] - 1) / 8;
+    ticker->width = (width < TICKER_MAX_WIDTH) ? width : TICKER_MAX_WIDTH;
+
+    ticker->text[0] = 0;
+    ticker->len = 0;
+    ticker->round = 0;
+    ticker->start_ms = 0;
+
+    ticker_rewind(ticker);
+}
+
+void ticker_set_text(struct ticker *ticker, const char *text, uint32_t now_ms)
+{
+    if(!strncmp(ticker->text, text, sizeof(ticker->text) - 1)) {
+        return;
+    }
+
+    strncpy(ticker->text, text, sizeof(ticker->text) - 1);
+    ticker->text[sizeof(ticker->text) - 1] = 0;
+    ticker->len = strlen(ticker->text);
+
+    const uint16_t text_width = ticker->len ? fb_string_length(ticker->text, ticker->len, ticker->font) : 0;
+
+    ticker->round = (text_width > ticker->width) ? text_width + TICKER_GAP : 0;
+    ticker->start_ms = now_ms;
+
+    ticker_rewind(ticker);
+}
+
+// Render the next column of the text into dst, or just step past it if dst
+// is 0
+static void ticker_next_column(struct ticker *ticker, uint8_t *dst)
+{
+    while(!ticker->gap && (!ticker->glyph || (ticker->glyph_column >= ticker->glyph[FONT_JUMPTABLE_WIDTH]))) {
+        if(ticker->next_char >= ticker->len) {
+            ticker->gap = TICKER_GAP;
+            ticker->glyph = 0;
+            break;
+        }
+
+        ticker->glyph = fb_next_glyph(ticker->font, ticker->text, ticker->len, &ticker->next_char);
+        ticker->glyph_column = 0;
+    }
+
+    if(ticker->gap) {
+        if(dst) {
+            memset(dst, 0, ticker->pages);
+        }
+
+        if(!--ticker->gap) {
+            ticker->next_char = 0;
+        }
+    } else {
+        if(dst) {
+            const uint8_t *entry = ticker->glyph;
+            const uint16_t index = (entry[FONT_JUMPTABLE_MSB] << 8) | entry[FONT_JUMPTABLE_LSB];
+            const uint8_t *data = fb_font_glyphs(ticker->font) + index;
+
+            for(uint8_t i = 0; i < ticker->pages; i++) {
+                const uint16_t n = ticker->glyph_column * ticker->pages + i;
+
+                // Fonts leave out the trailing empty bytes of a glyph
+                dst[i] = ((index != 0xFFFF) && (n < entry[FONT_JUMPTABLE_SIZE])) ? data[n] : 0;
+            }
+        }
+
+        ticker->glyph_column++;
+    }
+
+    ticker->next++;
+}
+
+// Make the buffer hold the columns from pos to the right edge of the region
+static void ticker_fill(struct ticker *ticker, uint32_t pos)
+{
+    const uint32_t end = pos + ticker->width;
+
+    if(pos < ticker->pos) {
+        ticker_rewind(ticker);
+    }
+
+    ticker->pos = pos;
+
+    // The text is at its start at the beginning of every round, so whole
+    // rounds that were not drawn can be skipped at once
+    if(ticker->next + ticker->round <= pos) {
+        const uint32_t next = pos - pos % ticker->round;
+
+        ticker_rewind(ticker);
+        ticker->next = next;
+        ticker->pos = pos;
+    }
+
+    while(ticker->next < pos) {
+        ticker_next_column(ticker, 0);
+    }
+
+    while(ticker->next < end) {
+        ticker_next_column(ticker, ticker->columns + (ticker->next % ticker->width) * ticker->pages);
+    }
+}
+
+void ticker_draw(struct ticker *ticker, int16_t x, int16_t y, uint32_t now_ms, struct display_schedule *schedule)
+{
+    const uint8_t height = ticker->font[FONT_HEIGHT_POS];
+
+    if(!ticker->len) {
+        return;
+    }
+
+    if(!ticker->round) {
+        fb_draw_string(x + ticker->width / 2, y, ticker->text, ticker->len, ticker->font, FB_ALIGN_CENTER_H | FB_ALIGN_CENTER_V);
+        return;
+    }
+
+    const uint32_t round_ms = TICKER_HOLD_MS + ticker->round * TICKER_PIXEL_MS;
+    const uint32_t elapsed = now_ms - ticker->start_ms;
+    const uint32_t t = elapsed % round_ms;
+
+    uint32_t pos = (elapsed / round_ms) * ticker->round;
+
+    if(t < TICKER_HOLD_MS) {
+        display_schedule_in(schedule, TICKER_HOLD_MS - t);
+    } else {
+        pos += (t - TICKER_HOLD_MS) / TICKER_PIXEL_MS;
+        display_schedule_in(schedule, TICKER_PIXEL_MS - (t - TICKER_HOLD_MS) % TICKER_PIXEL_MS);
+    }
+
+    ticker_fill(ticker, pos);
+
+    // The visible window wraps around the end of the buffer
+    const uint16_t slot = pos % ticker->width;
+    const uint16_t first = ticker->width - slot;
+
+    y -= height / 2;
+
+    fb_blit(x, y, first, height, ticker->columns + slot * ticker->pages, first * ticker->pages);
+
+    if(slot) {
+        fb_blit(x + first, y, slot, height, ticker->columns, slot * ticker->pages);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef TICKER_H_
+#define TICKER_H_
+
+#include <stdint.h>
+
+#include "display-schedule.h"
+
+// A line of text that scrolls from right to left through a fixed region when
+// it is too wide for it, e.g. a long destination name. Each column of the
+// text is rendered once into a circular buffer as it scrolls into view, and a
+// frame only blits the visible window from the buffer. Text that fits is
+// drawn centered and does not move.
+//
+// The ticker takes plain fonts, as it copies the columns from the glyph data.
+
+#define TICKER_MAX_LEN 64
+
+// Largest region, and largest number of pages of the font
+#define TICKER_MAX_WIDTH 128
+#define TICKER_MAX_PAGES 2
+
+// Blank columns between the end of the text and the start of the next round
+#define TICKER_GAP 16
+
+// The text waits at the start for this long on each round, and then moves a
+// pixel every TICKER_PIXEL_MS
+#define TICKER_HOLD_MS 1500
+#define TICKER_PIXEL_MS 40
+
+struct ticker
+{
+    const uint8_t *font;
+    uint8_t pages;
+    uint16_t width;
+
+    char text[TICKER_MAX_LEN];
+    uint8_t len;
+
+    // Columns in a round, the text and the gap, or 0 if the text fits
+    uint16_t round;
+    uint32_t start_ms;
+
+    // The next column to render, counted from the start of the text without
+    // wrapping around, and where the text is at that column
+    uint32_t next;
+    uint8_t next_char;
+    uint8_t glyph_column;
+    uint8_t gap;
+    const uint8_t *glyph;
+
+    // The position of the left edge of the region, counted as next
+    uint32_t pos;
+
+    // Column n of the text is kept at column n % width
+    uint8_t columns[TICKER_MAX_WIDTH * TICKER_MAX_PAGES];
+};
+
+void ticker_init(struct ticker *ticker, const uint8_t *font, uint16_t width);
+
+// Changing the text starts it over from the beginning. Setting the same text
+// again leaves it scrolling.
+void ticker_set_text(struct ticker *ticker, const char *text, uint32_t now_ms);
+
+// Draw the region with its left edge at x, centered vertically at y, and ask
+// for the next frame when the text moves
+void ticker_draw(struct ticker *ticker, int16_t x, int16_t y, uint32_t now_ms, struct display_schedule *schedule);
+
+#endif
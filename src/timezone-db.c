@@ -11,6 +11,7 @@
 #include "timezone-db.h"
 #include "status.h"
 #include "log.h"
+#include "status-cache.h"
 
 #define LOG_SYS LOG_SYS_TZDB
 
@@ -40,6 +41,8 @@ void timezone_set_timezone(const char *name)
         nul_strncpy(timezone_name, name, TIMEZONE_NAME_LEN);
 
         timezone_next_update = time(0);
+
+        status_cache_invalidate(STATUS_SECTION_TIME);
     }
 }
 
@@ -89,6 +92,10 @@ static int set_timezone(const char *abbrev, int offset, time_t end)
         LOG("Next update at %s", buf);
 
         app_status.obtained_tz = 1;
+
+        // Dates in the status are formatted in local time
+        status_cache_invalidate(STATUS_SECTION_TIME);
+        status_cache_invalidate(STATUS_SECTION_JOURNIES);
     }
 
     return 0;
@@ -16,6 +16,7 @@
 #include "sntp.h"
 #include "keys.h"
 #include "status.h"
+#include "tasks.h"
 #include "wifi-task.h"
 #include "config.h"
 #include "display.h"
@@ -111,18 +112,6 @@ void spiffs_fs_init(void)
     }
 }
 
-#define MAX_TASKS 8
-
-#define TASK_WIFI 0
-#define TASK_DISPLAY 1
-#define TASK_SNTP 2
-#define TASK_TZDB 3
-#define TASK_JOURNEY 4
-#define TASK_HTTPD 5
-#define TASK_SYSLOG 6
-
-#define TASK_LED_MATRIX 7
-
 xTaskHandle task_handle[MAX_TASKS];
 const char *task_names[MAX_TASKS+1] = {
     [TASK_WIFI] = "wifi",
@@ -133,6 +122,7 @@ const char *task_names[MAX_TASKS+1] = {
     [TASK_HTTPD] = "httpd",
     [TASK_SYSLOG] = "syslog",
     [TASK_LED_MATRIX] = " led",
+    [TASK_FLUSH] = "flush",
     NULL
 };
 
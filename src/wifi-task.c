@@ -7,6 +7,7 @@
 #include "status.h"
 #include "keys.h"
 #include "log.h"
+#include "status-cache.h"
 
 #define LOG_SYS LOG_SYS_WIFI
 
@@ -182,10 +183,16 @@ void wifi_task(void *pvParameters)
     uint8_t wifi_event = WIFI_EVENT_NO_EVENT;
     for(;;)
     {
+        enum wifi_state old_state = wifi_state;
+
         wifi_take_mutex();
         wifi_handle_event(wifi_event);
         wifi_give_mutex();
 
+        if((wifi_event != WIFI_EVENT_NO_EVENT) || (wifi_state != old_state)) {
+            status_cache_invalidate(STATUS_SECTION_WIFI);
+        }
+
         if(!xQueueReceive(wifi_event_queue, &wifi_event, WIFI_TASK_TICK_RATE/portTICK_RATE_MS)) {
             wifi_event = WIFI_EVENT_NO_EVENT;
         }
@@ -0,0 +1,181 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <cmocka.h>
+
+#include "animation.h"
+
+//////// Global variables used for testing /////////////////////////////////////
+
+static const struct animation_step shift_out_in[] = {
+    { .from = 0, .to = 128, .duration_ms = 1280, .easing = ANIMATION_LINEAR },
+    { .from = 128, .to = 0, .duration_ms = 1280, .easing = ANIMATION_LINEAR },
+};
+
+static const struct animation_step move_up = { .from = 54, .to = 32, .duration_ms = 440, .easing = ANIMATION_LINEAR };
+
+//////// Test //////////////////////////////////////////////////////////////////
+
+static void test__animation_step_value__interpolates_linearly(void **state)
+{
+    assert_int_equal(0, animation_step_value(&shift_out_in[0], 0));
+    assert_int_equal(32, animation_step_value(&shift_out_in[0], 320));
+    assert_int_equal(64, animation_step_value(&shift_out_in[0], 640));
+    assert_int_equal(128, animation_step_value(&shift_out_in[0], 1280));
+    assert_int_equal(128, animation_step_value(&shift_out_in[0], 5000));
+}
+
+static void test__animation_step_value__interpolates_downwards(void **state)
+{
+    assert_int_equal(54, animation_step_value(&move_up, 0));
+    assert_int_equal(43, animation_step_value(&move_up, 220));
+    assert_int_equal(32, animation_step_value(&move_up, 440));
+}
+
+static void test__animation_step_value__eases_in_slowly(void **state)
+{
+    const struct animation_step step = { .from = 0, .to = 100, .duration_ms = 1000, .easing = ANIMATION_EASE_IN };
+
+    assert_int_equal(0, animation_step_value(&step, 0));
+    assert_int_equal(25, animation_step_value(&step, 500));
+    assert_int_equal(100, animation_step_value(&step, 1000));
+}
+
+static void test__animation_step_value__eases_out_slowly(void **state)
+{
+    const struct animation_step step = { .from = 0, .to = 100, .duration_ms = 1000, .easing = ANIMATION_EASE_OUT };
+
+    assert_int_equal(0, animation_step_value(&step, 0));
+    assert_int_equal(75, animation_step_value(&step, 500));
+    assert_int_equal(100, animation_step_value(&step, 1000));
+}
+
+static void test__animation_step_value__eases_in_and_out_symmetrically(void **state)
+{
+    const struct animation_step step = { .from = 0, .to = 100, .duration_ms = 1000, .easing = ANIMATION_EASE_IN_OUT };
+
+    assert_int_equal(0, animation_step_value(&step, 0));
+    assert_int_equal(13, animation_step_value(&step, 250));
+    assert_int_equal(50, animation_step_value(&step, 500));
+    assert_int_equal(88, animation_step_value(&step, 750));
+    assert_int_equal(100, animation_step_value(&step, 1000));
+}
+
+static void test__animation_update__runs_through_the_steps(void **state)
+{
+    struct animation anim = { 0 };
+    int16_t x = -1;
+
+    animation_start(&anim, &x, shift_out_in, 2, 10000);
+    assert_int_equal(0, x);
+    assert_int_equal(1, animation_active());
+
+    assert_int_equal(0, animation_update(&anim, 10640));
+    assert_int_equal(64, x);
+
+    assert_int_equal(1, animation_update(&anim, 11280));
+    assert_int_equal(128, x);
+
+    assert_int_equal(1, animation_update(&anim, 11920));
+    assert_int_equal(64, x);
+
+    assert_int_equal(ANIMATION_DONE, animation_update(&anim, 12560));
+    assert_int_equal(0, x);
+    assert_int_equal(0, animation_active());
+}
+
+static void test__animation_update__skips_steps_when_frames_are_late(void **state)
+{
+    struct animation anim = { 0 };
+    int16_t x = -1;
+
+    animation_start(&anim, &x, shift_out_in, 2, 0);
+
+    assert_int_equal(1, animation_update(&anim, 1920));
+    assert_int_equal(64, x);
+
+    assert_int_equal(ANIMATION_DONE, animation_update(&anim, 100000));
+    assert_int_equal(0, x);
+    assert_int_equal(ANIMATION_DONE, animation_update(&anim, 100010));
+    assert_int_equal(0, animation_active());
+}
+
+static void test__animation_update__handles_tick_count_wrap_around(void **state)
+{
+    struct animation anim = { 0 };
+    int16_t x = -1;
+
+    animation_start(&anim, &x, shift_out_in, 2, 0xFFFFFF00);
+
+    assert_int_equal(0, animation_update(&anim, 0xFFFFFF00 + 640));
+    assert_int_equal(64, x);
+
+    animation_update(&anim, 0xFFFFFF00 + 2560);
+    assert_int_equal(0, animation_active());
+}
+
+static void test__animation_continue__starts_where_the_previous_sequence_ended(void **state)
+{
+    struct animation anim = { 0 };
+    int16_t x = -1;
+    int16_t y = -1;
+
+    animation_start(&anim, &x, shift_out_in, 1, 0);
+    assert_int_equal(ANIMATION_DONE, animation_update(&anim, 1300));
+    assert_int_equal(0, animation_active());
+
+    animation_continue(&anim, &y, &move_up, 1, 1300);
+    assert_int_equal(1, animation_active());
+
+    // 20 ms into the second animation
+    assert_int_equal(53, y);
+    assert_int_equal(128, x);
+
+    assert_int_equal(ANIMATION_DONE, animation_update(&anim, 1280 + 440));
+    assert_int_equal(32, y);
+    assert_int_equal(0, animation_active());
+}
+
+static void test__animation_active__counts_running_animations(void **state)
+{
+    struct animation a = { 0 };
+    struct animation b = { 0 };
+    int16_t x, y;
+
+    animation_start(&a, &x, shift_out_in, 2, 0);
+    animation_start(&b, &y, &move_up, 1, 0);
+    animation_start(&a, &x, shift_out_in, 2, 100);
+    assert_int_equal(2, animation_active());
+
+    animation_update(&b, 440);
+    assert_int_equal(1, animation_active());
+
+    animation_update(&a, 3000);
+    assert_int_equal(0, animation_active());
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_animation[] = {
+    cmocka_unit_test(test__animation_step_value__interpolates_linearly),
+    cmocka_unit_test(test__animation_step_value__interpolates_downwards),
+    cmocka_unit_test(test__animation_step_value__eases_in_slowly),
+    cmocka_unit_test(test__animation_step_value__eases_out_slowly),
+    cmocka_unit_test(test__animation_step_value__eases_in_and_out_symmetrically),
+    cmocka_unit_test(test__animation_update__runs_through_the_steps),
+    cmocka_unit_test(test__animation_update__skips_steps_when_frames_are_late),
+    cmocka_unit_test(test__animation_update__handles_tick_count_wrap_around),
+    cmocka_unit_test(test__animation_continue__starts_where_the_previous_sequence_ended),
+    cmocka_unit_test(test__animation_active__counts_running_animations),
+};
+
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_animation, NULL, NULL);
+
+    return fails;
+}
@@ -0,0 +1,250 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <cmocka.h>
+
+#include "display-codec.h"
+
+//////// Global variables used for testing /////////////////////////////////////
+
+static const struct display_codec_format oled_format = {
+    .layout = DISPLAY_CODEC_LAYOUT_PAGES,
+    .width = 128,
+    .height = 64,
+};
+
+static const struct display_codec_format matrix_format = {
+    .layout = DISPLAY_CODEC_LAYOUT_ROWS,
+    .width = 32,
+    .height = 32,
+};
+
+#define FRAME_LEN 1024
+// A delta of random data is larger than a keyframe
+#define BUF_LEN (DISPLAY_CODEC_HEADER_LEN + 2 * FRAME_LEN)
+
+static uint8_t prev[FRAME_LEN];
+static uint8_t frame[FRAME_LEN];
+static uint8_t decoded[FRAME_LEN];
+static uint8_t buf[BUF_LEN];
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static void fill_pattern(uint8_t *data, int len, uint32_t seed)
+{
+    for(int i = 0; i < len; i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = seed >> 16;
+    }
+}
+
+static void assert_delta_round_trip(const struct display_codec_format *format)
+{
+    const int len = display_codec_frame_len(format);
+
+    int n = display_codec_encode_delta(format, prev, frame, buf, BUF_LEN);
+    assert_true(n > 0);
+
+    memcpy(decoded, prev, len);
+    assert_int_equal(0, display_codec_decode(buf, n, decoded, len));
+    assert_memory_equal(frame, decoded, len);
+}
+
+//////// Test //////////////////////////////////////////////////////////////////
+
+static void test__display_codec_frame_len__returns_the_size_of_the_framebuffer(void **state)
+{
+    assert_int_equal(1024, display_codec_frame_len(&oled_format));
+    assert_int_equal(128, display_codec_frame_len(&matrix_format));
+}
+
+static void test__display_codec_get_pixel__reads_both_layouts(void **state)
+{
+    memset(frame, 0, FRAME_LEN);
+
+    // OLED: bit 3 of column 5 on page 2
+    frame[2 * 128 + 5] = 0x08;
+    assert_true(display_codec_get_pixel(&oled_format, frame, 5, 2 * 8 + 3));
+    assert_false(display_codec_get_pixel(&oled_format, frame, 5, 2 * 8 + 4));
+    assert_false(display_codec_get_pixel(&oled_format, frame, 6, 2 * 8 + 3));
+
+    // Matrix: the leftmost pixel is the MSB
+    memset(frame, 0, FRAME_LEN);
+    frame[7 * 4 + 2] = 0x80;
+    assert_true(display_codec_get_pixel(&matrix_format, frame, 16, 7));
+    assert_false(display_codec_get_pixel(&matrix_format, frame, 17, 7));
+    assert_false(display_codec_get_pixel(&matrix_format, frame, 16, 8));
+}
+
+static void test__display_codec_encode_keyframe__writes_header_and_frame(void **state)
+{
+    fill_pattern(frame, FRAME_LEN, 1);
+
+    int n = display_codec_encode_keyframe(&oled_format, frame, buf, BUF_LEN);
+
+    assert_int_equal(DISPLAY_CODEC_HEADER_LEN + FRAME_LEN, n);
+    assert_int_equal(DISPLAY_CODEC_KEYFRAME, buf[0]);
+    assert_int_equal(DISPLAY_CODEC_LAYOUT_PAGES, buf[1]);
+    assert_int_equal(128, buf[2]);
+    assert_int_equal(64, buf[3]);
+    assert_memory_equal(frame, buf + DISPLAY_CODEC_HEADER_LEN, FRAME_LEN);
+}
+
+static void test__display_codec_encode_keyframe__fails_if_buffer_is_too_small(void **state)
+{
+    assert_int_equal(-1, display_codec_encode_keyframe(&oled_format, frame, buf, DISPLAY_CODEC_HEADER_LEN + FRAME_LEN - 1));
+}
+
+static void test__display_codec_decode__decodes_keyframe(void **state)
+{
+    fill_pattern(frame, FRAME_LEN, 2);
+
+    int n = display_codec_encode_keyframe(&oled_format, frame, buf, BUF_LEN);
+
+    assert_int_equal(0, display_codec_decode(buf, n, decoded, FRAME_LEN));
+    assert_memory_equal(frame, decoded, FRAME_LEN);
+}
+
+static void test__display_codec_encode_delta__returns_zero_for_equal_frames(void **state)
+{
+    fill_pattern(prev, FRAME_LEN, 3);
+    memcpy(frame, prev, FRAME_LEN);
+
+    assert_int_equal(0, display_codec_encode_delta(&oled_format, prev, frame, buf, BUF_LEN));
+}
+
+static void test__display_codec_encode_delta__only_encodes_changed_pages(void **state)
+{
+    fill_pattern(prev, FRAME_LEN, 4);
+    memcpy(frame, prev, FRAME_LEN);
+
+    frame[3 * 128 + 10] ^= 0x01;
+
+    int n = display_codec_encode_delta(&oled_format, prev, frame, buf, BUF_LEN);
+
+    // Header, page mask, a run with one literal byte and the trailing skip
+    assert_int_equal(DISPLAY_CODEC_HEADER_LEN + 1 + 3 + 2, n);
+    assert_int_equal(DISPLAY_CODEC_DELTA, buf[0]);
+    assert_int_equal(1 << 3, buf[DISPLAY_CODEC_HEADER_LEN]);
+    assert_int_equal(10, buf[DISPLAY_CODEC_HEADER_LEN + 1]);
+    assert_int_equal(1, buf[DISPLAY_CODEC_HEADER_LEN + 2]);
+    assert_int_equal(0x01, buf[DISPLAY_CODEC_HEADER_LEN + 3]);
+    assert_int_equal(117, buf[DISPLAY_CODEC_HEADER_LEN + 4]);
+    assert_int_equal(0, buf[DISPLAY_CODEC_HEADER_LEN + 5]);
+}
+
+static void test__display_codec_encode_delta__joins_runs_separated_by_short_gaps(void **state)
+{
+    memset(prev, 0, FRAME_LEN);
+    memset(frame, 0, FRAME_LEN);
+
+    frame[0] = 1;
+    frame[3] = 1;
+    frame[127] = 1;
+
+    int n = display_codec_encode_delta(&oled_format, prev, frame, buf, BUF_LEN);
+
+    // [0, 4, 1, 0, 0, 1] [123, 1, 1]
+    assert_int_equal(DISPLAY_CODEC_HEADER_LEN + 1 + 6 + 3, n);
+    assert_delta_round_trip(&oled_format);
+}
+
+static void test__display_codec_encode_delta__fails_if_buffer_is_too_small(void **state)
+{
+    fill_pattern(prev, FRAME_LEN, 5);
+    fill_pattern(frame, FRAME_LEN, 6);
+
+    assert_int_equal(-1, display_codec_encode_delta(&oled_format, prev, frame, buf, FRAME_LEN));
+}
+
+static void test__display_codec_decode__decodes_delta_of_sparse_changes(void **state)
+{
+    fill_pattern(prev, FRAME_LEN, 7);
+    memcpy(frame, prev, FRAME_LEN);
+
+    for(int i = 0; i < FRAME_LEN; i += 37) {
+        frame[i] ^= 0xA5;
+    }
+
+    assert_delta_round_trip(&oled_format);
+}
+
+static void test__display_codec_decode__decodes_delta_of_whole_frame(void **state)
+{
+    fill_pattern(prev, FRAME_LEN, 8);
+    fill_pattern(frame, FRAME_LEN, 9);
+
+    assert_delta_round_trip(&oled_format);
+}
+
+static void test__display_codec_decode__decodes_delta_of_matrix_frame(void **state)
+{
+    fill_pattern(prev, 128, 10);
+    memcpy(frame, prev, 128);
+
+    frame[0] ^= 0xFF;
+    frame[64] ^= 0x10;
+    frame[127] ^= 0x80;
+
+    assert_delta_round_trip(&matrix_format);
+}
+
+static void test__display_codec_decode__rejects_wrong_frame_size(void **state)
+{
+    int n = display_codec_encode_keyframe(&matrix_format, frame, buf, BUF_LEN);
+
+    assert_int_equal(-1, display_codec_decode(buf, n, decoded, FRAME_LEN));
+}
+
+static void test__display_codec_decode__rejects_truncated_delta(void **state)
+{
+    fill_pattern(prev, FRAME_LEN, 11);
+    fill_pattern(frame, FRAME_LEN, 12);
+
+    int n = display_codec_encode_delta(&oled_format, prev, frame, buf, BUF_LEN);
+
+    memcpy(decoded, prev, FRAME_LEN);
+    assert_int_equal(-1, display_codec_decode(buf, n - 1, decoded, FRAME_LEN));
+}
+
+static void test__display_codec_decode__rejects_unknown_frame_type(void **state)
+{
+    int n = display_codec_encode_keyframe(&oled_format, frame, buf, BUF_LEN);
+    buf[0] = 0x55;
+
+    assert_int_equal(-1, display_codec_decode(buf, n, decoded, FRAME_LEN));
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_display_codec[] = {
+    cmocka_unit_test(test__display_codec_frame_len__returns_the_size_of_the_framebuffer),
+    cmocka_unit_test(test__display_codec_get_pixel__reads_both_layouts),
+
+    cmocka_unit_test(test__display_codec_encode_keyframe__writes_header_and_frame),
+    cmocka_unit_test(test__display_codec_encode_keyframe__fails_if_buffer_is_too_small),
+    cmocka_unit_test(test__display_codec_decode__decodes_keyframe),
+
+    cmocka_unit_test(test__display_codec_encode_delta__returns_zero_for_equal_frames),
+    cmocka_unit_test(test__display_codec_encode_delta__only_encodes_changed_pages),
+    cmocka_unit_test(test__display_codec_encode_delta__joins_runs_separated_by_short_gaps),
+    cmocka_unit_test(test__display_codec_encode_delta__fails_if_buffer_is_too_small),
+
+    cmocka_unit_test(test__display_codec_decode__decodes_delta_of_sparse_changes),
+    cmocka_unit_test(test__display_codec_decode__decodes_delta_of_whole_frame),
+    cmocka_unit_test(test__display_codec_decode__decodes_delta_of_matrix_frame),
+    cmocka_unit_test(test__display_codec_decode__rejects_wrong_frame_size),
+    cmocka_unit_test(test__display_codec_decode__rejects_truncated_delta),
+    cmocka_unit_test(test__display_codec_decode__rejects_unknown_frame_type),
+};
+
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_display_codec, NULL, NULL);
+
+    return fails;
+}
@@ -0,0 +1,149 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "display-host.h"
+#include "framebuffer.h"
+#include "oled_framebuffer.h"
+#include "matrix_framebuffer.h"
+#include "i2c-master.h"
+#include "log.h"
+
+//////// Stubs needed by the framebuffer code //////////////////////////////////
+
+const uint8_t paw_64x64[1];
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+void oled_display(void)
+{
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+#define PBM_FILE "test/results/display-host.pbm"
+
+static uint8_t pbm[16 + OLED_SIZE];
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+// Read back the file written by the PBM driver. Returns its length.
+static int read_pbm(void)
+{
+    FILE *f = fopen(PBM_FILE, "rb");
+    assert_non_null(f);
+
+    int len = fread(pbm, 1, sizeof(pbm), f);
+    fclose(f);
+
+    return len;
+}
+
+static int setup(void **state)
+{
+    fb_set_pen(FB_NORMAL);
+    remove(PBM_FILE);
+
+    return 0;
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__display_driver_select__should__draw_with_the_driver(void **state)
+{
+    display_driver_select(&display_null_matrix);
+
+    assert_ptr_equal(&display_null_matrix, display_driver);
+    assert_ptr_equal(matrix_blit, fb_blit);
+    assert_ptr_equal(matrix_clear, fb_clear);
+    assert_ptr_equal(matrix_fill_rect, fb_fill_rect);
+    assert_ptr_equal(matrix_blit_rows, fb_blit_native);
+    assert_int_equal(MATRIX_SIZE, display_driver_frame_len(display_driver));
+
+    display_driver_select(&display_null_oled);
+
+    assert_ptr_equal(&display_null_oled, display_driver);
+    assert_ptr_equal(oled_blit, fb_blit);
+    assert_ptr_equal(oled_clear, fb_clear);
+    assert_ptr_equal(oled_fill_rect, fb_fill_rect);
+    assert_ptr_equal(oled_blit, fb_blit_native);
+    assert_int_equal(OLED_SIZE, display_driver_frame_len(display_driver));
+}
+
+static void test__display_pbm_driver__should__write_matrix_rows_as_they_are(void **state)
+{
+    char header[16];
+
+    snprintf(header, sizeof(header), "P4\n%d %d\n", MATRIX_WIDTH, MATRIX_HEIGHT);
+
+    display_driver_select(display_pbm_driver(&display_null_matrix, PBM_FILE));
+
+    display_driver->clear();
+    display_driver->fill_rect(3, 2, 7, 4);
+    display_driver->flush(framebuffer);
+
+    assert_int_equal(strlen(header) + MATRIX_SIZE, read_pbm());
+    assert_memory_equal(header, pbm, strlen(header));
+    assert_memory_equal(framebuffer, pbm + strlen(header), MATRIX_SIZE);
+}
+
+static void test__display_pbm_driver__should__turn_oled_pages_into_rows(void **state)
+{
+    const char header[] = "P4\n128 64\n";
+
+    display_driver_select(display_pbm_driver(&display_null_oled, PBM_FILE));
+
+    display_driver->clear();
+    oled_set_pixel(0, 0);
+    oled_set_pixel(9, 13);
+    oled_set_pixel(127, 63);
+    display_driver->flush(framebuffer);
+
+    assert_int_equal(strlen(header) + OLED_SIZE, read_pbm());
+    assert_memory_equal(header, pbm, strlen(header));
+
+    const uint8_t *rows = pbm + strlen(header);
+
+    for(int i = 0; i < OLED_SIZE; i++) {
+        if(i == 0) {
+            assert_int_equal(0x80, rows[i]);
+        } else if(i == 13 * 16 + 1) {
+            assert_int_equal(0x40, rows[i]);
+        } else if(i == OLED_SIZE - 1) {
+            assert_int_equal(0x01, rows[i]);
+        } else {
+            assert_int_equal(0x00, rows[i]);
+        }
+    }
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_display_host[] = {
+    cmocka_unit_test_setup(test__display_driver_select__should__draw_with_the_driver, setup),
+    cmocka_unit_test_setup(test__display_pbm_driver__should__write_matrix_rows_as_they_are, setup),
+    cmocka_unit_test_setup(test__display_pbm_driver__should__turn_oled_pages_into_rows, setup),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_display_host, NULL, NULL);
+
+    return fails;
+}
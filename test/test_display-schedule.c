@@ -0,0 +1,117 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <cmocka.h>
+
+#include "display-schedule.h"
+
+//////// Test //////////////////////////////////////////////////////////////////
+
+static void test__display_schedule_init__waits_the_maximum_delay(void **state)
+{
+    struct display_schedule schedule;
+
+    display_schedule_init(&schedule);
+
+    assert_int_equal(DISPLAY_SCHEDULE_MAX_DELAY_MS, display_schedule_delay_ms(&schedule));
+}
+
+static void test__display_schedule_in__keeps_the_earliest_instant(void **state)
+{
+    struct display_schedule schedule;
+
+    display_schedule_init(&schedule);
+    display_schedule_in(&schedule, 400);
+    display_schedule_in(&schedule, 25);
+    display_schedule_in(&schedule, 300);
+
+    assert_int_equal(25, display_schedule_delay_ms(&schedule));
+}
+
+static void test__display_schedule_in__does_not_exceed_the_maximum_delay(void **state)
+{
+    struct display_schedule schedule;
+
+    display_schedule_init(&schedule);
+    display_schedule_in(&schedule, 60000);
+
+    assert_int_equal(DISPLAY_SCHEDULE_MAX_DELAY_MS, display_schedule_delay_ms(&schedule));
+}
+
+static void test__display_schedule_every__waits_for_the_next_multiple_of_the_period(void **state)
+{
+    struct display_schedule schedule;
+
+    display_schedule_init(&schedule);
+    display_schedule_every(&schedule, 1030, 250);
+
+    assert_int_equal(220, display_schedule_delay_ms(&schedule));
+}
+
+static void test__display_schedule_every__waits_a_whole_period_on_a_multiple(void **state)
+{
+    struct display_schedule schedule;
+
+    display_schedule_init(&schedule);
+    display_schedule_every(&schedule, 1000, 250);
+
+    assert_int_equal(250, display_schedule_delay_ms(&schedule));
+}
+
+static void test__display_schedule_clock__waits_for_the_next_second(void **state)
+{
+    struct display_schedule schedule;
+    struct timeval now = { .tv_sec = 1000, .tv_usec = 123456 };
+
+    display_schedule_init(&schedule);
+    display_schedule_clock(&schedule, &now, 1);
+
+    assert_int_equal(877, display_schedule_delay_ms(&schedule));
+}
+
+static void test__display_schedule_clock__waits_for_the_next_minute(void **state)
+{
+    struct display_schedule schedule;
+    struct timeval now = { .tv_sec = 60 * 1000 + 59, .tv_usec = 500000 };
+
+    display_schedule_init(&schedule);
+    display_schedule_clock(&schedule, &now, 60);
+
+    assert_int_equal(500, display_schedule_delay_ms(&schedule));
+}
+
+static void test__display_schedule_clock__does_not_move_an_earlier_instant(void **state)
+{
+    struct display_schedule schedule;
+    struct timeval now = { .tv_sec = 1000, .tv_usec = 0 };
+
+    display_schedule_init(&schedule);
+    display_schedule_in(&schedule, DISPLAY_SCHEDULE_ANIMATION_MS);
+    display_schedule_clock(&schedule, &now, 1);
+
+    assert_int_equal(DISPLAY_SCHEDULE_ANIMATION_MS, display_schedule_delay_ms(&schedule));
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_display_schedule[] = {
+    cmocka_unit_test(test__display_schedule_init__waits_the_maximum_delay),
+    cmocka_unit_test(test__display_schedule_in__keeps_the_earliest_instant),
+    cmocka_unit_test(test__display_schedule_in__does_not_exceed_the_maximum_delay),
+    cmocka_unit_test(test__display_schedule_every__waits_for_the_next_multiple_of_the_period),
+    cmocka_unit_test(test__display_schedule_every__waits_a_whole_period_on_a_multiple),
+    cmocka_unit_test(test__display_schedule_clock__waits_for_the_next_second),
+    cmocka_unit_test(test__display_schedule_clock__waits_for_the_next_minute),
+    cmocka_unit_test(test__display_schedule_clock__does_not_move_an_earlier_instant),
+};
+
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_display_schedule, NULL, NULL);
+
+    return fails;
+}
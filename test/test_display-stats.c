@@ -0,0 +1,173 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <cmocka.h>
+
+#include "display-stats.h"
+#include "json-writer.h"
+
+//////// Stubs /////////////////////////////////////////////////////////////////
+
+int http_write_string(struct http_request *request, const char *str)
+{
+    return strlen(str);
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+#define CPU_MHZ 80
+#define US(us) ((us) * CPU_MHZ)
+#define MS(ms) US(1000 * (ms))
+
+char *output_string = 0;
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static int output_write_string(void *user, const char *str)
+{
+    strcat(output_string, str);
+    return strlen(str);
+}
+
+static void write_stats(void)
+{
+    struct json_writer json = {
+        .current = 0,
+        .user = NULL,
+        .write_string = output_write_string,
+    };
+
+    display_stats_write(&json);
+}
+
+//////// Test //////////////////////////////////////////////////////////////////
+
+static void test__display_stats_add_render__keeps_min_max_and_total(void **state)
+{
+    display_stats_add_render(US(300));
+    display_stats_add_render(US(100));
+    display_stats_add_render(US(500));
+
+    assert_int_equal(3, display_stats.render.count);
+    assert_int_equal(US(100), display_stats.render.min_cycles);
+    assert_int_equal(US(500), display_stats.render.max_cycles);
+    assert_int_equal(US(900), display_stats.render.total_cycles);
+    assert_int_equal(0, display_stats.transfer.count);
+}
+
+static void test__display_stats_add__starts_the_average_over_instead_of_wrapping(void **state)
+{
+    display_stats_add_render(0xC0000000);
+    display_stats_add_render(0x80000000);
+
+    assert_int_equal(2, display_stats.render.count);
+    assert_int_equal(1, display_stats.render.total_count);
+    assert_int_equal(0x80000000, display_stats.render.total_cycles);
+}
+
+static void test__display_stats_add_transfer__counts_the_bytes(void **state)
+{
+    display_stats_add_transfer(US(2000), 132);
+    display_stats_add_transfer(US(1000), 68);
+
+    assert_int_equal(2, display_stats.transfer.count);
+    assert_int_equal(200, display_stats.bytes);
+}
+
+static void test__display_stats_add__bins_the_times_by_powers_of_two_milliseconds(void **state)
+{
+    const struct display_stats_timing *timing = &display_stats.render;
+
+    display_stats_add_render(US(999));
+    display_stats_add_render(MS(1));
+    display_stats_add_render(MS(3));
+    display_stats_add_render(MS(4));
+    display_stats_add_render(MS(7));
+    display_stats_add_render(MS(1000));
+
+    assert_int_equal(1, timing->histogram[0]);
+    assert_int_equal(1, timing->histogram[1]);
+    assert_int_equal(1, timing->histogram[2]);
+    assert_int_equal(2, timing->histogram[3]);
+    assert_int_equal(0, timing->histogram[DISPLAY_STATS_HISTOGRAM_BINS - 2]);
+    assert_int_equal(1, timing->histogram[DISPLAY_STATS_HISTOGRAM_BINS - 1]);
+}
+
+static void test__display_stats_init__clears_the_counters(void **state)
+{
+    display_stats_add_render(US(10));
+    display_stats_add_transfer(US(10), 10);
+    display_stats_add_retry();
+    display_stats_add_skipped(2);
+
+    display_stats_init(160);
+
+    assert_int_equal(160, display_stats.cpu_mhz);
+    assert_int_equal(0, display_stats.render.count);
+    assert_int_equal(0, display_stats.transfer.total_cycles);
+    assert_int_equal(0, display_stats.bytes);
+    assert_int_equal(0, display_stats.retries);
+    assert_int_equal(0, display_stats.skipped);
+}
+
+static void test__display_stats_write__leaves_out_the_times_before_the_first_frame(void **state)
+{
+    write_stats();
+
+    assert_string_equal("\"display\":{"
+                        "\"render\":{\"count\":0,\"histogram-ms\":[0,0,0,0,0,0,0,0]},"
+                        "\"transfer\":{\"count\":0,\"histogram-ms\":[0,0,0,0,0,0,0,0]},"
+                        "\"bytes\":0,\"retries\":0,\"skipped\":0}", output_string);
+}
+
+static void test__display_stats_write__writes_the_times_in_microseconds(void **state)
+{
+    display_stats_add_render(US(200));
+    display_stats_add_render(US(400));
+    display_stats_add_transfer(MS(3), 100);
+    display_stats_add_transfer(MS(5), 50);
+    display_stats_add_retry();
+    display_stats_add_skipped(3);
+
+    write_stats();
+
+    assert_string_equal("\"display\":{"
+                        "\"render\":{\"count\":2,\"min-us\":200,\"avg-us\":300,\"max-us\":400,\"histogram-ms\":[2,0,0,0,0,0,0,0]},"
+                        "\"transfer\":{\"count\":2,\"min-us\":3000,\"avg-us\":4000,\"max-us\":5000,\"histogram-ms\":[0,0,1,1,0,0,0,0]},"
+                        "\"bytes\":150,\"bytes-per-frame\":75,\"retries\":1,\"skipped\":3}", output_string);
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+int setup(void **state)
+{
+    output_string = calloc(1024, 1);
+    display_stats_init(CPU_MHZ);
+    return 0;
+}
+
+int teardown(void **state)
+{
+    free(output_string);
+    return 0;
+}
+
+const struct CMUnitTest tests_for_display_stats[] = {
+    cmocka_unit_test_setup_teardown(test__display_stats_add_render__keeps_min_max_and_total, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__display_stats_add__starts_the_average_over_instead_of_wrapping, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__display_stats_add_transfer__counts_the_bytes, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__display_stats_add__bins_the_times_by_powers_of_two_milliseconds, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__display_stats_init__clears_the_counters, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__display_stats_write__leaves_out_the_times_before_the_first_frame, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__display_stats_write__writes_the_times_in_microseconds, setup, teardown),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_display_stats, NULL, NULL);
+
+    return fails;
+}
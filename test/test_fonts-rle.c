@@ -0,0 +1,240 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "framebuffer.h"
+#include "oled_framebuffer.h"
+#include "matrix_framebuffer.h"
+#include "fonts.h"
+#include "glyph-cache.h"
+#include "i2c-master.h"
+#include "log.h"
+
+//////// Stubs needed by the framebuffer code //////////////////////////////////
+
+const uint8_t paw_64x64[1];
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+void oled_display(void)
+{
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+static const struct {
+    const uint8_t *plain;
+    const uint8_t *rle;
+} fonts[] = {
+    { Monospaced_bold_16, Monospaced_bold_16_rle },
+};
+
+#define NUM_FONTS (sizeof(fonts) / sizeof(fonts[0]))
+
+static const char *strings[] = { "12:34", "--:--", "Connect to", "192.168.1.20", "Åkersberga", "gjpqy", "-- 09:58 --" };
+
+#define NUM_STRINGS (sizeof(strings) / sizeof(strings[0]))
+
+static uint8_t reference[OLED_SIZE];
+static uint8_t background[OLED_SIZE];
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static const uint8_t *jump_table_entry(const uint8_t *font, int n)
+{
+    return font + FONT_JUMPTABLE_START + n * FONT_JUMPTABLE_BYTES;
+}
+
+static const uint8_t *glyph_data(const uint8_t *font, const uint8_t *entry)
+{
+    const uint16_t index = (entry[FONT_JUMPTABLE_MSB] << 8) | entry[FONT_JUMPTABLE_LSB];
+
+    return fb_font_glyphs(font) + index;
+}
+
+// Leave out the characters that the font does not have
+static void filter_string(char *dst, const char *text, const uint8_t *font)
+{
+    for(; *text; text++) {
+        if(fb_font_entry(font, *text)) {
+            *dst++ = *text;
+        }
+    }
+    *dst = 0;
+}
+
+// Draw the string with the plain and the encoded font on the same
+// background, and check that the framebuffers are equal. The characters
+// missing from a sparse font are not drawn.
+static void assert_same_drawing(int size, int16_t x, int16_t y, const char *text, int font, enum fb_pen pen)
+{
+    char filtered[strlen(text) + 1];
+
+    filter_string(filtered, text, fonts[font].rle);
+
+    fb_set_pen(pen);
+
+    memcpy(framebuffer, background, size);
+    fb_draw_string(x, y, filtered, 0, fonts[font].plain, FB_ALIGN_NONE);
+    memcpy(reference, framebuffer, size);
+
+    memcpy(framebuffer, background, size);
+    fb_draw_string(x, y, text, 0, fonts[font].rle, FB_ALIGN_NONE);
+
+    assert_memory_equal(reference, framebuffer, size);
+}
+
+static int setup(void **state)
+{
+    srand(1);
+
+    for(int i = 0; i < OLED_SIZE; i++) {
+        background[i] = rand();
+    }
+
+    return 0;
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__fonts_rle__should__keep_header_and_widths(void **state)
+{
+    for(int f = 0; f < NUM_FONTS; f++) {
+        const uint8_t *plain = fonts[f].plain;
+        const uint8_t *rle = fonts[f].rle;
+        int num = 0;
+
+        assert_int_equal(plain[FONT_WIDTH_POS], rle[FONT_WIDTH_POS] & FONT_WIDTH_MASK);
+        assert_true(rle[FONT_WIDTH_POS] & FONT_RLE_FLAG);
+        assert_int_equal(plain[FONT_HEIGHT_POS], rle[FONT_HEIGHT_POS]);
+
+        for(int c = 0; c < 256; c++) {
+            const uint8_t *plain_entry = fb_font_entry(plain, c);
+            const uint8_t *rle_entry = fb_font_entry(rle, c);
+
+            if(rle_entry) {
+                assert_non_null(plain_entry);
+                assert_int_equal(plain_entry[FONT_JUMPTABLE_WIDTH], rle_entry[FONT_JUMPTABLE_WIDTH]);
+                num++;
+            }
+        }
+
+        assert_int_equal(rle[FONT_CHAR_NUM_POS], num);
+    }
+}
+
+static void test__fonts_rle__should__hold_the_glyph_cache_chars(void **state)
+{
+    for(const char *c = GLYPH_CACHE_CHARS; *c; c++) {
+        assert_non_null(fb_font_entry(Monospaced_bold_16_rle, *c));
+    }
+
+    assert_null(fb_font_entry(Monospaced_bold_16_rle, 'A'));
+    assert_null(fb_font_entry(Monospaced_bold_16_rle, '~'));
+    assert_null(fb_font_entry(Monospaced_bold_16_rle, 0xC5));
+}
+
+static void test__fb_string_length__should__skip_chars_missing_from_sparse_font(void **state)
+{
+    assert_int_equal(fb_string_length("12:34", 0, Monospaced_bold_16), fb_string_length("12:34", 0, Monospaced_bold_16_rle));
+    assert_int_equal(fb_string_length("12:34", 0, Monospaced_bold_16_rle), fb_string_length("1x2:A3#4", 0, Monospaced_bold_16_rle));
+    assert_int_equal(0, fb_string_length("abc", 0, Monospaced_bold_16_rle));
+}
+
+static void test__fb_decode_glyph_rle__should__give_plain_glyphs(void **state)
+{
+    for(int f = 0; f < NUM_FONTS; f++) {
+        const uint8_t *plain = fonts[f].plain;
+        const uint8_t *rle = fonts[f].rle;
+        const uint8_t height = plain[FONT_HEIGHT_POS];
+        const uint8_t raster_height = 1 + (height - 1) / 8;
+
+        for(int n = 0; n < plain[FONT_CHAR_NUM_POS]; n++) {
+            const uint8_t *plain_entry = jump_table_entry(plain, n);
+            const uint8_t *rle_entry = fb_font_entry(rle, plain[FONT_FIRST_CHAR_POS] + n);
+            const uint8_t width = plain_entry[FONT_JUMPTABLE_WIDTH];
+            uint8_t expected[255] = { 0 };
+            uint8_t decoded[255] = { 0 };
+
+            if(!rle_entry) {
+                continue;
+            }
+
+            if(plain_entry[FONT_JUMPTABLE_MSB] == 0xFF) {
+                assert_int_equal(0xFF, rle_entry[FONT_JUMPTABLE_MSB]);
+                continue;
+            }
+
+            memcpy(expected, glyph_data(plain, plain_entry), plain_entry[FONT_JUMPTABLE_SIZE]);
+            fb_decode_glyph_rle(decoded, height, glyph_data(rle, rle_entry), rle_entry[FONT_JUMPTABLE_SIZE]);
+
+            assert_memory_equal(expected, decoded, width * raster_height);
+        }
+    }
+}
+
+static void test__fb_draw_string__should__draw_rle_font_like_plain_font_on_oled(void **state)
+{
+    fb_blit = oled_blit;
+
+    for(int f = 0; f < NUM_FONTS; f++) {
+        for(int i = 0; i < NUM_STRINGS; i++) {
+            for(int n = 0; n < 50; n++) {
+                const int16_t x = rand() % (OLED_WIDTH + 80) - 60;
+                const int16_t y = rand() % (OLED_HEIGHT + 40) - 20;
+
+                assert_same_drawing(OLED_SIZE, x, y, strings[i], f, (n & 1) ? FB_NORMAL : FB_INVERSE);
+            }
+        }
+    }
+}
+
+static void test__fb_draw_string__should__draw_rle_font_like_plain_font_on_matrix(void **state)
+{
+    fb_blit = matrix_blit;
+
+    for(int f = 0; f < NUM_FONTS; f++) {
+        for(int i = 0; i < NUM_STRINGS; i++) {
+            for(int n = 0; n < 50; n++) {
+                const int16_t x = rand() % (MATRIX_WIDTH + 80) - 60;
+                const int16_t y = rand() % (MATRIX_HEIGHT + 40) - 20;
+
+                assert_same_drawing(MATRIX_SIZE, x, y, strings[i], f, (n & 1) ? FB_NORMAL : FB_INVERSE);
+            }
+        }
+    }
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_fonts_rle[] = {
+    cmocka_unit_test(test__fonts_rle__should__keep_header_and_widths),
+    cmocka_unit_test(test__fonts_rle__should__hold_the_glyph_cache_chars),
+    cmocka_unit_test(test__fb_string_length__should__skip_chars_missing_from_sparse_font),
+    cmocka_unit_test(test__fb_decode_glyph_rle__should__give_plain_glyphs),
+    cmocka_unit_test_setup(test__fb_draw_string__should__draw_rle_font_like_plain_font_on_oled, setup),
+    cmocka_unit_test_setup(test__fb_draw_string__should__draw_rle_font_like_plain_font_on_matrix, setup),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_fonts_rle, NULL, NULL);
+
+    return fails;
+}
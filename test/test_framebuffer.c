@@ -0,0 +1,151 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "framebuffer.h"
+#include "oled_framebuffer.h"
+#include "fonts.h"
+#include "i2c-master.h"
+#include "log.h"
+
+//////// Stubs needed by the framebuffer code //////////////////////////////////
+
+const uint8_t paw_64x64[1];
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+void oled_display(void)
+{
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+static uint8_t reference[OLED_SIZE];
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static uint8_t glyph_width(const uint8_t *font, uint8_t c)
+{
+    return font[FONT_JUMPTABLE_START + (c - font[FONT_FIRST_CHAR_POS]) * FONT_JUMPTABLE_BYTES + FONT_JUMPTABLE_WIDTH];
+}
+
+// Draw the glyphs for the codes one by one, the way fb_draw_string does
+static void draw_glyphs(int16_t x, int16_t y, const uint8_t *codes, int num, const uint8_t *font)
+{
+    const uint8_t *glyphs = fb_font_glyphs(font);
+
+    for(int i = 0; i < num; i++) {
+        const uint8_t *entry = fb_font_entry(font, codes[i]);
+        const uint16_t index = (entry[FONT_JUMPTABLE_MSB] << 8) | entry[FONT_JUMPTABLE_LSB];
+
+        if(index != 0xFFFF) {
+            fb_blit(x, y, entry[FONT_JUMPTABLE_WIDTH], font[FONT_HEIGHT_POS], glyphs + index, entry[FONT_JUMPTABLE_SIZE]);
+        }
+        x += entry[FONT_JUMPTABLE_WIDTH];
+    }
+}
+
+static void assert_draws_glyphs(const uint8_t *codes, int num, const char *text, const uint8_t *font)
+{
+    oled_clear();
+    draw_glyphs(10, 20, codes, num, font);
+    memcpy(reference, framebuffer, OLED_SIZE);
+
+    oled_clear();
+    fb_draw_string(10, 20, text, 0, font, FB_ALIGN_NONE);
+
+    assert_memory_equal(reference, framebuffer, OLED_SIZE);
+}
+
+static void assert_same_drawing(const char *expected, const char *text, const uint8_t *font)
+{
+    oled_clear();
+    fb_draw_string(10, 20, expected, 0, font, FB_ALIGN_NONE);
+    memcpy(reference, framebuffer, OLED_SIZE);
+
+    oled_clear();
+    fb_draw_string(10, 20, text, 0, font, FB_ALIGN_NONE);
+
+    assert_memory_equal(reference, framebuffer, OLED_SIZE);
+}
+
+static int setup(void **state)
+{
+    fb_blit = oled_blit;
+    fb_set_pen(FB_NORMAL);
+
+    return 0;
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__fb_string_length__should__decode_utf8(void **state)
+{
+    assert_int_equal(glyph_width(ArialMT_Plain_10, 0xC5), fb_string_length("Å", 0, ArialMT_Plain_10));
+    assert_int_equal(glyph_width(ArialMT_Plain_10, 'a') + glyph_width(ArialMT_Plain_10, 0xE4) + glyph_width(ArialMT_Plain_10, 0xF6),
+                     fb_string_length("aäö", 0, ArialMT_Plain_10));
+}
+
+static void test__fb_string_length__should__skip_characters_outside_latin1(void **state)
+{
+    assert_int_equal(fb_string_length("ab", 0, ArialMT_Plain_10), fb_string_length("a€b", 0, ArialMT_Plain_10));
+    assert_int_equal(fb_string_length("ab", 0, ArialMT_Plain_10), fb_string_length("a\U0001F68Cb", 0, ArialMT_Plain_10));
+
+    // Latin-1 bytes that are not valid UTF-8
+    assert_int_equal(fb_string_length("ab", 0, ArialMT_Plain_10), fb_string_length("a\xC5" "b", 0, ArialMT_Plain_10));
+    assert_int_equal(fb_string_length("ab", 0, ArialMT_Plain_10), fb_string_length("a\xA0\xA0" "b", 0, ArialMT_Plain_10));
+}
+
+static void test__fb_string_length__should__stop_at_the_length_in_a_sequence(void **state)
+{
+    assert_int_equal(fb_string_length("B", 0, ArialMT_Plain_10), fb_string_length("Bå", 2, ArialMT_Plain_10));
+}
+
+static void test__fb_draw_string__should__draw_latin1_glyphs(void **state)
+{
+    assert_draws_glyphs((const uint8_t[]) { 0xC5 }, 1, "\xC3\x85", ArialMT_Plain_10);
+    assert_draws_glyphs((const uint8_t[]) { 'S', 0xF6, 'd', 'e', 'r' }, 5, "Söder", ArialMT_Plain_10);
+}
+
+static void test__fb_draw_string__should__fall_back_to_similar_glyphs(void **state)
+{
+    assert_same_drawing("B]LSTA", "Bålsta", font_3x5);
+    assert_same_drawing("[\\]", "ÄÖÅ", font_3x5);
+    assert_same_drawing("[\\]", "äöå", font_3x5);
+    assert_same_drawing("ECOLE", "école", font_3x5);
+
+    assert_int_equal(6 * glyph_width(font_3x5, 'A'), fb_string_length("Bålsta", 0, font_3x5));
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_framebuffer[] = {
+    cmocka_unit_test(test__fb_string_length__should__decode_utf8),
+    cmocka_unit_test(test__fb_string_length__should__skip_characters_outside_latin1),
+    cmocka_unit_test(test__fb_string_length__should__stop_at_the_length_in_a_sequence),
+    cmocka_unit_test_setup(test__fb_draw_string__should__draw_latin1_glyphs, setup),
+    cmocka_unit_test_setup(test__fb_draw_string__should__fall_back_to_similar_glyphs, setup),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_framebuffer, NULL, NULL);
+
+    return fails;
+}
@@ -0,0 +1,189 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "glyph-cache.h"
+#include "oled_framebuffer.h"
+#include "matrix_framebuffer.h"
+#include "i2c-master.h"
+#include "fonts.h"
+#include "log.h"
+
+//////// Stubs needed by the framebuffers //////////////////////////////////////
+
+const uint8_t paw_64x64[1];
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+void oled_display(void)
+{
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+static const char *strings[] = {
+    "12:34", "00 00", "23:59", "9", " 7:05", "--:--", "1:2:3:4:5", "",
+};
+
+static const enum fb_alignment alignments[] = {
+    0,
+    FB_ALIGN_CENTER_V,
+    FB_ALIGN_CENTER_H | FB_ALIGN_CENTER_V,
+    FB_ALIGN_END_H | FB_ALIGN_END_V,
+};
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static void fill_random(uint8_t *data, int len)
+{
+    for(int i = 0; i < len; i++) {
+        data[i] = rand();
+    }
+}
+
+static void assert_draws_like_fb_draw_string(const struct glyph_cache *cache, void (*blit)(int16_t, int16_t, uint16_t, uint16_t, const uint8_t *, uint16_t), uint16_t size, int16_t width, int16_t height)
+{
+    static uint8_t expected[OLED_SIZE];
+    static uint8_t background[OLED_SIZE];
+
+    fb_blit = blit;
+    fb_blit_native = (cache->layout == GLYPH_CACHE_LAYOUT_ROWS) ? matrix_blit_rows : oled_blit;
+
+    for(int s = 0; s < sizeof(strings) / sizeof(strings[0]); s++) {
+        for(int a = 0; a < sizeof(alignments) / sizeof(alignments[0]); a++) {
+            for(int n = 0; n < 50; n++) {
+                const int16_t x = rand() % (width + 40) - 20;
+                const int16_t y = rand() % (height + 40) - 20;
+                const enum fb_pen pen = (n & 1) ? FB_NORMAL : FB_INVERSE;
+
+                fill_random(background, size);
+
+                memcpy(framebuffer, background, size);
+                fb_set_pen(pen);
+                fb_draw_string(x, y, strings[s], 0, cache->font, alignments[a]);
+                memcpy(expected, framebuffer, size);
+
+                memcpy(framebuffer, background, size);
+                fb_set_pen(pen);
+                glyph_cache_draw_string(cache, x, y, strings[s], alignments[a]);
+
+                assert_memory_equal(expected, framebuffer, size);
+            }
+        }
+    }
+}
+
+static int setup(void **state)
+{
+    static uint8_t buffer[OLED_SIZE];
+
+    framebuffer = buffer;
+    srand(1);
+
+    return 0;
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__glyph_cache_init__should__cache_digits_space_and_colon(void **state)
+{
+    struct glyph_cache cache;
+
+    assert_int_equal(0, glyph_cache_init(&cache, Monospaced_bold_16, GLYPH_CACHE_LAYOUT_PAGES));
+
+    for(int i = 0; i < 12; i++) {
+        assert_true(cache.present & (1 << i));
+        assert_int_equal(Monospaced_bold_16[FONT_WIDTH_POS], cache.width[i]);
+    }
+
+    glyph_cache_free(&cache);
+}
+
+static void test__glyph_cache_draw_string__should__match_fb_draw_string_on_oled(void **state)
+{
+    struct glyph_cache cache;
+
+    assert_int_equal(0, glyph_cache_init(&cache, Monospaced_bold_16, GLYPH_CACHE_LAYOUT_PAGES));
+    assert_draws_like_fb_draw_string(&cache, oled_blit, OLED_SIZE, OLED_WIDTH, OLED_HEIGHT);
+    glyph_cache_free(&cache);
+
+    assert_int_equal(0, glyph_cache_init(&cache, font_3x5, GLYPH_CACHE_LAYOUT_PAGES));
+    assert_draws_like_fb_draw_string(&cache, oled_blit, OLED_SIZE, OLED_WIDTH, OLED_HEIGHT);
+    glyph_cache_free(&cache);
+
+    assert_int_equal(0, glyph_cache_init(&cache, Monospaced_bold_16_rle, GLYPH_CACHE_LAYOUT_PAGES));
+    assert_draws_like_fb_draw_string(&cache, oled_blit, OLED_SIZE, OLED_WIDTH, OLED_HEIGHT);
+    glyph_cache_free(&cache);
+}
+
+static void test__glyph_cache_draw_string__should__match_fb_draw_string_on_matrix(void **state)
+{
+    struct glyph_cache cache;
+
+    assert_int_equal(0, glyph_cache_init(&cache, font_6x12, GLYPH_CACHE_LAYOUT_ROWS));
+    assert_draws_like_fb_draw_string(&cache, matrix_blit, MATRIX_SIZE, MATRIX_WIDTH, MATRIX_HEIGHT);
+    glyph_cache_free(&cache);
+
+    assert_int_equal(0, glyph_cache_init(&cache, font_3x5, GLYPH_CACHE_LAYOUT_ROWS));
+    assert_draws_like_fb_draw_string(&cache, matrix_blit, MATRIX_SIZE, MATRIX_WIDTH, MATRIX_HEIGHT);
+    glyph_cache_free(&cache);
+
+    assert_int_equal(0, glyph_cache_init(&cache, Monospaced_bold_16_rle, GLYPH_CACHE_LAYOUT_ROWS));
+    assert_draws_like_fb_draw_string(&cache, matrix_blit, MATRIX_SIZE, MATRIX_WIDTH, MATRIX_HEIGHT);
+    glyph_cache_free(&cache);
+}
+
+static void test__glyph_cache_draw_string__should__fall_back_for_other_characters(void **state)
+{
+    struct glyph_cache cache;
+    static uint8_t expected[OLED_SIZE];
+
+    assert_int_equal(0, glyph_cache_init(&cache, Monospaced_bold_16, GLYPH_CACHE_LAYOUT_PAGES));
+
+    fb_blit = oled_blit;
+    fb_blit_native = oled_blit;
+    fb_set_pen(FB_NORMAL);
+
+    memset(framebuffer, 0, OLED_SIZE);
+    fb_draw_string(10, 30, "12 min", 0, Monospaced_bold_16, FB_ALIGN_CENTER_V);
+    memcpy(expected, framebuffer, OLED_SIZE);
+
+    memset(framebuffer, 0, OLED_SIZE);
+    glyph_cache_draw_string(&cache, 10, 30, "12 min", FB_ALIGN_CENTER_V);
+
+    assert_memory_equal(expected, framebuffer, OLED_SIZE);
+
+    glyph_cache_free(&cache);
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_glyph_cache[] = {
+    cmocka_unit_test_setup(test__glyph_cache_init__should__cache_digits_space_and_colon, setup),
+    cmocka_unit_test_setup(test__glyph_cache_draw_string__should__match_fb_draw_string_on_oled, setup),
+    cmocka_unit_test_setup(test__glyph_cache_draw_string__should__match_fb_draw_string_on_matrix, setup),
+    cmocka_unit_test_setup(test__glyph_cache_draw_string__should__fall_back_for_other_characters, setup),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_glyph_cache, NULL, NULL);
+
+    return fails;
+}
@@ -0,0 +1,178 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "icon-atlas.h"
+#include "icons.h"
+#include "log.h"
+
+//////// Constants used in tests ///////////////////////////////////////////////
+
+#define ATLAS_FILE "test/results/test.atlas"
+
+//////// Stubs needed by framebuffer.c /////////////////////////////////////////
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static uint8_t atlas[16384];
+
+static void put_u16(uint8_t *p, uint16_t n)
+{
+    p[0] = n & 0xFF;
+    p[1] = n >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t n)
+{
+    put_u16(p, n & 0xFFFF);
+    put_u16(p + 2, n >> 16);
+}
+
+static uint16_t icon_len(const struct icon *icon)
+{
+    return icon->width * (1 + (icon->height - 1) / 8);
+}
+
+// Build an atlas of the built in icons, the way utils/pbm-to-c -a does
+static uint32_t make_atlas(void)
+{
+    uint32_t offset = ICON_ATLAS_HEADER_LEN + icon_table_len * ICON_ATLAS_ENTRY_LEN;
+
+    memset(atlas, 0, sizeof(atlas));
+    memcpy(atlas, ICON_ATLAS_MAGIC, 4);
+    put_u16(&atlas[4], icon_table_len);
+
+    for(int i = 0; i < icon_table_len; i++) {
+        const struct icon *icon = &icon_table[i].icon;
+        uint8_t *entry = &atlas[ICON_ATLAS_HEADER_LEN + i * ICON_ATLAS_ENTRY_LEN];
+
+        strcpy((char *)entry, icon_table[i].name);
+        put_u16(&entry[ICON_ATLAS_NAME_LEN], icon->width);
+        put_u16(&entry[ICON_ATLAS_NAME_LEN + 2], icon->height);
+        put_u32(&entry[ICON_ATLAS_NAME_LEN + 4], offset);
+
+        memcpy(&atlas[offset], icon->data, icon_len(icon));
+        offset += icon_len(icon);
+    }
+
+    put_u32(&atlas[8], offset);
+
+    return offset;
+}
+
+static void write_atlas(uint32_t len)
+{
+    FILE *fp = fopen(ATLAS_FILE, "wb");
+
+    assert_non_null(fp);
+    assert_int_equal(len, fwrite(atlas, 1, len, fp));
+
+    fclose(fp);
+}
+
+static int teardown(void **state)
+{
+    remove(ATLAS_FILE);
+    return 0;
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__icon_atlas_load__should__load_all_icons(void **state)
+{
+    write_atlas(make_atlas());
+
+    struct icon_atlas *loaded = icon_atlas_load(ATLAS_FILE);
+
+    assert_non_null(loaded);
+    assert_int_equal(icon_table_len, loaded->num_icons);
+
+    for(int i = 0; i < icon_table_len; i++) {
+        const struct icon *expected = &icon_table[i].icon;
+        const struct icon *icon = icon_atlas_get(loaded, icon_table[i].name);
+
+        assert_non_null(icon);
+        assert_int_equal(expected->width, icon->width);
+        assert_int_equal(expected->height, icon->height);
+        assert_memory_equal(expected->data, icon->data, icon_len(expected));
+    }
+
+    assert_null(icon_atlas_get(loaded, "/icons/rocket.pbm"));
+
+    icon_atlas_free(loaded);
+}
+
+static void test__icon_atlas_load__should__fail_for_missing_file(void **state)
+{
+    assert_null(icon_atlas_load("test/results/no-such.atlas"));
+}
+
+static void test__icon_atlas_load__should__fail_for_bad_magic(void **state)
+{
+    const uint32_t len = make_atlas();
+
+    atlas[0] = 'X';
+    write_atlas(len);
+
+    assert_null(icon_atlas_load(ATLAS_FILE));
+}
+
+static void test__icon_atlas_load__should__fail_for_truncated_file(void **state)
+{
+    write_atlas(make_atlas() - 1);
+
+    assert_null(icon_atlas_load(ATLAS_FILE));
+}
+
+static void test__icon_atlas_load__should__fail_for_icon_outside_file(void **state)
+{
+    const uint32_t len = make_atlas();
+
+    put_u32(&atlas[ICON_ATLAS_HEADER_LEN + ICON_ATLAS_NAME_LEN + 4], len - 1);
+    write_atlas(len);
+
+    assert_null(icon_atlas_load(ATLAS_FILE));
+}
+
+static void test__icon_atlas_load__should__fail_for_unterminated_name(void **state)
+{
+    const uint32_t len = make_atlas();
+
+    memset(&atlas[ICON_ATLAS_HEADER_LEN], 'x', ICON_ATLAS_NAME_LEN);
+    write_atlas(len);
+
+    assert_null(icon_atlas_load(ATLAS_FILE));
+}
+
+static void test__icon_atlas_get__should__accept_null_atlas(void **state)
+{
+    assert_null(icon_atlas_get(0, "/icons/bus.pbm"));
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_icon_atlas[] = {
+    cmocka_unit_test_teardown(test__icon_atlas_load__should__load_all_icons, teardown),
+    cmocka_unit_test_teardown(test__icon_atlas_load__should__fail_for_missing_file, teardown),
+    cmocka_unit_test_teardown(test__icon_atlas_load__should__fail_for_bad_magic, teardown),
+    cmocka_unit_test_teardown(test__icon_atlas_load__should__fail_for_truncated_file, teardown),
+    cmocka_unit_test_teardown(test__icon_atlas_load__should__fail_for_icon_outside_file, teardown),
+    cmocka_unit_test_teardown(test__icon_atlas_load__should__fail_for_unterminated_name, teardown),
+    cmocka_unit_test(test__icon_atlas_get__should__accept_null_atlas),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_icon_atlas, NULL, NULL);
+
+    return fails;
+}
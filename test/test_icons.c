@@ -0,0 +1,73 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "icons.h"
+#include "framebuffer.h"
+#include "log.h"
+
+//////// Stubs needed by framebuffer.c /////////////////////////////////////////
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__icon_get__should__return_icons_matching_the_pbm_files(void **state)
+{
+    assert_true(icon_table_len > 0);
+
+    for(int i = 0; i < icon_table_len; i++) {
+        char filename[64];
+
+        // The tests are run from the top directory
+        snprintf(filename, sizeof(filename), "data%s", icon_table[i].name);
+
+        struct icon *expected = fb_load_icon_pbm(filename);
+        const struct icon *icon = icon_get(icon_table[i].name);
+
+        assert_non_null(expected);
+        assert_ptr_equal(&icon_table[i].icon, icon);
+
+        assert_int_equal(expected->width, icon->width);
+        assert_int_equal(expected->height, icon->height);
+        assert_memory_equal(expected->data, icon->data, expected->width * (1 + (expected->height - 1) / 8));
+
+        fb_free_icon(expected);
+    }
+}
+
+static void test__icon_get__should__include_the_icons_used_by_the_displays(void **state)
+{
+    assert_non_null(icon_get("/icons/clock.pbm"));
+    assert_non_null(icon_get("/icons/nowifi4.pbm"));
+    assert_non_null(icon_get("/icons/bus.pbm"));
+    assert_non_null(icon_get("/icons-small/boat.pbm"));
+}
+
+static void test__icon_get__should__return_null_for_unknown_icon(void **state)
+{
+    assert_null(icon_get("/icons/rocket.pbm"));
+    assert_null(icon_get("bus.pbm"));
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_icons[] = {
+    cmocka_unit_test(test__icon_get__should__return_icons_matching_the_pbm_files),
+    cmocka_unit_test(test__icon_get__should__include_the_icons_used_by_the_displays),
+    cmocka_unit_test(test__icon_get__should__return_null_for_unknown_icon),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_icons, NULL, NULL);
+
+    return fails;
+}
@@ -347,6 +347,99 @@ static void test__json_writer_write_bool__writes_comma_to_output_in_array(void *
 }
 
 
+static void test__json_writer_count_init__initialises_the_structure(void **state)
+{
+    int count = 0;
+    json.current = 0xFF;
+    json.user = NULL;
+
+    json_writer_count_init(&json, &count);
+
+    assert_ptr_equal(&count, json.user);
+    assert_int_equal(0, json.current);
+}
+
+static void test__json_writer_count_init__counts_without_writing_to_output(void **state)
+{
+    int count = 0;
+    json_writer_count_init(&json, &count);
+
+    json_writer_begin_object(&json, NULL);
+    json_writer_write_string(&json, "test", "value");
+
+    assert_int_equal(strlen("{\"test\":\"value\""), count);
+    assert_string_equal("", output_string);
+}
+
+static void write_example(struct json_writer *json)
+{
+    json_writer_begin_object(json, NULL);
+    json_writer_write_string(json, "str", "a \"quoted\" string");
+    json_writer_write_int(json, "num", -12345);
+    json_writer_write_bool(json, "bool", 1);
+    json_writer_write_string(json, "null", NULL);
+    json_writer_begin_array(json, "arr");
+    json_writer_write_int(json, NULL, 1);
+    json_writer_write_int(json, NULL, 2);
+    json_writer_end_array(json);
+    json_writer_end_object(json);
+}
+
+static void test__json_writer_count_init__counts_the_same_number_of_bytes_as_written(void **state)
+{
+    int count = 0;
+    json_writer_count_init(&json, &count);
+    write_example(&json);
+
+    json.current = 0;
+    json.write_string = (json_writer_io) http_write_string;
+    write_example(&json);
+
+    assert_int_equal(strlen(output_string), count);
+}
+
+static void test__json_writer_buffer_init__writes_to_the_buffer(void **state)
+{
+    struct json_writer_buffer buffer;
+    char buf[128];
+    int count = 0;
+
+    json_writer_count_init(&json, &count);
+    write_example(&json);
+
+    json_writer_buffer_init(&json, &buffer, buf, sizeof(buf));
+    write_example(&json);
+
+    json.current = 0;
+    json.write_string = (json_writer_io) http_write_string;
+    write_example(&json);
+
+    assert_int_equal(count, buffer.pos);
+    assert_int_equal(0, buffer.overflow);
+    assert_memory_equal(output_string, buf, count);
+}
+
+static void test__json_writer_buffer_init__counts_the_bytes_which_do_not_fit(void **state)
+{
+    struct json_writer_buffer buffer;
+    char buf[128];
+    int count = 0;
+
+    json_writer_count_init(&json, &count);
+    write_example(&json);
+
+    memset(buf, 0x55, sizeof(buf));
+
+    json_writer_buffer_init(&json, &buffer, buf, 10);
+    write_example(&json);
+
+    assert_int_equal(10, buffer.pos);
+    assert_int_equal(count - 10, buffer.overflow);
+    assert_memory_equal("{\"str\":\"a ", buf, 10);
+    assert_int_equal(0x55, buf[10]);
+}
+
+
 //////// Main //////////////////////////////////////////////////////////////////
 
 int setup(void **state) {
@@ -403,6 +496,12 @@ const struct CMUnitTest tests_for_json_writer[] = {
     cmocka_unit_test_setup_teardown(test__json_writer_write_string__writes_comma_to_output_in_array, setup, teardown),
     cmocka_unit_test_setup_teardown(test__json_writer_write_int__writes_comma_to_output_in_array, setup, teardown),
     cmocka_unit_test_setup_teardown(test__json_writer_write_bool__writes_comma_to_output_in_array, setup, teardown),
+
+    cmocka_unit_test_setup_teardown(test__json_writer_count_init__initialises_the_structure, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__json_writer_count_init__counts_without_writing_to_output, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__json_writer_count_init__counts_the_same_number_of_bytes_as_written, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__json_writer_buffer_init__writes_to_the_buffer, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__json_writer_buffer_init__counts_the_bytes_which_do_not_fit, setup, teardown),
 };
 
 
@@ -0,0 +1,213 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <cmocka.h>
+
+#include "log.h"
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static void log_messages(int num, enum log_level level, enum log_system system)
+{
+    for(int i = 0; i < num; i++) {
+        log_log(level, system, "Message %d", i);
+    }
+}
+
+int num_waits;
+int num_wakes;
+uint32_t wait_timeout_ms;
+
+// Messages to log while waiting, as if logged by another task
+int num_messages_while_waiting;
+enum log_system system_while_waiting;
+
+void log_cbuf_wait(uint32_t timeout_ms)
+{
+    num_waits++;
+    wait_timeout_ms = timeout_ms;
+
+    log_messages(num_messages_while_waiting, LOG_LEVEL_NOTICE, system_while_waiting);
+}
+
+void log_cbuf_wake(void)
+{
+    num_wakes++;
+}
+
+//////// Test //////////////////////////////////////////////////////////////////
+
+static void test__log_log__numbers_the_messages(void **state)
+{
+    log_messages(3, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(3, log_cbuf.seq);
+    assert_int_equal(1, log_cbuf.message[0].seq);
+    assert_int_equal(2, log_cbuf.message[1].seq);
+    assert_int_equal(3, log_cbuf.message[2].seq);
+}
+
+static void test__log_cbuf_next__returns_zero_if_there_are_no_new_messages(void **state)
+{
+    struct log_cbuf_message msg;
+
+    assert_int_equal(0, log_cbuf_next(0, log_cbuf.seq, LOG_LEVEL_DEBUG, LOG_SYS_ALL, &msg));
+
+    log_messages(3, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(0, log_cbuf_next(3, log_cbuf.seq, LOG_LEVEL_DEBUG, LOG_SYS_ALL, &msg));
+}
+
+static void test__log_cbuf_next__returns_the_next_message(void **state)
+{
+    struct log_cbuf_message msg;
+
+    log_messages(3, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(2, log_cbuf_next(1, log_cbuf.seq, LOG_LEVEL_DEBUG, LOG_SYS_ALL, &msg));
+    assert_int_equal(2, msg.seq);
+    assert_string_equal("Message 1", msg.message);
+}
+
+static void test__log_cbuf_next__does_not_return_messages_after_until(void **state)
+{
+    struct log_cbuf_message msg;
+
+    log_messages(3, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(0, log_cbuf_next(2, 2, LOG_LEVEL_DEBUG, LOG_SYS_ALL, &msg));
+}
+
+static void test__log_cbuf_next__filters_by_level(void **state)
+{
+    struct log_cbuf_message msg;
+
+    log_messages(2, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+    log_messages(1, LOG_LEVEL_ERROR, LOG_SYS_MAIN);
+
+    assert_int_equal(3, log_cbuf_next(0, log_cbuf.seq, LOG_LEVEL_WARNING, LOG_SYS_ALL, &msg));
+    assert_int_equal(LOG_LEVEL_ERROR, msg.level);
+}
+
+static void test__log_cbuf_next__filters_by_system(void **state)
+{
+    struct log_cbuf_message msg;
+
+    log_messages(2, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+    log_messages(1, LOG_LEVEL_NOTICE, LOG_SYS_WIFI);
+    log_messages(1, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(3, log_cbuf_next(0, log_cbuf.seq, LOG_LEVEL_DEBUG, LOG_SYS_WIFI, &msg));
+    assert_int_equal(LOG_SYS_WIFI, msg.system);
+    assert_int_equal(0, log_cbuf_next(3, log_cbuf.seq, LOG_LEVEL_DEBUG, LOG_SYS_WIFI, &msg));
+}
+
+static void test__log_cbuf_next__skips_overwritten_messages(void **state)
+{
+    struct log_cbuf_message msg;
+
+    log_messages(LOG_CBUF_LEN + 10, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(11, log_cbuf_next(0, log_cbuf.seq, LOG_LEVEL_DEBUG, LOG_SYS_ALL, &msg));
+    assert_int_equal(11, msg.seq);
+    assert_string_equal("Message 10", msg.message);
+}
+
+static void test__log_cbuf_next__finds_all_messages_in_a_wrapped_buffer(void **state)
+{
+    struct log_cbuf_message msg;
+    int num = 0;
+
+    log_messages(LOG_CBUF_LEN + 10, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    for(uint32_t seq = 0; (seq = log_cbuf_next(seq, log_cbuf.seq, LOG_LEVEL_DEBUG, LOG_SYS_ALL, &msg)) != 0; ) {
+        num++;
+    }
+
+    assert_int_equal(LOG_CBUF_LEN, num);
+}
+
+static void test__log_log__wakes_the_readers(void **state)
+{
+    log_messages(2, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(2, num_wakes);
+}
+
+static void test__log_cbuf_poll__does_not_wait_if_there_is_a_message(void **state)
+{
+    log_messages(3, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(1, log_cbuf_poll(2, LOG_LEVEL_DEBUG, LOG_SYS_ALL, 100));
+    assert_int_equal(0, num_waits);
+}
+
+static void test__log_cbuf_poll__gives_up_the_cpu_while_waiting(void **state)
+{
+    log_messages(3, LOG_LEVEL_NOTICE, LOG_SYS_MAIN);
+
+    assert_int_equal(0, log_cbuf_poll(3, LOG_LEVEL_DEBUG, LOG_SYS_ALL, 100));
+    assert_int_equal(1, num_waits);
+    assert_int_equal(100, wait_timeout_ms);
+}
+
+static void test__log_cbuf_poll__returns_a_message_logged_while_waiting(void **state)
+{
+    num_messages_while_waiting = 1;
+
+    assert_int_equal(1, log_cbuf_poll(0, LOG_LEVEL_DEBUG, LOG_SYS_ALL, 100));
+    assert_int_equal(1, num_waits);
+}
+
+static void test__log_cbuf_poll__filters_the_messages_logged_while_waiting(void **state)
+{
+    num_messages_while_waiting = 1;
+    system_while_waiting = LOG_SYS_WIFI;
+
+    assert_int_equal(0, log_cbuf_poll(0, LOG_LEVEL_DEBUG, LOG_SYS_MAIN, 100));
+    assert_int_equal(1, num_waits);
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+int setup(void **state)
+{
+    memset(&log_cbuf, 0, sizeof(log_cbuf));
+    log_set_level(LOG_STDOUT, LOG_SYS_ALL, LOG_LEVEL_EMERGENCY);
+    log_set_level(LOG_CBUF, LOG_SYS_ALL, LOG_LEVEL_DEBUG);
+    num_waits = 0;
+    num_wakes = 0;
+    wait_timeout_ms = 0;
+    num_messages_while_waiting = 0;
+    system_while_waiting = LOG_SYS_MAIN;
+    return 0;
+}
+
+const struct CMUnitTest tests_for_log[] = {
+    cmocka_unit_test_setup(test__log_log__numbers_the_messages, setup),
+    cmocka_unit_test_setup(test__log_log__wakes_the_readers, setup),
+
+    cmocka_unit_test_setup(test__log_cbuf_next__returns_zero_if_there_are_no_new_messages, setup),
+    cmocka_unit_test_setup(test__log_cbuf_next__returns_the_next_message, setup),
+    cmocka_unit_test_setup(test__log_cbuf_next__does_not_return_messages_after_until, setup),
+    cmocka_unit_test_setup(test__log_cbuf_next__filters_by_level, setup),
+    cmocka_unit_test_setup(test__log_cbuf_next__filters_by_system, setup),
+    cmocka_unit_test_setup(test__log_cbuf_next__skips_overwritten_messages, setup),
+    cmocka_unit_test_setup(test__log_cbuf_next__finds_all_messages_in_a_wrapped_buffer, setup),
+
+    cmocka_unit_test_setup(test__log_cbuf_poll__does_not_wait_if_there_is_a_message, setup),
+    cmocka_unit_test_setup(test__log_cbuf_poll__gives_up_the_cpu_while_waiting, setup),
+    cmocka_unit_test_setup(test__log_cbuf_poll__returns_a_message_logged_while_waiting, setup),
+    cmocka_unit_test_setup(test__log_cbuf_poll__filters_the_messages_logged_while_waiting, setup),
+};
+
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_log, NULL, NULL);
+
+    return fails;
+}
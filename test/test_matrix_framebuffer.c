@@ -0,0 +1,259 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "matrix_framebuffer.h"
+#include "i2c-master.h"
+#include "fonts.h"
+#include "log.h"
+
+//////// Constants used in tests ///////////////////////////////////////////////
+
+#define BUFFER_MARGIN (MATRIX_SIZE * 4)
+#define CANARY 0x55
+
+//////// Stubs needed by matrix_framebuffer.c //////////////////////////////////
+
+uint8_t *framebuffer;
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+static uint8_t raw_buffer[MATRIX_SIZE + 2 * BUFFER_MARGIN];
+
+static uint8_t icon8x8[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static int setup(void **state)
+{
+    memset(raw_buffer, CANARY, MATRIX_SIZE + 2 * BUFFER_MARGIN);
+    framebuffer = &raw_buffer[BUFFER_MARGIN];
+
+    return 0;
+}
+
+static void assert_no_drawing_outside_framebuffer(void)
+{
+    for(int i = 0; i < BUFFER_MARGIN; i++) {
+        assert_int_equal(CANARY, raw_buffer[i]);
+    }
+
+    for(int i = BUFFER_MARGIN + MATRIX_SIZE; i < 2 * BUFFER_MARGIN + MATRIX_SIZE; i++) {
+        assert_int_equal(CANARY, raw_buffer[i]);
+    }
+}
+
+static int get_pixel(int x, int y)
+{
+    return framebuffer[x / 8 + (MATRIX_WIDTH / 8) * y] & (0x80 >> (x % 8));
+}
+
+static void fill_random(uint8_t *data, int len)
+{
+    for(int i = 0; i < len; i++) {
+        data[i] = rand();
+    }
+}
+
+// Draw the glyph one pixel at a time
+static void reference_blit(int16_t x0, int16_t y0, uint16_t w, uint16_t h, const uint8_t *data, uint16_t len)
+{
+    uint8_t raster_height = 1 + ((h - 1) / 8);
+
+    if(!len) {
+        len = w * raster_height;
+    }
+
+    for(int16_t x = 0; x < w; x++) {
+        for(int16_t y = 0; y < h; y++) {
+            uint16_t n = (y / 8) + x * raster_height;
+            if((n < len) && (data[n] & (1 << (y % 8)))) {
+                matrix_set_pixel(x0 + x, y0 + y);
+            }
+        }
+    }
+}
+
+static void test__matrix_blit__should__match_reference_blit_helper(int x, int y, int w, int h, const uint8_t *data, uint16_t len, enum fb_pen pen)
+{
+    static uint8_t expected[MATRIX_SIZE];
+    static uint8_t background[MATRIX_SIZE];
+
+    fill_random(background, MATRIX_SIZE);
+    fb_set_pen(pen);
+
+    memcpy(framebuffer, background, MATRIX_SIZE);
+    reference_blit(x, y, w, h, data, len);
+    memcpy(expected, framebuffer, MATRIX_SIZE);
+
+    memcpy(framebuffer, background, MATRIX_SIZE);
+    matrix_blit(x, y, w, h, data, len);
+
+    assert_memory_equal(expected, framebuffer, MATRIX_SIZE);
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__matrix_clear__should__clear_framebuffer(void **state)
+{
+    matrix_clear();
+
+    for(int i = 0; i < MATRIX_SIZE; i++) {
+        assert_int_equal(0x00, framebuffer[i]);
+    }
+
+    assert_no_drawing_outside_framebuffer();
+}
+
+static void test__matrix_blit__should__draw_icon_in_the_correct_spot(void **state)
+{
+    const int x0 = 13;
+    const int y0 = 5;
+
+    matrix_clear();
+    fb_set_pen(FB_NORMAL);
+
+    matrix_blit(x0, y0, 8, 8, icon8x8, 0);
+
+    for(int x = 0; x < MATRIX_WIDTH; x++) {
+        for(int y = 0; y < MATRIX_HEIGHT; y++) {
+            if((x0 <= x) && (x < x0 + 8) && (y0 <= y) && (y < y0 + 8)) {
+                assert_true(get_pixel(x, y));
+            } else {
+                assert_false(get_pixel(x, y));
+            }
+        }
+    }
+}
+
+static void test__matrix_blit__should__draw_string(void **state)
+{
+    matrix_clear();
+    fb_set_pen(FB_NORMAL);
+    fb_blit = matrix_blit;
+
+    fb_draw_string(0, 0, "12", 0, font_3x5, 0);
+
+    // The top row of "1" is .X. and of "2" is XX.
+    assert_false(get_pixel(0, 0));
+    assert_true(get_pixel(1, 0));
+    assert_false(get_pixel(2, 0));
+    assert_true(get_pixel(4, 0));
+    assert_true(get_pixel(5, 0));
+}
+
+static void test__matrix_blit__should__match_reference_blit(void **state)
+{
+    uint8_t glyph[8 * 40];
+
+    srand(1);
+
+    for(int n = 0; n < 5000; n++) {
+        int w = 1 + rand() % 40;
+        int h = 1 + rand() % 40;
+        int raster_height = 1 + (h - 1) / 8;
+        int x = rand() % (MATRIX_WIDTH + 2 * w) - w;
+        int y = rand() % (MATRIX_HEIGHT + 2 * h) - h;
+
+        // Font glyphs leave out trailing empty bytes
+        uint16_t len = (rand() % 2) ? 1 + rand() % (w * raster_height) : 0;
+
+        fill_random(glyph, sizeof(glyph));
+
+        test__matrix_blit__should__match_reference_blit_helper(x, y, w, h, glyph, len, (n & 1) ? FB_NORMAL : FB_INVERSE);
+    }
+
+    assert_no_drawing_outside_framebuffer();
+}
+
+static void test__matrix_fill_rect__should__clip_to_the_framebuffer(void **state)
+{
+    const int x0 = -3;
+    const int y0 = MATRIX_HEIGHT - 5;
+
+    matrix_clear();
+    fb_set_pen(FB_NORMAL);
+
+    matrix_fill_rect(x0, y0, 12, 10);
+
+    for(int x = 0; x < MATRIX_WIDTH; x++) {
+        for(int y = 0; y < MATRIX_HEIGHT; y++) {
+            if((x < x0 + 12) && (y0 <= y)) {
+                assert_true(get_pixel(x, y));
+            } else {
+                assert_false(get_pixel(x, y));
+            }
+        }
+    }
+
+    assert_no_drawing_outside_framebuffer();
+}
+
+static void test__matrix_fill_rect__should__match_set_pixel(void **state)
+{
+    static uint8_t expected[MATRIX_SIZE];
+    static uint8_t background[MATRIX_SIZE];
+
+    srand(1);
+
+    for(int n = 0; n < 500; n++) {
+        int w = rand() % 48;
+        int h = rand() % 48;
+        int x = rand() % (MATRIX_WIDTH + 2 * w + 1) - w;
+        int y = rand() % (MATRIX_HEIGHT + 2 * h + 1) - h;
+
+        fill_random(background, MATRIX_SIZE);
+        fb_set_pen((n & 1) ? FB_NORMAL : FB_INVERSE);
+
+        memcpy(framebuffer, background, MATRIX_SIZE);
+        for(int j = y; j < y + h; j++) {
+            for(int i = x; i < x + w; i++) {
+                matrix_set_pixel(i, j);
+            }
+        }
+        memcpy(expected, framebuffer, MATRIX_SIZE);
+
+        memcpy(framebuffer, background, MATRIX_SIZE);
+        matrix_fill_rect(x, y, w, h);
+
+        assert_memory_equal(expected, framebuffer, MATRIX_SIZE);
+    }
+
+    assert_no_drawing_outside_framebuffer();
+}
+
+const struct CMUnitTest tests_for_matrix[] = {
+    cmocka_unit_test_setup(test__matrix_clear__should__clear_framebuffer, setup),
+    cmocka_unit_test_setup(test__matrix_blit__should__draw_icon_in_the_correct_spot, setup),
+    cmocka_unit_test_setup(test__matrix_blit__should__draw_string, setup),
+    cmocka_unit_test_setup(test__matrix_blit__should__match_reference_blit, setup),
+    cmocka_unit_test_setup(test__matrix_fill_rect__should__clip_to_the_framebuffer, setup),
+    cmocka_unit_test_setup(test__matrix_fill_rect__should__match_set_pixel, setup),
+};
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_matrix, NULL, NULL);
+
+    return fails;
+}
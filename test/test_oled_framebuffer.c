@@ -130,6 +130,32 @@ static void test__oled_blit__should__draw_icon_in_the_correct_spot_helper(int x,
 }
 
 
+static void fill_random(uint8_t *data, int len)
+{
+    for(int i = 0; i < len; i++) {
+        data[i] = rand();
+    }
+}
+
+static void test__oled_blit__should__match_generic_blit_helper(int x, int y, int w, int h, const uint8_t *data, uint16_t len, enum fb_pen pen)
+{
+    static uint8_t expected[OLED_SIZE];
+    static uint8_t background[OLED_SIZE];
+
+    fill_random(background, OLED_SIZE);
+    fb_set_pen(pen);
+
+    memcpy(framebuffer, background, OLED_SIZE);
+    oled_blit_generic(x, y, w, h, data, len);
+    memcpy(expected, framebuffer, OLED_SIZE);
+
+    memcpy(framebuffer, background, OLED_SIZE);
+    oled_blit(x, y, w, h, data, len);
+
+    assert_memory_equal(expected, framebuffer, OLED_SIZE);
+}
+
+
 //////// Tests /////////////////////////////////////////////////////////////////
 
 static void test__oled_clear__should__clear_framebuffer(void **state)
@@ -207,12 +233,93 @@ static void test__oled_blit__should__draw_large_icon_in_the_correct_spot(void **
     test__oled_blit__should__draw_icon_in_the_correct_spot_helper(OLED_WIDTH, OLED_HEIGHT, w, h, icon);
 }
 
+static void test__oled_blit__should__match_generic_blit(void **state)
+{
+    uint8_t glyph[8 * 32];
+
+    srand(1);
+
+    for(int n = 0; n < 2000; n++) {
+        int w = 1 + rand() % 32;
+        int h = 1 + rand() % 64;
+        int raster_height = 1 + (h - 1) / 8;
+        int x = rand() % (OLED_WIDTH + 2 * w) - w;
+        int y = rand() % (OLED_HEIGHT + 2 * h) - h;
+
+        // Font glyphs leave out trailing empty bytes
+        uint16_t len = (rand() % 2) ? 1 + rand() % (w * raster_height) : 0;
+
+        fill_random(glyph, sizeof(glyph));
+
+        test__oled_blit__should__match_generic_blit_helper(x, y, w, h, glyph, len, (n & 1) ? FB_NORMAL : FB_INVERSE);
+    }
+
+    assert_no_drawing_outside_framebuffer();
+}
+
+static void test__oled_fill_rect__should__match_set_pixel(void **state)
+{
+    static uint8_t expected[OLED_SIZE];
+    static uint8_t background[OLED_SIZE];
+
+    srand(1);
+
+    for(int n = 0; n < 500; n++) {
+        int w = rand() % 80;
+        int h = rand() % 40;
+        int x = rand() % (OLED_WIDTH + 2 * w + 1) - w;
+        int y = rand() % (OLED_HEIGHT + 2 * h + 1) - h;
+
+        fill_random(background, OLED_SIZE);
+        fb_set_pen((n & 1) ? FB_NORMAL : FB_INVERSE);
+
+        memcpy(framebuffer, background, OLED_SIZE);
+        for(int j = y; j < y + h; j++) {
+            for(int i = x; i < x + w; i++) {
+                oled_set_pixel(i, j);
+            }
+        }
+        memcpy(expected, framebuffer, OLED_SIZE);
+
+        memcpy(framebuffer, background, OLED_SIZE);
+        oled_fill_rect(x, y, w, h);
+
+        assert_memory_equal(expected, framebuffer, OLED_SIZE);
+    }
+
+    assert_no_drawing_outside_framebuffer();
+}
+
+static void test__oled_fill_rect__should__mark_its_columns_dirty(void **state)
+{
+    uint8_t start, end;
+
+    oled_clear();
+    oled_clear_dirty();
+    fb_set_pen(FB_NORMAL);
+
+    oled_fill_rect(10, 5, 20, 12);
+
+    for(int page = 0; page < OLED_HEIGHT / 8; page++) {
+        if(page < 3) {
+            assert_true(oled_get_dirty(page, &start, &end));
+            assert_int_equal(10, start);
+            assert_int_equal(30, end);
+        } else {
+            assert_false(oled_get_dirty(page, &start, &end));
+        }
+    }
+}
+
 const struct CMUnitTest tests_for_oled[] = {
     cmocka_unit_test_setup(test__oled_clear__should__clear_framebuffer, setup),
     cmocka_unit_test_setup(test__oled_clear__should__not_draw_outside_framebuffer, setup),
     cmocka_unit_test_setup(test__oled_blit__should__not_draw_outside_framebuffer, setup),
     cmocka_unit_test_setup(test__oled_blit__should__draw_small_icon_in_the_correct_spot, setup),
     cmocka_unit_test_setup(test__oled_blit__should__draw_large_icon_in_the_correct_spot, setup),
+    cmocka_unit_test_setup(test__oled_blit__should__match_generic_blit, setup),
+    cmocka_unit_test_setup(test__oled_fill_rect__should__match_set_pixel, setup),
+    cmocka_unit_test_setup(test__oled_fill_rect__should__mark_its_columns_dirty, setup),
 };
 
 //////// Main //////////////////////////////////////////////////////////////////
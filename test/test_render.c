@@ -0,0 +1,289 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include "oled_render.h"
+#include "matrix_render.h"
+#include "oled_framebuffer.h"
+#include "matrix_framebuffer.h"
+#include "display-schedule.h"
+#include "display-driver.h"
+#include "display-host.h"
+#include "i2c-master.h"
+#include "journey.h"
+#include "status.h"
+#include "log.h"
+
+// Render whole frames of both displays with a virtual clock and compare them
+// with the golden images in test/golden. Run the test with UPDATE_GOLDEN=1
+// from the top directory to write new golden images after an intended change
+// of the display layout. Frames that differ are written to test/results.
+
+//////// Constants used in tests ///////////////////////////////////////////////
+
+#define GOLDEN_DIR "test/golden/"
+#define RESULT_DIR "test/results/"
+
+#define FRAME_MS 25
+
+// 2018-03-14 12:34:56 UTC
+#define CLOCK_START 1521030896
+
+//////// Stubs needed by the display code //////////////////////////////////////
+
+const uint8_t paw_64x64[1];
+
+struct journey journies[JOURNEY_MAX_JOURNIES];
+struct app_status app_status;
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+void oled_display(void)
+{
+}
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+struct display
+{
+    const char *name;
+    uint16_t width;
+    uint16_t height;
+    const struct display_driver *driver;
+    void (*init)(void);
+    void (*frame)(uint32_t now_ms, const struct timeval *now, struct display_schedule *schedule);
+    int (*get_pixel)(int x, int y);
+};
+
+static int oled_get_pixel(int x, int y)
+{
+    return framebuffer[x + (y / 8) * OLED_WIDTH] & (1 << (y % 8));
+}
+
+static int matrix_get_pixel(int x, int y)
+{
+    return framebuffer[x / 8 + (MATRIX_WIDTH / 8) * y] & (0x80 >> (x % 8));
+}
+
+static const struct display oled = {
+    .name = "oled", .width = OLED_WIDTH, .height = OLED_HEIGHT,
+    .driver = &display_null_oled, .init = oled_render_init, .frame = oled_render_frame, .get_pixel = oled_get_pixel,
+};
+
+static const struct display matrix = {
+    .name = "matrix", .width = MATRIX_WIDTH, .height = MATRIX_HEIGHT,
+    .driver = &display_null_matrix, .init = matrix_render_init, .frame = matrix_render_frame, .get_pixel = matrix_get_pixel,
+};
+
+// Draw the frames from the virtual time 0 until end_ms, as the display task
+// would during an animation
+static void render(const struct display *display, uint32_t end_ms)
+{
+    display_driver_select(display->driver);
+
+    for(uint32_t t = 0; t <= end_ms; t += FRAME_MS) {
+        struct display_schedule schedule;
+        struct timeval now = { .tv_sec = CLOCK_START + t / 1000, .tv_usec = (t % 1000) * 1000 };
+
+        display_schedule_init(&schedule);
+        display->frame(t, &now, &schedule);
+    }
+}
+
+static void write_pbm(const struct display *display, const char *filename)
+{
+    FILE *fp = fopen(filename, "wb");
+
+    assert_non_null(fp);
+
+    fprintf(fp, "P4\n%d %d\n", display->width, display->height);
+
+    for(int y = 0; y < display->height; y++) {
+        for(int x = 0; x < display->width; x += 8) {
+            uint8_t b = 0;
+
+            for(int i = 0; i < 8; i++) {
+                if(display->get_pixel(x + i, y)) {
+                    b |= 0x80 >> i;
+                }
+            }
+            fputc(b, fp);
+        }
+    }
+
+    fclose(fp);
+}
+
+static void assert_frame_matches_golden(const struct display *display, const char *scene)
+{
+    char filename[128];
+
+    snprintf(filename, sizeof(filename), GOLDEN_DIR "%s_%s.pbm", display->name, scene);
+
+    if(getenv("UPDATE_GOLDEN")) {
+        write_pbm(display, filename);
+        return;
+    }
+
+    FILE *fp = fopen(filename, "rb");
+
+    if(!fp) {
+        fail_msg("Golden image %s is missing", filename);
+    }
+
+    int width, height;
+
+    assert_int_equal(2, fscanf(fp, "P4\n%d %d", &width, &height));
+    assert_int_equal('\n', fgetc(fp));
+    assert_int_equal(display->width, width);
+    assert_int_equal(display->height, height);
+
+    int differences = 0;
+
+    for(int y = 0; y < height; y++) {
+        for(int x = 0; x < width; x += 8) {
+            const int b = fgetc(fp);
+
+            for(int i = 0; i < 8; i++) {
+                if(!(b & (0x80 >> i)) != !display->get_pixel(x + i, y)) {
+                    differences++;
+                }
+            }
+        }
+    }
+
+    fclose(fp);
+
+    if(differences) {
+        snprintf(filename, sizeof(filename), RESULT_DIR "%s_%s.pbm", display->name, scene);
+        write_pbm(display, filename);
+        fail_msg("%d pixels differ from the golden image, see %s", differences, filename);
+    }
+}
+
+static void set_journey(int i, const char *line, enum journey_transport_mode mode, int minutes)
+{
+    strcpy(journies[i].line, line);
+    journies[i].mode = mode;
+    journies[i].departures[0] = CLOCK_START + minutes * 60;
+    journies[i].departures[1] = CLOCK_START + (minutes + 7) * 60;
+}
+
+static int setup(void **state)
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    memset(journies, 0, sizeof(journies));
+    app_status = (struct app_status) { .wifi_connected = 1, .obtained_time = 1, .obtained_tz = 1 };
+
+    oled.init();
+    matrix.init();
+
+    return 0;
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__render__clock(void **state)
+{
+    render(&oled, 0);
+    assert_frame_matches_golden(&oled, "clock");
+
+    // The colon blinks
+    render(&oled, 1000);
+    assert_frame_matches_golden(&oled, "clock_blink");
+
+    render(&matrix, 0);
+    assert_frame_matches_golden(&matrix, "clock");
+}
+
+static void test__render__no_wifi(void **state)
+{
+    app_status = (struct app_status) { 0 };
+
+    render(&oled, 500);
+    assert_frame_matches_golden(&oled, "no_wifi");
+}
+
+static void test__render__two_journeys(void **state)
+{
+    set_journey(0, "4", TRANSPORT_MODE_BUS, 6);
+    set_journey(1, "17", TRANSPORT_MODE_METRO, 11);
+
+    // Halfway through shifting the rows out
+    render(&oled, 640);
+    assert_frame_matches_golden(&oled, "two_journeys_shift");
+
+    render(&oled, 3000);
+    assert_frame_matches_golden(&oled, "two_journeys");
+
+    render(&matrix, 3000);
+    assert_frame_matches_golden(&matrix, "two_journeys");
+}
+
+static void test__render__single_journey(void **state)
+{
+    set_journey(0, "43", TRANSPORT_MODE_TRAIN, 3);
+    strcpy(journies[0].destination, "Bålsta");
+
+    render(&oled, 3000);
+    assert_frame_matches_golden(&oled, "single_journey");
+}
+
+static void test__render__message_box(void **state)
+{
+    set_journey(0, "4", TRANSPORT_MODE_BUS, 6);
+    set_journey(1, "17", TRANSPORT_MODE_METRO, 11);
+
+    oled_render_set_message(DISPLAY_MESSAGE_NO_JOURNIES, "No journies configured\nConnect to\n192.168.1.20\nto configure");
+
+    render(&oled, 3000);
+    assert_frame_matches_golden(&oled, "message_box");
+}
+
+static void test__render__no_message_box_without_a_message(void **state)
+{
+    set_journey(0, "4", TRANSPORT_MODE_BUS, 6);
+    set_journey(1, "17", TRANSPORT_MODE_METRO, 11);
+
+    oled_render_set_message(DISPLAY_MESSAGE_NONE, NULL);
+
+    render(&oled, 3000);
+    assert_frame_matches_golden(&oled, "two_journeys");
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_render[] = {
+    cmocka_unit_test_setup(test__render__clock, setup),
+    cmocka_unit_test_setup(test__render__no_wifi, setup),
+    cmocka_unit_test_setup(test__render__two_journeys, setup),
+    cmocka_unit_test_setup(test__render__single_journey, setup),
+    cmocka_unit_test_setup(test__render__message_box, setup),
+    cmocka_unit_test_setup(test__render__no_message_box_without_a_message, setup),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_render, NULL, NULL);
+
+    return fails;
+}
@@ -0,0 +1,176 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "screenshot.h"
+
+//////// Global variables used for testing /////////////////////////////////////
+
+static const struct display_codec_format oled_format = { .layout = DISPLAY_CODEC_LAYOUT_PAGES, .width = 128, .height = 64 };
+static const struct display_codec_format matrix_format = { .layout = DISPLAY_CODEC_LAYOUT_ROWS, .width = 32, .height = 32 };
+
+static uint8_t frame[128 * 64 / 8];
+static uint8_t image[2048];
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+// Read the whole image, buf_len bytes at a time. Returns its length.
+static int read_image(enum screenshot_type type, const struct display_codec_format *format, uint16_t buf_len)
+{
+    struct screenshot screenshot;
+    uint8_t buf[256];
+    int len = 0;
+    uint16_t n;
+
+    screenshot_init(&screenshot, type, format, frame);
+
+    while((n = screenshot_read(&screenshot, buf, buf_len)) > 0) {
+        assert_true(n <= buf_len);
+        assert_true(len + n <= sizeof(image));
+        memcpy(image + len, buf, n);
+        len += n;
+    }
+
+    assert_int_equal(screenshot_length(&screenshot), len);
+
+    return len;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static int setup(void **state)
+{
+    memset(frame, 0, sizeof(frame));
+    memset(image, 0, sizeof(image));
+
+    return 0;
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__screenshot_read__should__write_pbm_rows_of_an_oled_frame(void **state)
+{
+    const char header[] = "P4\n128 64\n";
+
+    frame[0] = 0x01;
+    frame[9 + 128 * 1] = 0x20;
+    frame[127 + 128 * 7] = 0x80;
+
+    assert_int_equal(strlen(header) + 16 * 64, read_image(SCREENSHOT_PBM, &oled_format, SCREENSHOT_MIN_LEN));
+    assert_memory_equal(header, image, strlen(header));
+
+    const uint8_t *rows = image + strlen(header);
+
+    for(int i = 0; i < 16 * 64; i++) {
+        if(i == 0) {
+            assert_int_equal(0x80, rows[i]);
+        } else if(i == 13 * 16 + 1) {
+            assert_int_equal(0x40, rows[i]);
+        } else if(i == 16 * 64 - 1) {
+            assert_int_equal(0x01, rows[i]);
+        } else {
+            assert_int_equal(0x00, rows[i]);
+        }
+    }
+}
+
+static void test__screenshot_read__should__copy_matrix_rows(void **state)
+{
+    const char header[] = "P4\n32 32\n";
+
+    for(int i = 0; i < 32 * 32 / 8; i++) {
+        frame[i] = rand();
+    }
+
+    assert_int_equal(strlen(header) + 32 * 32 / 8, read_image(SCREENSHOT_PBM, &matrix_format, SCREENSHOT_MIN_LEN));
+    assert_memory_equal(header, image, strlen(header));
+    assert_memory_equal(frame, image + strlen(header), 32 * 32 / 8);
+}
+
+static void test__screenshot_read__should__not_depend_on_the_buffer_length(void **state)
+{
+    static uint8_t expected[sizeof(image)];
+
+    for(int i = 0; i < sizeof(frame); i++) {
+        frame[i] = rand();
+    }
+
+    for(enum screenshot_type type = SCREENSHOT_PBM; type <= SCREENSHOT_PNG; type++) {
+        const int len = read_image(type, &oled_format, 256);
+        memcpy(expected, image, len);
+
+        for(uint16_t buf_len = SCREENSHOT_MIN_LEN; buf_len < 100; buf_len++) {
+            assert_int_equal(len, read_image(type, &oled_format, buf_len));
+            assert_memory_equal(expected, image, len);
+        }
+    }
+}
+
+static void test__screenshot_read__should__write_a_png_with_stored_rows(void **state)
+{
+    const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    const uint8_t ihdr[] = { 0, 0, 0, 13, 'I', 'H', 'D', 'R', 0, 0, 0, 128, 0, 0, 0, 64, 1, 0, 0, 0, 0, 0xFA, 0xAD, 0x42, 0xD2 };
+    const uint8_t idat[] = { 0x00, 0x00, 0x04, 0x4B, 'I', 'D', 'A', 'T', 0x78, 0x01, 0x01, 0x40, 0x04, 0xBF, 0xFB };
+    const uint8_t trailer[] = {
+        0x04, 0x40, 0x00, 0x01, 0xB8, 0xE3, 0x7D, 0x2E,
+        0, 0, 0, 0, 'I', 'E', 'N', 'D', 0xAE, 0x42, 0x60, 0x82,
+    };
+
+    const int len = read_image(SCREENSHOT_PNG, &oled_format, SCREENSHOT_MIN_LEN);
+    const int header_len = sizeof(signature) + sizeof(ihdr) + sizeof(idat);
+
+    assert_int_equal(header_len + 17 * 64 + sizeof(trailer), len);
+
+    assert_memory_equal(signature, image, sizeof(signature));
+    assert_memory_equal(ihdr, image + sizeof(signature), sizeof(ihdr));
+    assert_memory_equal(idat, image + sizeof(signature) + sizeof(ihdr), sizeof(idat));
+    assert_int_equal(2 + 5 + 17 * 64 + 4, get32(image + sizeof(signature) + sizeof(ihdr)));
+
+    for(int i = header_len; i < header_len + 17 * 64; i++) {
+        assert_int_equal(0x00, image[i]);
+    }
+
+    assert_memory_equal(trailer, image + len - sizeof(trailer), sizeof(trailer));
+}
+
+static void test__screenshot_read__should__write_lit_png_pixels_as_ones(void **state)
+{
+    const int header_len = 8 + 25 + 15;
+
+    frame[0] = 0x01;
+    frame[127 + 128 * 7] = 0x80;
+
+    read_image(SCREENSHOT_PNG, &oled_format, SCREENSHOT_MIN_LEN);
+
+    const uint8_t *rows = image + header_len;
+
+    assert_int_equal(0x00, rows[0]);
+    assert_int_equal(0x80, rows[1]);
+    assert_int_equal(0x00, rows[17 * 63]);
+    assert_int_equal(0x01, rows[17 * 63 + 16]);
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_screenshot[] = {
+    cmocka_unit_test_setup(test__screenshot_read__should__write_pbm_rows_of_an_oled_frame, setup),
+    cmocka_unit_test_setup(test__screenshot_read__should__copy_matrix_rows, setup),
+    cmocka_unit_test_setup(test__screenshot_read__should__not_depend_on_the_buffer_length, setup),
+    cmocka_unit_test_setup(test__screenshot_read__should__write_a_png_with_stored_rows, setup),
+    cmocka_unit_test_setup(test__screenshot_read__should__write_lit_png_pixels_as_ones, setup),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_screenshot, NULL, NULL);
+
+    return fails;
+}
@@ -0,0 +1,326 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "i2c-master.h"
+#include "sh1106.h"
+#include "sh1106-cmd.h"
+#include "oled_framebuffer.h"
+#include "log.h"
+
+//////// Constants used in tests ///////////////////////////////////////////////
+
+#define OLED_START_COL 2
+#define PANEL_WIDTH 132
+#define PANEL_PAGES 8
+
+#define FULL_FRAME_BYTES (PANEL_PAGES * (7 + OLED_WIDTH))
+
+//////// Mock I2C bus simulating the SH1106 display RAM ////////////////////////
+
+static uint8_t panel[PANEL_PAGES][PANEL_WIDTH];
+static uint8_t panel_col;
+static uint8_t panel_page;
+
+static int bus_bytes;
+static int bus_transactions;
+
+static int transaction_pos;
+static uint8_t transaction_control;
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    assert_int_equal(OLED_I2C_ADDRESS, address);
+    assert_int_equal(I2C_WRITE, rw);
+
+    transaction_pos = 0;
+    bus_transactions++;
+    bus_bytes++;
+
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+uint8_t i2c_write_byte(uint8_t data)
+{
+    bus_bytes++;
+
+    if(transaction_pos++ == 0) {
+        transaction_control = data;
+    } else if(transaction_control == OLED_CONTROL_BYTE_DATA_STREAM) {
+        assert_true(panel_col < PANEL_WIDTH);
+        panel[panel_page][panel_col++] = data;
+    } else if((data & 0xF0) == OLED_CMD_COL_ADDRESS_LOW) {
+        panel_col = (panel_col & 0xF0) | (data & 0x0F);
+    } else if((data & 0xF0) == OLED_CMD_COL_ADDRESS_HIGH) {
+        panel_col = (panel_col & 0x0F) | ((data & 0x0F) << 4);
+    } else if((data & 0xF0) == OLED_CMD_PAGE_ADDRESS) {
+        panel_page = data & 0x07;
+    }
+
+    return I2C_ACK;
+}
+
+uint16_t i2c_write(const uint8_t *data, uint16_t len)
+{
+    for(uint16_t i = 0; i < len; i++) {
+        i2c_write_byte(data[i]);
+    }
+    return len;
+}
+
+//////// Stubs needed by oled_framebuffer.c ////////////////////////////////////
+
+const uint8_t paw_64x64[1];
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+static uint8_t icon8x8[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static void assert_panel_shows_framebuffer(void)
+{
+    for(int page = 0; page < PANEL_PAGES; page++) {
+        assert_memory_equal(framebuffer + page * OLED_WIDTH, &panel[page][OLED_START_COL], OLED_WIDTH);
+    }
+}
+
+static void display(void)
+{
+    bus_bytes = 0;
+    bus_transactions = 0;
+
+    oled_display();
+
+    assert_int_equal(bus_bytes, sh1106_get_frame_bytes());
+    assert_panel_shows_framebuffer();
+}
+
+static void draw_scene(int16_t shift)
+{
+    oled_clear();
+    fb_set_pen(FB_NORMAL);
+    oled_draw_rect(shift, 0, 20, 12);
+    oled_blit(60 + shift, 30, 8, 8, icon8x8, 0);
+    oled_fill_rect(100, 48, 10, 10);
+}
+
+static int setup(void **state)
+{
+    memset(panel, 0x55, sizeof(panel));
+
+    fb_set_pen(FB_NORMAL);
+    oled_clear();
+    oled_clear_dirty();
+
+    assert_int_equal(0, sh1106_init());
+
+    return 0;
+}
+
+//////// Test //////////////////////////////////////////////////////////////////
+
+static void test__oled_display__sends_full_frame_after_init(void **state)
+{
+    draw_scene(0);
+    display();
+
+    assert_int_equal(FULL_FRAME_BYTES, bus_bytes);
+}
+
+static void test__oled_display__sends_nothing_if_redrawn_frame_is_unchanged(void **state)
+{
+    draw_scene(0);
+    display();
+
+    draw_scene(0);
+    display();
+
+    assert_int_equal(0, bus_bytes);
+    assert_int_equal(0, bus_transactions);
+}
+
+static void test__oled_display__sends_only_changed_bytes(void **state)
+{
+    draw_scene(0);
+    display();
+
+    draw_scene(0);
+    oled_set_pixel(70, 20);
+    display();
+
+    assert_int_equal(7 + 1, bus_bytes);
+    assert_int_equal(2, bus_transactions);
+}
+
+static void test__oled_display__joins_spans_separated_by_short_gaps(void **state)
+{
+    display();
+
+    oled_set_pixel(10, 0);
+    oled_set_pixel(12, 0);
+    display();
+
+    assert_int_equal(7 + 3, bus_bytes);
+    assert_int_equal(2, bus_transactions);
+}
+
+static void test__oled_display__splits_spans_separated_by_long_gaps(void **state)
+{
+    display();
+
+    oled_set_pixel(10, 0);
+    oled_set_pixel(100, 0);
+    display();
+
+    assert_int_equal(2 * (7 + 1), bus_bytes);
+    assert_int_equal(4, bus_transactions);
+}
+
+static void test__oled_display__sends_cleared_columns(void **state)
+{
+    draw_scene(0);
+    display();
+
+    oled_clear();
+    display();
+
+    assert_true(bus_bytes > 0);
+    assert_true(bus_bytes < FULL_FRAME_BYTES);
+}
+
+static void test__oled_display__sends_changes_drawn_with_inverse_pen(void **state)
+{
+    oled_fill_rect(0, 0, OLED_WIDTH, OLED_HEIGHT);
+    display();
+
+    fb_set_pen(FB_INVERSE);
+    oled_fill_rect(40, 20, 4, 4);
+    display();
+
+    assert_int_equal(7 + 4, bus_bytes);
+}
+
+static void test__oled_display__sends_full_frame_after_reinit(void **state)
+{
+    draw_scene(0);
+    display();
+
+    assert_int_equal(0, sh1106_init());
+    display();
+
+    assert_int_equal(FULL_FRAME_BYTES, bus_bytes);
+}
+
+static void test__oled_display__sends_less_while_shifting_rows(void **state)
+{
+    int total = 0;
+
+    draw_scene(0);
+    display();
+
+    for(int16_t shift = 1; shift <= 20; shift++) {
+        draw_scene(shift);
+        display();
+        total += bus_bytes;
+    }
+
+    assert_true(total < 20 * FULL_FRAME_BYTES / 10);
+}
+
+static void test__oled_display__keeps_panel_in_sync_with_random_drawing(void **state)
+{
+    srand(1);
+
+    for(int frame = 0; frame < 200; frame++) {
+        if(rand() % 4 == 0) {
+            oled_clear();
+        }
+
+        for(int n = rand() % 8; n > 0; n--) {
+            fb_set_pen(rand() % 2 ? FB_NORMAL : FB_INVERSE);
+            oled_fill_rect(rand() % 140 - 6, rand() % 72 - 4, rand() % 20, rand() % 20);
+        }
+
+        display();
+    }
+}
+
+static void send_front(const uint8_t *front)
+{
+    bus_bytes = 0;
+
+    sh1106_send_frame(front);
+
+    assert_int_equal(bus_bytes, sh1106_get_frame_bytes());
+
+    for(int page = 0; page < PANEL_PAGES; page++) {
+        assert_memory_equal(front + page * OLED_WIDTH, &panel[page][OLED_START_COL], OLED_WIDTH);
+    }
+}
+
+static void test__sh1106_send_frame__sends_front_buffer_while_back_buffer_is_drawn(void **state)
+{
+    static uint8_t buffers[2][OLED_SIZE];
+    uint8_t *old_framebuffer = framebuffer;
+    uint8_t *front = 0;
+
+    framebuffer = buffers[0];
+
+    for(int frame = 0; frame < 40; frame++) {
+        draw_scene(frame % 16);
+
+        // The previous frame is sent while this one is drawn
+        if(front) {
+            send_front(front);
+        }
+
+        // Swap the buffers the way display_flush_swap does
+        sh1106_prepare_frame();
+
+        uint8_t *back = front ? front : buffers[1];
+        front = framebuffer;
+        framebuffer = back;
+    }
+
+    send_front(front);
+
+    framebuffer = old_framebuffer;
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_oled_display[] = {
+    cmocka_unit_test_setup(test__oled_display__sends_full_frame_after_init, setup),
+    cmocka_unit_test_setup(test__oled_display__sends_nothing_if_redrawn_frame_is_unchanged, setup),
+    cmocka_unit_test_setup(test__oled_display__sends_only_changed_bytes, setup),
+    cmocka_unit_test_setup(test__oled_display__joins_spans_separated_by_short_gaps, setup),
+    cmocka_unit_test_setup(test__oled_display__splits_spans_separated_by_long_gaps, setup),
+    cmocka_unit_test_setup(test__oled_display__sends_cleared_columns, setup),
+    cmocka_unit_test_setup(test__oled_display__sends_changes_drawn_with_inverse_pen, setup),
+    cmocka_unit_test_setup(test__oled_display__sends_full_frame_after_reinit, setup),
+    cmocka_unit_test_setup(test__oled_display__sends_less_while_shifting_rows, setup),
+    cmocka_unit_test_setup(test__oled_display__keeps_panel_in_sync_with_random_drawing, setup),
+    cmocka_unit_test_setup(test__sh1106_send_frame__sends_front_buffer_while_back_buffer_is_drawn, setup),
+};
+
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_oled_display, NULL, NULL);
+
+    return fails;
+}
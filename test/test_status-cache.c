@@ -0,0 +1,253 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <cmocka.h>
+
+#include "status-cache.h"
+#include "json-writer.h"
+#include "log.h"
+
+//////// Stubs /////////////////////////////////////////////////////////////////
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+    va_list va;
+    va_start(va, fmt);
+    vprintf(fmt, va);
+    va_end(va);
+
+    printf("\n");
+}
+
+int http_write_string(struct http_request *request, const char *str)
+{
+    return strlen(str);
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+char *output_string = 0;
+
+int num_calls;
+int value;
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+static int output_write_string(void *user, const char *str)
+{
+    strcat(output_string, str);
+    return strlen(str);
+}
+
+static void write_system(struct json_writer *json)
+{
+    num_calls++;
+
+    json_writer_begin_object(json, "system");
+    json_writer_write_int(json, "heap", value);
+    json_writer_end_object(json);
+}
+
+static void write_journies(struct json_writer *json)
+{
+    num_calls++;
+
+    json_writer_begin_array(json, "journies");
+    json_writer_write_int(json, NULL, value);
+    json_writer_end_array(json);
+}
+
+// The value gains a digit between counting and writing the section
+static void write_growing_journies(struct json_writer *json)
+{
+    if(num_calls == 1) {
+        value = 1234;
+    }
+
+    write_journies(json);
+}
+
+// The value gains a digit every time the section is written
+static void write_always_growing_journies(struct json_writer *json)
+{
+    value = value * 10 + 1;
+    write_journies(json);
+}
+
+static void write_cache(void)
+{
+    struct json_writer json = {
+        .current = 0,
+        .user = NULL,
+        .write_string = output_write_string,
+    };
+
+    status_cache_write(&json);
+}
+
+//////// Test //////////////////////////////////////////////////////////////////
+
+static void test__status_cache_update__serializes_the_section_the_first_time(void **state)
+{
+    assert_int_equal(1, status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100));
+    assert_int_equal(2, num_calls);
+    assert_int_equal(1, status_cache_get_version(STATUS_SECTION_JOURNIES));
+}
+
+static void test__status_cache_update__does_not_serialize_a_clean_section(void **state)
+{
+    status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100);
+    num_calls = 0;
+
+    assert_int_equal(0, status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 200));
+    assert_int_equal(0, num_calls);
+    assert_int_equal(1, status_cache_get_version(STATUS_SECTION_JOURNIES));
+}
+
+static void test__status_cache_update__keeps_the_version_if_the_data_is_unchanged(void **state)
+{
+    status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100);
+    status_cache_invalidate(STATUS_SECTION_JOURNIES);
+
+    assert_int_equal(0, status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100));
+    assert_int_equal(1, status_cache_get_version(STATUS_SECTION_JOURNIES));
+}
+
+static void test__status_cache_update__bumps_the_version_if_the_data_has_changed(void **state)
+{
+    status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100);
+    status_cache_invalidate(STATUS_SECTION_JOURNIES);
+    value = 1234;
+
+    assert_int_equal(1, status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100));
+    assert_int_equal(2, status_cache_get_version(STATUS_SECTION_JOURNIES));
+}
+
+static void test__status_cache_update__resamples_a_section_after_its_max_age(void **state)
+{
+    status_cache_update(STATUS_SECTION_SYSTEM, write_system, 100);
+    value = 1234;
+
+    assert_int_equal(0, status_cache_update(STATUS_SECTION_SYSTEM, write_system, 101));
+    assert_int_equal(1, status_cache_update(STATUS_SECTION_SYSTEM, write_system, 200));
+    assert_int_equal(2, status_cache_get_version(STATUS_SECTION_SYSTEM));
+}
+
+static void test__status_cache_update__writes_the_whole_section_if_it_grows(void **state)
+{
+    assert_int_equal(1, status_cache_update(STATUS_SECTION_JOURNIES, write_growing_journies, 100));
+
+    write_cache();
+
+    assert_string_equal("{\"journies\":[1234]}", output_string);
+    assert_int_equal(strlen(output_string), status_cache_get_length());
+}
+
+static void test__status_cache_update__keeps_the_section_dirty_if_it_keeps_growing(void **state)
+{
+    assert_int_equal(0, status_cache_update(STATUS_SECTION_JOURNIES, write_always_growing_journies, 100));
+    assert_int_equal(0, status_cache_get_version(STATUS_SECTION_JOURNIES));
+
+    num_calls = 0;
+    assert_int_equal(1, status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100));
+    assert_int_equal(2, num_calls);
+}
+
+static void test__status_cache_write__writes_an_empty_object_if_there_are_no_sections(void **state)
+{
+    write_cache();
+
+    assert_string_equal("{}", output_string);
+    assert_int_equal(strlen(output_string), status_cache_get_length());
+}
+
+static void test__status_cache_write__joins_the_sections(void **state)
+{
+    value = 42;
+    status_cache_update(STATUS_SECTION_SYSTEM, write_system, 100);
+    status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100);
+
+    write_cache();
+
+    assert_string_equal("{\"system\":{\"heap\":42},\"journies\":[42]}", output_string);
+    assert_int_equal(strlen(output_string), status_cache_get_length());
+}
+
+static void test__status_cache_get_etag__changes_when_a_section_changes(void **state)
+{
+    char etag1[STATUS_CACHE_ETAG_LEN];
+    char etag2[STATUS_CACHE_ETAG_LEN];
+
+    status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100);
+    status_cache_get_etag(etag1, sizeof(etag1));
+
+    status_cache_invalidate(STATUS_SECTION_JOURNIES);
+    status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100);
+    status_cache_get_etag(etag2, sizeof(etag2));
+
+    assert_string_equal(etag1, etag2);
+
+    status_cache_invalidate(STATUS_SECTION_JOURNIES);
+    value = 1;
+    status_cache_update(STATUS_SECTION_JOURNIES, write_journies, 100);
+    status_cache_get_etag(etag2, sizeof(etag2));
+
+    assert_string_not_equal(etag1, etag2);
+}
+
+static void test__status_cache_get_etag__depends_on_the_epoch(void **state)
+{
+    char etag1[STATUS_CACHE_ETAG_LEN];
+    char etag2[STATUS_CACHE_ETAG_LEN];
+
+    status_cache_get_etag(etag1, sizeof(etag1));
+    status_cache_init(0x5678);
+    status_cache_get_etag(etag2, sizeof(etag2));
+
+    assert_string_not_equal(etag1, etag2);
+    assert_string_equal("\"00005678-0000-0000-0000-0000-0000\"", etag2);
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+int setup(void **state)
+{
+    output_string = calloc(1024, 1);
+    num_calls = 0;
+    value = 0;
+    status_cache_init(0x1234);
+    return 0;
+}
+
+int teardown(void **state)
+{
+    free(output_string);
+    return 0;
+}
+
+const struct CMUnitTest tests_for_status_cache[] = {
+    cmocka_unit_test_setup_teardown(test__status_cache_update__serializes_the_section_the_first_time, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__status_cache_update__does_not_serialize_a_clean_section, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__status_cache_update__keeps_the_version_if_the_data_is_unchanged, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__status_cache_update__bumps_the_version_if_the_data_has_changed, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__status_cache_update__resamples_a_section_after_its_max_age, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__status_cache_update__writes_the_whole_section_if_it_grows, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__status_cache_update__keeps_the_section_dirty_if_it_keeps_growing, setup, teardown),
+
+    cmocka_unit_test_setup_teardown(test__status_cache_write__writes_an_empty_object_if_there_are_no_sections, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__status_cache_write__joins_the_sections, setup, teardown),
+
+    cmocka_unit_test_setup_teardown(test__status_cache_get_etag__changes_when_a_section_changes, setup, teardown),
+    cmocka_unit_test_setup_teardown(test__status_cache_get_etag__depends_on_the_epoch, setup, teardown),
+};
+
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_status_cache, NULL, NULL);
+
+    return fails;
+}
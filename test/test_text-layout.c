@@ -0,0 +1,147 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "text-layout.h"
+#include "oled_framebuffer.h"
+#include "i2c-master.h"
+#include "fonts.h"
+#include "log.h"
+
+//////// Stubs needed by the framebuffer ///////////////////////////////////////
+
+const uint8_t paw_64x64[1];
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+void oled_display(void)
+{
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__text_layout_init__should__split_lines(void **state)
+{
+    struct text_layout layout;
+    const uint8_t *font = ArialMT_Plain_10;
+
+    text_layout_init(&layout, "Connect to\nSL-clock\n\nto configure", font);
+
+    assert_int_equal(4, layout.num_lines);
+
+    assert_int_equal(0, layout.line_start[0]);
+    assert_int_equal(10, layout.line_len[0]);
+    assert_int_equal(11, layout.line_start[1]);
+    assert_int_equal(8, layout.line_len[1]);
+    assert_int_equal(0, layout.line_len[2]);
+    assert_int_equal(21, layout.line_start[3]);
+    assert_int_equal(12, layout.line_len[3]);
+
+    assert_int_equal(fb_string_length("Connect to", 0, font), layout.line_width[0]);
+    assert_int_equal(fb_string_length("SL-clock", 0, font), layout.line_width[1]);
+    assert_int_equal(0, layout.line_width[2]);
+    assert_int_equal(fb_string_length("to configure", 0, font), layout.line_width[3]);
+
+    assert_int_equal(fb_string_length("to configure", 0, font), layout.width);
+    assert_int_equal(4 * font[FONT_HEIGHT_POS], layout.height);
+}
+
+static void test__text_layout_init__should__handle_single_line(void **state)
+{
+    struct text_layout layout;
+
+    text_layout_init(&layout, "Hello", font_3x5);
+
+    assert_int_equal(1, layout.num_lines);
+    assert_int_equal(5, layout.line_len[0]);
+    assert_int_equal(fb_string_length("Hello", 0, font_3x5), layout.width);
+    assert_int_equal(font_3x5[FONT_HEIGHT_POS], layout.height);
+}
+
+static void test__text_layout_init__should__drop_lines_beyond_the_last(void **state)
+{
+    struct text_layout layout;
+
+    text_layout_init(&layout, "1\n2\n3\n4\n5 is a long line", font_3x5);
+
+    assert_int_equal(TEXT_LAYOUT_MAX_LINES, layout.num_lines);
+    assert_int_equal(fb_string_length("4", 0, font_3x5), layout.width);
+}
+
+static void test__text_layout_init__should__copy_the_text(void **state)
+{
+    struct text_layout layout;
+    char text[TEXT_LAYOUT_MAX_LEN * 2];
+
+    strcpy(text, "Line 1\nLine 2");
+    text_layout_init(&layout, text, font_3x5);
+    strcpy(text, "Something else");
+
+    assert_memory_equal("Line 2", &layout.text[layout.line_start[1]], layout.line_len[1]);
+
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = 0;
+    text_layout_init(&layout, text, font_3x5);
+
+    assert_int_equal(1, layout.num_lines);
+    assert_int_equal(TEXT_LAYOUT_MAX_LEN - 1, layout.line_len[0]);
+}
+
+static void test__text_layout_draw__should__draw_centered_lines(void **state)
+{
+    static uint8_t expected[OLED_SIZE];
+    struct text_layout layout;
+    const uint8_t *font = ArialMT_Plain_10;
+    const uint8_t line_h = font[FONT_HEIGHT_POS];
+
+    fb_blit = oled_blit;
+    fb_set_pen(FB_NORMAL);
+
+    text_layout_init(&layout, "WIFI not found\nConnect to\nSL-clock", font);
+
+    const int16_t y = 40 - 3 * line_h / 2;
+
+    oled_clear();
+    fb_draw_string(64, y + line_h / 2, "WIFI not found", 0, font, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+    fb_draw_string(64, y + line_h + line_h / 2, "Connect to", 0, font, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+    fb_draw_string(64, y + 2 * line_h + line_h / 2, "SL-clock", 0, font, FB_ALIGN_CENTER_V | FB_ALIGN_CENTER_H);
+    memcpy(expected, framebuffer, OLED_SIZE);
+
+    oled_clear();
+    text_layout_draw(&layout, 64, 40);
+
+    assert_memory_equal(expected, framebuffer, OLED_SIZE);
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_text_layout[] = {
+    cmocka_unit_test(test__text_layout_init__should__split_lines),
+    cmocka_unit_test(test__text_layout_init__should__handle_single_line),
+    cmocka_unit_test(test__text_layout_init__should__drop_lines_beyond_the_last),
+    cmocka_unit_test(test__text_layout_init__should__copy_the_text),
+    cmocka_unit_test(test__text_layout_draw__should__draw_centered_lines),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_text_layout, NULL, NULL);
+
+    return fails;
+}
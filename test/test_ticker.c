@@ -0,0 +1,240 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ticker.h"
+#include "framebuffer.h"
+#include "oled_framebuffer.h"
+#include "matrix_framebuffer.h"
+#include "fonts.h"
+#include "i2c-master.h"
+#include "log.h"
+
+//////// Stubs needed by the framebuffer code //////////////////////////////////
+
+const uint8_t paw_64x64[1];
+
+void log_log(enum log_level level, enum log_system system, const char *fmt, ...)
+{
+}
+
+uint8_t i2c_start(uint8_t address, uint8_t rw)
+{
+    return I2C_ACK;
+}
+
+void i2c_stop(void)
+{
+}
+
+void oled_display(void)
+{
+}
+
+//////// Global variables used for testing /////////////////////////////////////
+
+#define X 20
+#define Y 30
+#define WIDTH 50
+
+#define LONG_TEXT "Hässelby strand via Brommaplan"
+
+static struct ticker ticker;
+static uint8_t reference[OLED_SIZE];
+
+//////// Helper functions for testing //////////////////////////////////////////
+
+// The offset of the text at now_ms, worked out from the timing in ticker.h
+static uint16_t offset_at(uint32_t now_ms, uint16_t round)
+{
+    const uint32_t t = now_ms % (TICKER_HOLD_MS + round * TICKER_PIXEL_MS);
+
+    return (t < TICKER_HOLD_MS) ? 0 : (t - TICKER_HOLD_MS) / TICKER_PIXEL_MS;
+}
+
+// Draw the text the slow way, once per round that shows in the region, and
+// clear everything outside the region
+static void draw_reference(const char *text, const uint8_t *font, uint16_t offset, uint16_t round)
+{
+    oled_clear();
+    fb_draw_string(X - offset, Y, text, 0, font, FB_ALIGN_CENTER_V);
+    fb_draw_string(X - offset + round, Y, text, 0, font, FB_ALIGN_CENTER_V);
+
+    for(int page = 0; page < OLED_HEIGHT / 8; page++) {
+        for(int x = 0; x < OLED_WIDTH; x++) {
+            if((x < X) || (x >= X + WIDTH)) {
+                framebuffer[page * OLED_WIDTH + x] = 0;
+            }
+        }
+    }
+
+    memcpy(reference, framebuffer, OLED_SIZE);
+}
+
+static uint32_t draw_ticker(uint32_t now_ms)
+{
+    struct display_schedule schedule;
+
+    display_schedule_init(&schedule);
+
+    oled_clear();
+    ticker_draw(&ticker, X, Y, now_ms, &schedule);
+
+    return display_schedule_delay_ms(&schedule);
+}
+
+static void assert_scrolls_like_reference(const char *text, const uint8_t *font, const uint32_t *times, int num)
+{
+    const uint16_t round = fb_string_length(text, 0, font) + TICKER_GAP;
+
+    ticker_init(&ticker, font, WIDTH);
+    ticker_set_text(&ticker, text, 0);
+
+    for(int i = 0; i < num; i++) {
+        draw_ticker(times[i]);
+        memcpy(reference, framebuffer, OLED_SIZE);
+
+        draw_reference(text, font, offset_at(times[i], round), round);
+
+        if(memcmp(reference, framebuffer, OLED_SIZE)) {
+            fail_msg("Frame at %u ms differs", times[i]);
+        }
+    }
+}
+
+static int setup(void **state)
+{
+    fb_blit = oled_blit;
+    fb_set_pen(FB_NORMAL);
+
+    return 0;
+}
+
+//////// Tests /////////////////////////////////////////////////////////////////
+
+static void test__ticker_draw__should__center_text_that_fits(void **state)
+{
+    ticker_init(&ticker, font_3x5, WIDTH);
+    ticker_set_text(&ticker, "Bålsta", 0);
+
+    assert_int_equal(DISPLAY_SCHEDULE_MAX_DELAY_MS, draw_ticker(5000));
+    memcpy(reference, framebuffer, OLED_SIZE);
+
+    oled_clear();
+    fb_draw_string(X + WIDTH / 2, Y, "Bålsta", 0, font_3x5, FB_ALIGN_CENTER_H | FB_ALIGN_CENTER_V);
+
+    assert_memory_equal(framebuffer, reference, OLED_SIZE);
+}
+
+static void test__ticker_draw__should__scroll_pixel_by_pixel(void **state)
+{
+    uint32_t times[400];
+
+    for(int i = 0; i < 400; i++) {
+        times[i] = TICKER_HOLD_MS - 100 + i * TICKER_PIXEL_MS;
+    }
+
+    assert_scrolls_like_reference(LONG_TEXT, font_3x5, times, 400);
+    assert_scrolls_like_reference(LONG_TEXT, ArialMT_Plain_10, times, 400);
+}
+
+static void test__ticker_draw__should__catch_up_after_missed_frames(void **state)
+{
+    const uint32_t times[] = { 0, 1600, 1700, 2300, 2340, 4000, 4040, 9000, 9013, 60000, 60100, 3600000, 3600040, 3650000 };
+
+    assert_scrolls_like_reference(LONG_TEXT, font_3x5, times, sizeof(times) / sizeof(times[0]));
+    assert_scrolls_like_reference(LONG_TEXT, ArialMT_Plain_10, times, sizeof(times) / sizeof(times[0]));
+}
+
+static void test__ticker_draw__should__ask_for_a_frame_when_the_text_moves(void **state)
+{
+    ticker_init(&ticker, font_3x5, WIDTH);
+    ticker_set_text(&ticker, LONG_TEXT, 1000);
+
+    // The wait is capped by the display schedule
+    assert_int_equal(DISPLAY_SCHEDULE_MAX_DELAY_MS, draw_ticker(1000));
+    assert_int_equal(300, draw_ticker(1000 + TICKER_HOLD_MS - 300));
+    assert_int_equal(TICKER_PIXEL_MS, draw_ticker(1000 + TICKER_HOLD_MS));
+    assert_int_equal(TICKER_PIXEL_MS - 10, draw_ticker(1000 + TICKER_HOLD_MS + 10));
+}
+
+static void test__ticker_set_text__should__only_restart_on_new_text(void **state)
+{
+    const uint16_t round = fb_string_length(LONG_TEXT, 0, font_3x5) + TICKER_GAP;
+    const uint32_t now = TICKER_HOLD_MS + 20 * TICKER_PIXEL_MS;
+
+    ticker_init(&ticker, font_3x5, WIDTH);
+    ticker_set_text(&ticker, LONG_TEXT, 0);
+
+    ticker_set_text(&ticker, LONG_TEXT, now);
+    draw_ticker(now);
+    memcpy(reference, framebuffer, OLED_SIZE);
+    draw_reference(LONG_TEXT, font_3x5, 20, round);
+    assert_memory_equal(framebuffer, reference, OLED_SIZE);
+
+    ticker_set_text(&ticker, "Mörby centrum via Danderyds sjukhus", now);
+    draw_ticker(now);
+    memcpy(reference, framebuffer, OLED_SIZE);
+    draw_reference("Mörby centrum via Danderyds sjukhus", font_3x5, 0, round);
+    assert_memory_equal(framebuffer, reference, OLED_SIZE);
+}
+
+static void test__ticker_draw__should__draw_on_the_matrix(void **state)
+{
+    uint8_t expected[MATRIX_SIZE];
+
+    fb_blit = matrix_blit;
+
+    ticker_init(&ticker, font_3x5, 24);
+    ticker_set_text(&ticker, "17 Åkeshov", 0);
+
+    const uint16_t round = fb_string_length("17 Åkeshov", 0, font_3x5) + TICKER_GAP;
+
+    for(int i = 0; i < 100; i++) {
+        const uint32_t now = TICKER_HOLD_MS + i * TICKER_PIXEL_MS;
+        const uint16_t offset = offset_at(now, round);
+        struct display_schedule schedule;
+
+        display_schedule_init(&schedule);
+
+        matrix_clear();
+        fb_draw_string(4 - offset, 10, "17 Åkeshov", 0, font_3x5, FB_ALIGN_CENTER_V);
+        fb_draw_string(4 - offset + round, 10, "17 Åkeshov", 0, font_3x5, FB_ALIGN_CENTER_V);
+
+        // Clear the columns outside the region, the leftmost pixel is the MSB
+        for(int y = 0; y < MATRIX_HEIGHT; y++) {
+            framebuffer[y * MATRIX_WIDTH / 8] &= 0x0F;
+            framebuffer[y * MATRIX_WIDTH / 8 + 3] &= 0xF0;
+            memset(&framebuffer[y * MATRIX_WIDTH / 8 + 4], 0, MATRIX_WIDTH / 8 - 4);
+        }
+        memcpy(expected, framebuffer, MATRIX_SIZE);
+
+        matrix_clear();
+        ticker_draw(&ticker, 4, 10, now, &schedule);
+
+        assert_memory_equal(expected, framebuffer, MATRIX_SIZE);
+    }
+}
+
+//////// Main //////////////////////////////////////////////////////////////////
+
+const struct CMUnitTest tests_for_ticker[] = {
+    cmocka_unit_test_setup(test__ticker_draw__should__center_text_that_fits, setup),
+    cmocka_unit_test_setup(test__ticker_draw__should__scroll_pixel_by_pixel, setup),
+    cmocka_unit_test_setup(test__ticker_draw__should__catch_up_after_missed_frames, setup),
+    cmocka_unit_test_setup(test__ticker_draw__should__ask_for_a_frame_when_the_text_moves, setup),
+    cmocka_unit_test_setup(test__ticker_set_text__should__only_restart_on_new_text, setup),
+    cmocka_unit_test_setup(test__ticker_draw__should__draw_on_the_matrix, setup),
+};
+
+int main(void)
+{
+    int fails = 0;
+    fails += cmocka_run_group_tests(tests_for_ticker, NULL, NULL);
+
+    return fails;
+}
@@ -0,0 +1,72 @@
+#ifndef FONT_RLE_H_
+#define FONT_RLE_H_
+
+// Run length encoding of glyphs as described in src/fonts.h, shared by the
+// font tools
+
+#include <stdint.h>
+
+#define FONT_RLE_FLAG 0x80
+#define FONT_RLE_EXTEND 15
+
+// The longest encoded glyph, since the size in the jump table is one byte
+#define FONT_RLE_MAX_BYTES 255
+
+struct font_rle_writer
+{
+    uint8_t *out;
+    int nibbles;
+};
+
+static void font_rle_put(struct font_rle_writer *writer, uint8_t nibble)
+{
+    if(writer->nibbles & 1) {
+        writer->out[writer->nibbles / 2] |= nibble;
+    } else {
+        writer->out[writer->nibbles / 2] = nibble << 4;
+    }
+    writer->nibbles++;
+}
+
+static void font_rle_put_run(struct font_rle_writer *writer, int run)
+{
+    while(run >= FONT_RLE_EXTEND) {
+        font_rle_put(writer, FONT_RLE_EXTEND);
+        run -= FONT_RLE_EXTEND;
+    }
+    font_rle_put(writer, run);
+}
+
+// Encode a glyph stored column by column, as in plain fonts, into out, which
+// must hold 2 * size + 1 bytes. Returns the number of encoded bytes.
+static int font_rle_encode(uint8_t *out, const uint8_t *data, int size, int width, int height)
+{
+    const int raster_height = 1 + (height - 1) / 8;
+    struct font_rle_writer writer = { .out = out, .nibbles = 0 };
+
+    int set = 0;
+    int run = 0;
+
+    for(int x = 0; x < width; x++) {
+        for(int y = 0; y < height; y++) {
+            const int n = x * raster_height + y / 8;
+            const int pixel = (n < size) && (data[n] & (1 << (y % 8)));
+
+            if(pixel != set) {
+                font_rle_put_run(&writer, run);
+                set = pixel;
+                run = 0;
+            }
+            run++;
+        }
+    }
+
+    // The trailing clear run is left out
+    if(set) {
+        font_rle_put_run(&writer, run);
+    }
+
+    return (writer.nibbles + 1) / 2;
+}
+
+#endif
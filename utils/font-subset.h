@@ -0,0 +1,59 @@
+#ifndef FONT_SUBSET_H_
+#define FONT_SUBSET_H_
+
+// Character sets for fonts that only hold a subset of the characters, see
+// FONT_SPARSE_FLAG in src/fonts.h, shared by the font tools
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FONT_SPARSE_FLAG 0x40
+
+// Parse a list of characters, given in Latin-1 or UTF-8, into a table with a
+// non-zero entry for each character in the set. Returns the number of
+// characters, or -1 if there is a character outside Latin-1.
+static int font_subset_parse(uint8_t set[256], const char *chars)
+{
+    const uint8_t *p = (const uint8_t *)chars;
+    int num = 0;
+
+    memset(set, 0, 256);
+
+    while(*p) {
+        uint8_t c = *p++;
+
+        // Two byte UTF-8 sequences cover U+0080 to U+07FF, of which only
+        // the Latin-1 part is used
+        if(((c & 0xE0) == 0xC0) && ((*p & 0xC0) == 0x80)) {
+            if(c > 0xC3) {
+                return -1;
+            }
+            c = (c & 0x1F) << 6 | (*p++ & 0x3F);
+        } else if(c >= 0xE0) {
+            return -1;
+        }
+
+        if(!set[c]) {
+            set[c] = 1;
+            num++;
+        }
+    }
+
+    return num;
+}
+
+// Write the list of character codes that follows the header of a sparse font
+static void font_subset_write_codes(FILE *f, const uint8_t set[256], int first_char, int num_chars)
+{
+    fprintf(f, "  // Characters:\n");
+    fprintf(f, "  ");
+    for(int c = first_char; c < first_char + num_chars; c++) {
+        if(set[c]) {
+            fprintf(f, "0x%02X,", c);
+        }
+    }
+    fprintf(f, "\n\n");
+}
+
+#endif
@@ -0,0 +1,203 @@
+// Convert fonts from src/fonts.c to run length encoded fonts, see src/fonts.h
+//
+// Usage: font-to-rle [-c <chars>] <font>... > fonts-rle.c
+//
+// Each font is written as <font>_rle, e.g. ArialMT_Plain_10_rle. With -c only
+// the given characters of the following font are kept, as a sparse font. The
+// sizes of the plain and encoded fonts are written to stderr.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fonts.h"
+#include "font-rle.h"
+#include "font-subset.h"
+
+struct font_entry
+{
+    const char *name;
+    const uint8_t *font;
+};
+
+static const struct font_entry fonts[] = {
+    { "ArialMT_Plain_10", ArialMT_Plain_10 },
+    { "ArialMT_Plain_16", ArialMT_Plain_16 },
+    { "ArialMT_Plain_24", ArialMT_Plain_24 },
+    { "Monospaced_bold_16", Monospaced_bold_16 },
+    { "Monospaced_plain_28", Monospaced_plain_28 },
+    { "font_3x5", font_3x5 },
+    { "font_5x7", font_5x7 },
+    { "font_6x12", font_6x12 },
+};
+
+static const uint8_t *find_font(const char *name)
+{
+    for(int i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+        if(!strcmp(fonts[i].name, name)) {
+            return fonts[i].font;
+        }
+    }
+    return 0;
+}
+
+// Write the font, keeping the characters in set, or all of them if set is 0
+static int write_font(const char *name, const uint8_t *font, const uint8_t *set)
+{
+    const uint8_t width = font[FONT_WIDTH_POS];
+    const uint8_t height = font[FONT_HEIGHT_POS];
+    const uint8_t first_char = font[FONT_FIRST_CHAR_POS];
+    const uint8_t char_num = font[FONT_CHAR_NUM_POS];
+    const uint8_t *glyphs = font + FONT_JUMPTABLE_START + char_num * FONT_JUMPTABLE_BYTES;
+
+    uint8_t *encoded[char_num];
+    int sizes[char_num];
+    int plain_size = 0;
+    int offset = 0;
+
+    if(width & (FONT_RLE_FLAG | FONT_SPARSE_FLAG)) {
+        fprintf(stderr, "%s is already converted\n", name);
+        return 0;
+    }
+
+    uint8_t keep[256] = { 0 };
+    int sparse_first = -1;
+    int sparse_num = 0;
+
+    for(int n = 0; n < char_num; n++) {
+        keep[first_char + n] = !set || set[first_char + n];
+
+        if(keep[first_char + n]) {
+            if(sparse_first < 0) {
+                sparse_first = first_char + n;
+            }
+            sparse_num++;
+        }
+    }
+
+    if(!sparse_num) {
+        fprintf(stderr, "%s has none of the characters\n", name);
+        return 0;
+    }
+
+    printf("\nconst uint8_t %s_rle[] = {\n", name);
+    if(set) {
+        printf("  0x%02X, // Width: %d, run length encoded, sparse\n", width | FONT_RLE_FLAG | FONT_SPARSE_FLAG, width);
+        printf("  0x%02X, // Height: %d\n", height, height);
+        printf("  0x%02X, // First Char: %d\n", sparse_first, sparse_first);
+        printf("  0x%02X, // Number of Chars: %d\n", sparse_num, sparse_num);
+        printf("\n");
+        font_subset_write_codes(stdout, keep, first_char, char_num);
+    } else {
+        printf("  0x%02X, // Width: %d, run length encoded\n", width | FONT_RLE_FLAG, width);
+        printf("  0x%02X, // Height: %d\n", height, height);
+        printf("  0x%02X, // First Char: %d\n", first_char, first_char);
+        printf("  0x%02X, // Number of Chars: %d\n", char_num, char_num);
+        printf("\n");
+    }
+    printf("  // Jump Table:\n");
+
+    for(int n = 0; n < char_num; n++) {
+        const uint8_t *entry = font + FONT_JUMPTABLE_START + n * FONT_JUMPTABLE_BYTES;
+        const uint16_t index = (entry[FONT_JUMPTABLE_MSB] << 8) | entry[FONT_JUMPTABLE_LSB];
+        const uint8_t size = entry[FONT_JUMPTABLE_SIZE];
+        const uint8_t char_width = entry[FONT_JUMPTABLE_WIDTH];
+
+        encoded[n] = 0;
+        sizes[n] = 0;
+
+        if(!keep[first_char + n]) {
+            continue;
+        }
+
+        if(index == 0xFFFF) {
+            printf("  0xFF, 0xFF, 0x00, 0x%02X,  // %d:65535\n", char_width, first_char + n);
+            continue;
+        }
+
+        plain_size += size;
+
+        encoded[n] = malloc(2 * size + 1);
+        sizes[n] = font_rle_encode(encoded[n], glyphs + index, size, char_width, height);
+
+        if(sizes[n] > FONT_RLE_MAX_BYTES) {
+            fprintf(stderr, "Glyph %d of %s is too large\n", first_char + n, name);
+            return 0;
+        }
+
+        printf("  0x%02X, 0x%02X, 0x%02X, 0x%02X,  // %d:%d\n", offset >> 8, offset & 0xFF, sizes[n], char_width, first_char + n, offset);
+
+        offset += sizes[n];
+    }
+
+    if(offset > 0xFFFE) {
+        fprintf(stderr, "%s is too large\n", name);
+        return 0;
+    }
+
+    printf("\n");
+    printf("  // Font Data:\n");
+
+    for(int n = 0; n < char_num; n++) {
+        if(sizes[n] > 0) {
+            printf("  ");
+            for(int m = 0; m < sizes[n]; m++) {
+                printf("0x%02X,", encoded[n][m]);
+            }
+            printf("  // %d\n", first_char + n);
+        }
+        free(encoded[n]);
+    }
+
+    printf("};\n");
+
+    fprintf(stderr, "%-20s %3d chars, glyph data %5d -> %5d bytes\n", name, sparse_num, plain_size, offset);
+
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s [-c <chars>] <font>...\n", argv[0]);
+        return 1;
+    }
+
+    uint8_t set[256];
+    int subset = 0;
+
+    printf("// Generated by utils/font-to-rle from the fonts in src/fonts.c. Do not edit.\n\n");
+    printf("#include <stdint.h>\n\n");
+    printf("#include \"fonts.h\"\n");
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-c") && (i + 1 < argc)) {
+            i++;
+
+            // An empty set keeps the whole font
+            subset = font_subset_parse(set, argv[i]);
+
+            if(subset < 0) {
+                fprintf(stderr, "The characters %s are not in Latin-1\n", argv[i]);
+                return 1;
+            }
+            continue;
+        }
+
+        const uint8_t *font = find_font(argv[i]);
+
+        if(!font) {
+            fprintf(stderr, "Unknown font %s\n", argv[i]);
+            return 1;
+        }
+
+        if(!write_font(argv[i], font, subset ? set : 0)) {
+            return 1;
+        }
+
+        subset = 0;
+    }
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+// Convert PBM icons to a C table of struct icon, or with -a to an icon atlas
+// as described in src/icon-atlas.h
+//
+// Usage: pbm-to-c <root> <file.pbm>... > icon-data.c
+//        pbm-to-c -a <root> <file.pbm>... > icons.atlas
+//
+// The icons are named by their path below <root>, so that data/icons/bus.pbm
+// becomes "/icons/bus.pbm", the same name as in the SPIFFS image. The PBM
+// files are stored transposed, one row per column of the icon, and the bits
+// are reversed to get the top pixel in the least significant bit as expected
+// by fb_blit.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "icon-atlas.h"
+
+struct pbm
+{
+    int width;
+    int height;
+    uint8_t *data;
+};
+
+static uint8_t reverse(uint8_t b)
+{
+    b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+    b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+    b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+    return b;
+}
+
+static int read_number(FILE *fp)
+{
+    int c;
+
+    do {
+        c = fgetc(fp);
+
+        if(c == '#') {
+            while((c != '\n') && (c != EOF)) {
+                c = fgetc(fp);
+            }
+        }
+    } while(isspace(c));
+
+    int n = 0;
+
+    if(!isdigit(c)) {
+        return -1;
+    }
+
+    while(isdigit(c)) {
+        n = 10 * n + (c - '0');
+        c = fgetc(fp);
+    }
+
+    return n;
+}
+
+static int load_pbm(const char *filename, struct pbm *pbm)
+{
+    FILE *fp = fopen(filename, "rb");
+
+    if(!fp) {
+        fprintf(stderr, "Could not open '%s'\n", filename);
+        return 0;
+    }
+
+    if((fgetc(fp) != 'P') || (fgetc(fp) != '4')) {
+        fprintf(stderr, "'%s' is not a binary PBM file\n", filename);
+        fclose(fp);
+        return 0;
+    }
+
+    pbm->width = read_number(fp);
+    pbm->height = read_number(fp);
+
+    if((pbm->width <= 0) || (pbm->height <= 0)) {
+        fprintf(stderr, "Could not read the size of '%s'\n", filename);
+        fclose(fp);
+        return 0;
+    }
+
+    const int len = pbm->height * ((pbm->width + 7) / 8);
+
+    pbm->data = malloc(len);
+
+    if(!pbm->data || (fread(pbm->data, 1, len, fp) != len)) {
+        fprintf(stderr, "Could not read the data of '%s'\n", filename);
+        free(pbm->data);
+        fclose(fp);
+        return 0;
+    }
+
+    fclose(fp);
+    return len;
+}
+
+static void symbol_name(char *buf, int size, const char *name)
+{
+    int n = 0;
+
+    for(const char *s = name; *s && (n < size - 1); s++) {
+        if(!strcmp(s, ".pbm")) {
+            break;
+        }
+
+        if(isalnum((unsigned char)*s)) {
+            buf[n++] = *s;
+        } else if(n > 0 && buf[n - 1] != '_') {
+            buf[n++] = '_';
+        }
+    }
+
+    buf[n] = 0;
+}
+
+static void put_u16(uint16_t n)
+{
+    putchar(n & 0xFF);
+    putchar(n >> 8);
+}
+
+static void put_u32(uint32_t n)
+{
+    put_u16(n & 0xFFFF);
+    put_u16(n >> 16);
+}
+
+static int write_atlas(const char *root, int num_files, char *files[])
+{
+    const int root_len = strlen(root);
+    struct pbm *pbms = calloc(num_files, sizeof(struct pbm));
+    int *lens = calloc(num_files, sizeof(int));
+
+    uint32_t size = ICON_ATLAS_HEADER_LEN + num_files * ICON_ATLAS_ENTRY_LEN;
+
+    for(int i = 0; i < num_files; i++) {
+        if(strlen(files[i] + root_len) >= ICON_ATLAS_NAME_LEN) {
+            fprintf(stderr, "The name of '%s' is too long\n", files[i]);
+            return 1;
+        }
+
+        if(!(lens[i] = load_pbm(files[i], &pbms[i]))) {
+            return 1;
+        }
+
+        size += lens[i];
+    }
+
+    fputs(ICON_ATLAS_MAGIC, stdout);
+    put_u16(num_files);
+    put_u16(0);
+    put_u32(size);
+
+    uint32_t offset = ICON_ATLAS_HEADER_LEN + num_files * ICON_ATLAS_ENTRY_LEN;
+
+    for(int i = 0; i < num_files; i++) {
+        char name[ICON_ATLAS_NAME_LEN] = { 0 };
+
+        strcpy(name, files[i] + root_len);
+        fwrite(name, 1, sizeof(name), stdout);
+
+        // The PBM is transposed
+        put_u16(pbms[i].height);
+        put_u16(pbms[i].width);
+        put_u32(offset);
+
+        offset += lens[i];
+    }
+
+    for(int i = 0; i < num_files; i++) {
+        for(int j = 0; j < lens[i]; j++) {
+            putchar(reverse(pbms[i].data[j]));
+        }
+        free(pbms[i].data);
+    }
+
+    free(pbms);
+    free(lens);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if((argc > 3) && !strcmp(argv[1], "-a")) {
+        return write_atlas(argv[2], argc - 3, &argv[3]);
+    }
+
+    if(argc < 3) {
+        fprintf(stderr, "Usage: %s [-a] <root> <file.pbm>...\n", argv[0]);
+        return 1;
+    }
+
+    const char *root = argv[1];
+    const int root_len = strlen(root);
+
+    printf("// Generated by utils/pbm-to-c from the icons in %s. Do not edit.\n\n", root);
+    printf("#include <stdint.h>\n\n");
+    printf("#include \"framebuffer.h\"\n");
+    printf("#include \"icons.h\"\n");
+
+    for(int i = 2; i < argc; i++) {
+        struct pbm pbm;
+        char symbol[64];
+        const int len = load_pbm(argv[i], &pbm);
+
+        if(!len) {
+            return 1;
+        }
+
+        symbol_name(symbol, sizeof(symbol), argv[i] + root_len);
+
+        printf("\nstatic const uint8_t %s_data[] = {", symbol);
+
+        for(int j = 0; j < len; j++) {
+            printf("%s0x%02X,", (j % 16) ? " " : "\n    ", reverse(pbm.data[j]));
+        }
+
+        printf("\n};\n");
+
+        free(pbm.data);
+    }
+
+    printf("\nconst struct icon_entry icon_table[] = {\n");
+
+    for(int i = 2; i < argc; i++) {
+        struct pbm pbm;
+        char symbol[64];
+
+        load_pbm(argv[i], &pbm);
+        free(pbm.data);
+
+        symbol_name(symbol, sizeof(symbol), argv[i] + root_len);
+
+        // The PBM is transposed
+        printf("    { \"%s\", { .width = %d, .height = %d, .data = %s_data } },\n", argv[i] + root_len, pbm.height, pbm.width, symbol);
+    }
+
+    printf("};\n\n");
+    printf("const uint16_t icon_table_len = sizeof(icon_table) / sizeof(icon_table[0]);\n");
+
+    return 0;
+}
@@ -15,6 +15,9 @@
 #include <string.h>
 #include <ctype.h>
 
+#include "font-rle.h"
+#include "font-subset.h"
+
 struct jumptab_entry {
     uint16_t offset;
     uint8_t size;
@@ -130,6 +133,38 @@ int main(int argc, char *argv[])
 
     int glyph_width = 4;
 
+    // With -r the glyphs are run length encoded, see src/fonts.h
+    int rle = 0;
+
+    // With -c <chars> only the given characters are kept, as a sparse font
+    uint8_t set[256];
+    int subset = 0;
+
+    while(argc > 1 && argv[1][0] == '-')
+    {
+        if(!strcmp(argv[1], "-r"))
+        {
+            rle = 1;
+        } else if(!strcmp(argv[1], "-c") && (argc > 2)) {
+            subset = font_subset_parse(set, argv[2]);
+
+            if(subset < 0)
+            {
+                fprintf(stderr, "The characters %s are not in Latin-1\n", argv[2]);
+                return 1;
+            }
+
+            argc--;
+            argv++;
+        } else {
+            fprintf(stderr, "Usage: %s [-r] [-c <chars>] [<png> [<glyph width>]]\n", argv[0]);
+            return 1;
+        }
+
+        argc--;
+        argv++;
+    }
+
     if(argc > 1)
     {
         pngname = argv[1];
@@ -228,19 +263,98 @@ int main(int argc, char *argv[])
             printf("\n");
         }
 
+        int sparse_first = first_char;
+        int sparse_num = num_glyphs;
+
+        if(subset)
+        {
+            offset = 0;
+            sparse_first = -1;
+            sparse_num = 0;
+
+            for(int n = 0; n < num_glyphs; n++)
+            {
+                if(!set[first_char + n])
+                {
+                    jumptab[n].offset = 0xFFFF;
+                    jumptab[n].size = 0;
+                    continue;
+                }
+
+                if(sparse_first < 0)
+                {
+                    sparse_first = first_char + n;
+                }
+                sparse_num++;
+
+                if(jumptab[n].offset != 0xFFFF)
+                {
+                    jumptab[n].offset = offset;
+                    offset += jumptab[n].size;
+                }
+            }
+
+            if(!sparse_num)
+            {
+                fprintf(stderr, "None of the characters are in the font\n");
+                return 1;
+            }
+        }
+
+        if(rle)
+        {
+            offset = 0;
+
+            for(int n = 0; n < num_glyphs; n++)
+            {
+                if(jumptab[n].offset == 0xFFFF)
+                {
+                    continue;
+                }
+
+                uint8_t *encoded = malloc(2 * jumptab[n].size + 1);
+                const int size = font_rle_encode(encoded, font_data[n], jumptab[n].size, jumptab[n].width, height);
+
+                if(size > FONT_RLE_MAX_BYTES)
+                {
+                    fprintf(stderr, "Glyph %d is too large\n", first_char + n);
+                    return 1;
+                }
+
+                free(font_data[n]);
+                font_data[n] = encoded;
+
+                jumptab[n].offset = offset;
+                jumptab[n].size = size;
+                offset += size;
+            }
+        }
+
         FILE *f = fopen("out.c", "w");
         fprintf(f, "#include <stdint.h>\n");
         fprintf(f, "\n");
         fprintf(f, "const uint8_t font[] PROGMEM = {\n");
-        fprintf(f, "  0x%02X, // Width: %d\n", glyph_width, glyph_width);
+        fprintf(f, "  0x%02X, // Width: %d%s%s\n", glyph_width | (rle ? FONT_RLE_FLAG : 0) | (subset ? FONT_SPARSE_FLAG : 0), glyph_width,
+                rle ? ", run length encoded" : "", subset ? ", sparse" : "");
         fprintf(f, "  0x%02X, // Height: %d\n", height, height);
-        fprintf(f, "  0x%02X, // First Char: %d\n", first_char, first_char);
-        fprintf(f, "  0x%02X, // Number of Chars: %d\n", num_glyphs, num_glyphs);
+        fprintf(f, "  0x%02X, // First Char: %d\n", sparse_first, sparse_first);
+        fprintf(f, "  0x%02X, // Number of Chars: %d\n", sparse_num, sparse_num);
         fprintf(f, "\n");
+
+        if(subset)
+        {
+            font_subset_write_codes(f, set, first_char, num_glyphs);
+        }
+
         fprintf(f, "  // Jump Table:\n");
 
         for(int c = first_char, n = 0; c < first_char + num_glyphs; c++, n++)
         {
+            if(subset && !set[c])
+            {
+                continue;
+            }
+
             fprintf(f, "  0x%02X, 0x%02X, 0x%02X, 0x%02X,  // %d:%d\n",
                     (jumptab[n].offset >> 8) & 0xFF,
                     jumptab[n].offset & 0xFF,
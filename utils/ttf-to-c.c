@@ -11,6 +11,8 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
+#include "font-subset.h"
+
 
 struct jumptab_entry {
     uint16_t offset;
@@ -23,6 +25,24 @@ int main(int argc, char *argv[])
 {
     const char *filename = "/usr/share/fonts/truetype/msttcorefonts/Arial.ttf";
 
+    // With -c <chars> only the given characters are kept, as a sparse font
+    uint8_t set[256];
+    int subset = 0;
+
+    if((argc > 2) && !strcmp(argv[1], "-c"))
+    {
+        subset = font_subset_parse(set, argv[2]);
+
+        if(subset < 0)
+        {
+            fprintf(stderr, "The characters %s are not in Latin-1\n", argv[2]);
+            return 1;
+        }
+
+        argc -= 2;
+        argv += 2;
+    }
+
     if(argc > 1)
     {
         filename = argv[1];
@@ -132,7 +152,12 @@ int main(int argc, char *argv[])
         jumptab[n].width = slot->advance.x >> 6;
         jumptab[n].size = width * HEIGHT / 8;
 
-        if(width > 0)
+        if(subset && !set[c])
+        {
+            jumptab[n].size = 0;
+        }
+
+        if(jumptab[n].size > 0)
         {
             jumptab[n].offset = offset;
             offset += jumptab[n].size;
@@ -172,7 +197,7 @@ int main(int argc, char *argv[])
                  {
                      uint8_t d = image[(8*i + k) * WIDTH + x + j];
 
-                     if(d > 0x80)
+                     if((d > 0x80) && font_data[n])
                      {
                          font_data[n][j * (HEIGHT/8) + i] |= 1 << k;
                      }
@@ -185,19 +210,51 @@ int main(int argc, char *argv[])
         x += slot->advance.x >> 6;
     }
 
+    int sparse_first = first_char;
+    int sparse_num = num_chars;
+
+    if(subset)
+    {
+        sparse_first = -1;
+        sparse_num = 0;
+
+        for(int c = first_char; c < first_char + num_chars; c++)
+        {
+            if(set[c])
+            {
+                if(sparse_first < 0)
+                {
+                    sparse_first = c;
+                }
+                sparse_num++;
+            }
+        }
+    }
+
     FILE *f = fopen("out.c", "w");
     fprintf(f, "#include <stdint.h>\n");
     fprintf(f, "\n");
     fprintf(f, "const uint8_t font[] PROGMEM = {\n");
-    fprintf(f, "  0x%02X, // Width: %d\n", max_width, max_width);
+    fprintf(f, "  0x%02X, // Width: %d%s\n", max_width | (subset ? FONT_SPARSE_FLAG : 0), max_width, subset ? ", sparse" : "");
     fprintf(f, "  0x%02X, // Height: %d\n", HEIGHT, HEIGHT);
-    fprintf(f, "  0x%02X, // First Char: %d\n", first_char, first_char);
-    fprintf(f, "  0x%02X, // Number of Chars: %d\n", num_chars, num_chars);
+    fprintf(f, "  0x%02X, // First Char: %d\n", sparse_first, sparse_first);
+    fprintf(f, "  0x%02X, // Number of Chars: %d\n", sparse_num, sparse_num);
     fprintf(f, "\n");
+
+    if(subset)
+    {
+        font_subset_write_codes(f, set, first_char, num_chars);
+    }
+
     fprintf(f, "  // Jump Table:\n");
 
     for(int c = first_char, n = 0; c < first_char + num_chars; c++, n++)
     {
+        if(subset && !set[c])
+        {
+            continue;
+        }
+
         fprintf(f, "  0x%02X, 0x%02X, 0x%02X, 0x%02X,  // %d:%d\n",
                 (jumptab[n].offset >> 8) & 0xFF,
                 jumptab[n].offset & 0xFF,